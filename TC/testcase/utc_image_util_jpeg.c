@@ -15,7 +15,10 @@
 */
 
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <tet_api.h>
 #include <image_util.h>
 
@@ -28,6 +31,7 @@ void (*tet_cleanup)(void) = cleanup;
 #define SAMPLE_JPEG "sample.jpg"
 #define WRONG_PATH ""
 #define OUTPUT_JPEG "test_output.jpg"
+#define THUMBNAIL_JPEG "test_thumbnail.jpg"
 
 image_util_colorspace_e SUPPORTED_COLORSPACE;
 image_util_colorspace_e NOT_SUPPORTED_COLORSPACE;
@@ -58,6 +62,17 @@ struct{
 #define API_NAME_IMAGE_UTIL_ENCODE_JPEG "image_util_encode_jpeg"
 #define API_NAME_IMAGE_UTIL_DECODE_JPEG_FROM_MEMORY "image_util_decode_jpeg_from_memory"
 #define API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY "image_util_encode_jpeg_to_memory"
+#define API_NAME_IMAGE_UTIL_DECODE_RUN "image_util_decode_run"
+#define API_NAME_IMAGE_UTIL_DECODE_PUSH "image_util_decode_push"
+#define API_NAME_IMAGE_UTIL_ENCODE_PUSH_ROWS "image_util_encode_push_rows"
+#define API_NAME_IMAGE_UTIL_DECODE_RUN_TO_BUFFER "image_util_decode_run_to_buffer"
+#define API_NAME_IMAGE_UTIL_GET_JPEG_INFO "image_util_get_jpeg_info"
+#define API_NAME_IMAGE_UTIL_ENCODE_RUN_TO_BUFFER "image_util_encode_run_to_buffer"
+#define API_NAME_IMAGE_UTIL_DECODE_SET_INPUT_CALLBACK "image_util_decode_set_input_callback"
+#define API_NAME_IMAGE_UTIL_DECODE_SET_FILE_ACCESS "image_util_decode_set_file_access"
+#define API_NAME_IMAGE_UTIL_DECODE_JPEG_BATCH "image_util_decode_jpeg_batch"
+#define API_NAME_IMAGE_UTIL_DECODE_RUN_ASYNC "image_util_decode_run_async"
+#define API_NAME_IMAGE_UTIL_DECODE_JPEG_THUMBNAIL "image_util_decode_jpeg_thumbnail"
 
 static void utc_image_util_decode_jpeg_n_1(void);
 static void utc_image_util_decode_jpeg_n_2(void);
@@ -80,7 +95,38 @@ static void utc_image_util_encode_jpeg_to_memory_n_1(void);
 static void utc_image_util_encode_jpeg_to_memory_n_2(void);
 static void utc_image_util_encode_jpeg_to_memory_n_3(void);
 static void utc_image_util_encode_jpeg_to_memory_n_4(void);
+static void utc_image_util_encode_jpeg_to_memory_n_5(void);
 static void utc_image_util_encode_jpeg_to_memory_p(void);
+static void utc_image_util_encode_jpeg_to_memory_p_2(void);
+static void utc_image_util_encode_jpeg_to_memory_p_3(void);
+static void utc_image_util_decode_run_n_1(void);
+static void utc_image_util_decode_run_n_2(void);
+static void utc_image_util_decode_run_p(void);
+static void utc_image_util_decode_run_p_2(void);
+static void utc_image_util_decode_run_n_3(void);
+static void utc_image_util_decode_run_p_3(void);
+static void utc_image_util_decode_run_n_4(void);
+static void utc_image_util_decode_push_n(void);
+static void utc_image_util_decode_push_p(void);
+static void utc_image_util_encode_push_rows_n(void);
+static void utc_image_util_encode_push_rows_p(void);
+static void utc_image_util_decode_run_to_buffer_n(void);
+static void utc_image_util_decode_run_to_buffer_p(void);
+static void utc_image_util_get_jpeg_info_n(void);
+static void utc_image_util_get_jpeg_info_p(void);
+static void utc_image_util_encode_run_to_buffer_n(void);
+static void utc_image_util_encode_run_to_buffer_p(void);
+static void utc_image_util_decode_set_input_callback_n(void);
+static void utc_image_util_decode_set_input_callback_p(void);
+static void utc_image_util_decode_set_file_access_n(void);
+static void utc_image_util_decode_set_file_access_p(void);
+static void utc_image_util_decode_jpeg_batch_n(void);
+static void utc_image_util_decode_jpeg_batch_p(void);
+static void utc_image_util_decode_run_async_n(void);
+static void utc_image_util_decode_run_async_p(void);
+static void utc_image_util_decode_jpeg_thumbnail_n(void);
+static void utc_image_util_decode_jpeg_thumbnail_p(void);
+static void utc_image_util_decode_jpeg_thumbnail_p_2(void);
 
 enum
 {
@@ -117,6 +163,9 @@ struct tet_testlist tet_testlist[] = {
     { utc_image_util_encode_jpeg_to_memory_n_3, 15 },
     { utc_image_util_encode_jpeg_to_memory_n_4, 16 },
     { utc_image_util_encode_jpeg_to_memory_p, 17 },
+    { utc_image_util_encode_jpeg_to_memory_p_2, 33 },
+    { utc_image_util_encode_jpeg_to_memory_n_5, 63 },
+    { utc_image_util_encode_jpeg_to_memory_p_3, 64 },
 
 /**
  *  image_util_decode_jpeg_from_memory
@@ -126,6 +175,78 @@ struct tet_testlist tet_testlist[] = {
     { utc_image_util_decode_jpeg_from_memory_n_3, 20 },// SIGSEGV from api
     { utc_image_util_decode_jpeg_from_memory_n_4, 21 },
     { utc_image_util_decode_jpeg_from_memory_p, 22 }, // SIGSEGV from api
+
+/**
+ *  image_util_decode_run
+ */
+    { utc_image_util_decode_run_n_1, 23 },
+    { utc_image_util_decode_run_n_2, 24 },
+    { utc_image_util_decode_run_p, 25 },
+    { utc_image_util_decode_run_p_2, 26 },
+    { utc_image_util_decode_run_n_3, 27 },
+    { utc_image_util_decode_run_p_3, 28 },
+    { utc_image_util_decode_run_n_4, 61 },
+
+/**
+ *  image_util_decode_push
+ */
+    { utc_image_util_decode_push_n, 29 },
+    { utc_image_util_decode_push_p, 30 },
+
+/**
+ *  image_util_encode_push_rows
+ */
+    { utc_image_util_encode_push_rows_n, 31 },
+    { utc_image_util_encode_push_rows_p, 32 },
+
+/**
+ *  image_util_decode_run_to_buffer
+ */
+    { utc_image_util_decode_run_to_buffer_n, 34 },
+    { utc_image_util_decode_run_to_buffer_p, 35 },
+
+/**
+ *  image_util_get_jpeg_info
+ */
+    { utc_image_util_get_jpeg_info_n, 36 },
+    { utc_image_util_get_jpeg_info_p, 37 },
+
+/**
+ *  image_util_encode_run_to_buffer
+ */
+    { utc_image_util_encode_run_to_buffer_n, 38 },
+    { utc_image_util_encode_run_to_buffer_p, 39 },
+
+/**
+ *  image_util_decode_set_input_callback
+ */
+    { utc_image_util_decode_set_input_callback_n, 40 },
+    { utc_image_util_decode_set_input_callback_p, 41 },
+
+/**
+ *  image_util_decode_set_file_access
+ */
+    { utc_image_util_decode_set_file_access_n, 42 },
+    { utc_image_util_decode_set_file_access_p, 43 },
+
+/**
+ *  image_util_decode_jpeg_batch
+ */
+    { utc_image_util_decode_jpeg_batch_n, 44 },
+    { utc_image_util_decode_jpeg_batch_p, 45 },
+
+/**
+ *  image_util_decode_run_async
+ */
+    { utc_image_util_decode_run_async_n, 46 },
+    { utc_image_util_decode_run_async_p, 47 },
+
+/**
+ *  image_util_decode_jpeg_thumbnail
+ */
+    { utc_image_util_decode_jpeg_thumbnail_n, 59 },
+    { utc_image_util_decode_jpeg_thumbnail_p, 60 },
+    { utc_image_util_decode_jpeg_thumbnail_p_2, 62 },
     { NULL, 0 },
 };
 
@@ -454,6 +575,21 @@ static void utc_image_util_encode_jpeg_to_memory_n_4(void)
     dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, r, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
 }
 
+/**
+ * @brief Negative test case of image_util_encode_jpeg_to_memory(). I420 with an odd width is not supported.
+ */
+static void utc_image_util_encode_jpeg_to_memory_n_5(void)
+{
+    int r;
+    unsigned char i420[15 * 16 * 3 / 2] = { 0, };
+    unsigned char *buffer = NULL;
+    unsigned int size = 0;
+
+    r = image_util_encode_jpeg_to_memory(i420, 15, 16, IMAGE_UTIL_COLORSPACE_I420, 90, &buffer, &size);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, r, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+}
+
 /**
  * @brief Positive test case of image_util_encode_jpeg_to_memory(). Al parameters OK, Success expected.
  */
@@ -467,3 +603,737 @@ static void utc_image_util_encode_jpeg_to_memory_p(void)
     free(buffer);
     dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, r, IMAGE_UTIL_ERROR_NONE);
 }
+
+/**
+ * @brief Positive test case of image_util_encode_jpeg_to_memory(). NV12 is encoded without a conversion.
+ */
+static void utc_image_util_encode_jpeg_to_memory_p_2(void)
+{
+    int r;
+    int w = 0, h = 0, w2 = 0, h2 = 0;
+    unsigned int size = 0, jpeg_size = 0;
+    unsigned char *nv12 = NULL, *jpeg = NULL, *decoded = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_colorspace(handle, IMAGE_UTIL_COLORSPACE_NV12);
+    r = image_util_decode_run(handle, &nv12, &w, &h, &size);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_encode_jpeg_to_memory(nv12, w, h, IMAGE_UTIL_COLORSPACE_NV12, 90, &jpeg, &jpeg_size);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        image_util_decode_set_input_buffer(handle, jpeg, jpeg_size);
+        r = image_util_decode_run(handle, &decoded, &w2, &h2, &size);
+    }
+    image_util_decode_destroy(handle);
+    free(nv12);
+    free(jpeg);
+    free(decoded);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (w2 != w || h2 != h))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Allocator remembering the size of its last aligned allocation in user_data
+ */
+static void *sizing_alloc(size_t size, void *user_data)
+{
+    return malloc(size);
+}
+
+static void sizing_free(void *data, void *user_data)
+{
+    free(data);
+}
+
+static void *sizing_aligned_alloc(size_t alignment, size_t size, void *user_data)
+{
+    void *data = NULL;
+
+    *(size_t *)user_data = size;
+    if(posix_memalign(&data, alignment, size) != 0)
+        return NULL;
+    return data;
+}
+
+/**
+ * @brief Positive test case of image_util_encode_jpeg_to_memory(). The jpeg data is handed out in a block of its size,
+ *        not in the larger one it grew in.
+ */
+static void utc_image_util_encode_jpeg_to_memory_p_3(void)
+{
+    int r;
+    size_t last_size = 0;
+    image_util_allocator_s allocator = { sizing_alloc, sizing_free, sizing_aligned_alloc, &last_size };
+    unsigned char *nv12 = NULL, *jpeg = NULL;
+    unsigned int jpeg_size = 0;
+    const int w = 320, h = 240;
+
+    nv12 = malloc(w * h * 3 / 2);
+    if(nv12 == NULL){
+        dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, IMAGE_UTIL_ERROR_OUT_OF_MEMORY, IMAGE_UTIL_ERROR_NONE);
+        return;
+    }
+    memset(nv12, 0x80, w * h * 3 / 2); // a flat image takes a few kB, less than the first block
+
+    r = image_util_set_allocator(&allocator);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_encode_jpeg_to_memory(nv12, w, h, IMAGE_UTIL_COLORSPACE_NV12, 90, &jpeg, &jpeg_size);
+    if(r == IMAGE_UTIL_ERROR_NONE && last_size != jpeg_size)
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    free(jpeg);
+    free(nv12);
+    if(image_util_set_allocator(NULL) != IMAGE_UTIL_ERROR_NONE && r == IMAGE_UTIL_ERROR_NONE)
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_JPEG_TO_MEMORY, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_run(). No input was set.
+ */
+static void utc_image_util_decode_run_n_1(void)
+{
+    int r;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_run(handle, &buffer, NULL, NULL, NULL);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_set_jpeg_downscale(). Parameter downscale over the range.
+ */
+static void utc_image_util_decode_run_n_2(void)
+{
+    int r;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_set_jpeg_downscale(handle, IMAGE_UTIL_DOWNSCALE_1_8 + 1);
+    image_util_decode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_run(). Decoding at 1/2 of the size.
+ */
+static void utc_image_util_decode_run_p(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_jpeg_downscale(handle, IMAGE_UTIL_DOWNSCALE_1_2);
+    r = image_util_decode_run(handle, &buffer, &w, &h, &size);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 240 || h != 160 || size != 240 * 160 * 3))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_run(). Decoding from memory to a resolution in NV12.
+ */
+static void utc_image_util_decode_run_p_2(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_buffer(handle, jpeg_image.buffer, jpeg_image.size);
+    image_util_decode_set_colorspace(handle, IMAGE_UTIL_COLORSPACE_NV12);
+    image_util_decode_set_resolution(handle, 100, 60);
+    r = image_util_decode_run(handle, &buffer, &w, &h, &size);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 100 || h != 60 || size != 100 * 60 * 3 / 2))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_run(). Crop area outside of the image.
+ */
+static void utc_image_util_decode_run_n_3(void)
+{
+    int r;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_crop_area(handle, 400, 300, 100, 100);
+    r = image_util_decode_run(handle, &buffer, NULL, NULL, NULL);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_run(). Decoding a crop area at 1/4 of the size.
+ */
+static void utc_image_util_decode_run_p_3(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_crop_area(handle, 100, 40, 200, 120);
+    image_util_decode_set_jpeg_downscale(handle, IMAGE_UTIL_DOWNSCALE_1_4);
+    r = image_util_decode_run(handle, &buffer, &w, &h, &size);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 50 || h != 30 || size != 50 * 30 * 3))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_run(). The end of the crop area overflows an int.
+ */
+static void utc_image_util_decode_run_n_4(void)
+{
+    int r;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_crop_area(handle, 100, 40, INT_MAX, 120);
+    r = image_util_decode_run(handle, &buffer, NULL, NULL, NULL);
+    image_util_decode_destroy(handle);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Callback counting the decoded rows
+ */
+static void decode_rows_cb(const image_util_planes_s *rows, int first_row, int num_rows, int width, int height, void *user_data)
+{
+    int *next_row = (int*)user_data;
+
+    if(*next_row == first_row)
+        *next_row = first_row + num_rows;
+}
+
+/**
+ * @brief Negative test case of image_util_decode_push(). No stream was started.
+ */
+static void utc_image_util_decode_push_n(void)
+{
+    int r;
+    unsigned char data[16] = { 0xFF, 0xD8 };
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_push(handle, data, sizeof(data));
+    image_util_decode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_PUSH, r, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_push(). The file is pushed in small parts.
+ */
+static void utc_image_util_decode_push_p(void)
+{
+    int r;
+    int next_row = 0;
+    size_t n;
+    unsigned char data[1000];
+    image_util_decode_h handle = NULL;
+    FILE *fp = fopen(SAMPLE_JPEG, "rb");
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_colorspace(handle, IMAGE_UTIL_COLORSPACE_I420);
+    r = image_util_decode_start_stream(handle, decode_rows_cb, &next_row);
+    if(fp == NULL)
+        r = IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+    while(r == IMAGE_UTIL_ERROR_NONE && (n = fread(data, 1, sizeof(data), fp)) > 0)
+        r = image_util_decode_push(handle, data, n);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_decode_finish_stream(handle);
+    image_util_decode_destroy(handle);
+    if(fp)
+        fclose(fp);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && next_row != 320)
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_PUSH, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Collects the jpeg data of a streamed encoding
+ */
+struct{
+    unsigned char buffer[64 * 1024];
+    unsigned int size;
+}encoded_jpeg = {{0}, 0};
+
+static bool encode_output_cb(const unsigned char *data, unsigned int size, void *user_data)
+{
+    if(encoded_jpeg.size + size > sizeof(encoded_jpeg.buffer))
+        return false;
+    memcpy(encoded_jpeg.buffer + encoded_jpeg.size, data, size);
+    encoded_jpeg.size += size;
+    return true;
+}
+
+/**
+ * @brief Negative test case of image_util_encode_push_rows(). More rows are pushed than the image has.
+ */
+static void utc_image_util_encode_push_rows_n(void)
+{
+    int r;
+    unsigned char rgb[64 * 3 * 4] = { 0 };
+    image_util_planes_s rows = { { rgb }, { 64 * 3 } };
+    image_util_encode_h handle = NULL;
+
+    encoded_jpeg.size = 0;
+    image_util_encode_create(&handle);
+    image_util_encode_set_resolution(handle, 64, 2);
+    r = image_util_encode_start_stream(handle, encode_output_cb, NULL);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_encode_push_rows(handle, &rows, 4);
+    image_util_encode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_PUSH_ROWS, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_encode_push_rows(). The image is pushed in bands and decoded again.
+ */
+static void utc_image_util_encode_push_rows_p(void)
+{
+    int r, x, y;
+    int width = 0, height = 0;
+    unsigned int size = 0;
+    unsigned char rgb[64 * 3 * 16];
+    unsigned char *decoded = NULL;
+    image_util_planes_s rows = { { rgb }, { 64 * 3 } };
+    image_util_encode_h handle = NULL;
+    image_util_decode_h decode = NULL;
+
+    for(y = 0; y < 16; y++)
+        for(x = 0; x < 64 * 3; x++)
+            rgb[y * 64 * 3 + x] = x + y * 8;
+
+    encoded_jpeg.size = 0;
+    image_util_encode_create(&handle);
+    image_util_encode_set_resolution(handle, 64, 48);
+    image_util_encode_set_quality(handle, 90);
+    r = image_util_encode_start_stream(handle, encode_output_cb, NULL);
+    for(y = 0; r == IMAGE_UTIL_ERROR_NONE && y < 48; y += 16)
+        r = image_util_encode_push_rows(handle, &rows, 16);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_encode_finish_stream(handle);
+    image_util_encode_destroy(handle);
+
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        image_util_decode_create(&decode);
+        image_util_decode_set_input_buffer(decode, encoded_jpeg.buffer, encoded_jpeg.size);
+        r = image_util_decode_run(decode, &decoded, &width, &height, &size);
+        image_util_decode_destroy(decode);
+        free(decoded);
+    }
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (width != 64 || height != 48))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_PUSH_ROWS, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_run_to_buffer(). The buffer is one byte too small.
+ */
+static void utc_image_util_decode_run_to_buffer_n(void)
+{
+    int r;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    r = image_util_decode_get_dest_resolution(handle, NULL, NULL, &size);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        buffer = malloc(size);
+        r = image_util_decode_run_to_buffer(handle, buffer, size - 1, NULL, NULL, NULL);
+    }
+    image_util_decode_destroy(handle);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN_TO_BUFFER, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_run_to_buffer(). The buffer is sized by image_util_decode_get_dest_resolution().
+ */
+static void utc_image_util_decode_run_to_buffer_p(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0, decoded_size = 0;
+    unsigned char *buffer = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    image_util_decode_set_colorspace(handle, IMAGE_UTIL_COLORSPACE_I420);
+    r = image_util_decode_get_dest_resolution(handle, &w, &h, &size);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        buffer = malloc(size);
+        r = image_util_decode_run_to_buffer(handle, buffer, size, NULL, NULL, &decoded_size);
+    }
+    image_util_decode_destroy(handle);
+    free(buffer);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 480 || h != 320 || decoded_size != size))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN_TO_BUFFER, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_get_jpeg_info_from_memory(). The buffer is not a jpeg image.
+ */
+static void utc_image_util_get_jpeg_info_n(void)
+{
+    int r;
+    unsigned char data[64] = { 0 };
+    image_util_jpeg_info_s info;
+
+    r = image_util_get_jpeg_info_from_memory(data, sizeof(data), &info);
+    dts_check_eq(API_NAME_IMAGE_UTIL_GET_JPEG_INFO, r, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+}
+
+/**
+ * @brief Positive test case of image_util_get_jpeg_info(). The size is read from the header.
+ */
+static void utc_image_util_get_jpeg_info_p(void)
+{
+    int r;
+    image_util_jpeg_info_s info;
+
+    r = image_util_get_jpeg_info(SAMPLE_JPEG, &info);
+    if(r == IMAGE_UTIL_ERROR_NONE && (info.width != 480 || info.height != 320 || info.orientation != 1))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_GET_JPEG_INFO, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_encode_run_to_buffer(). The buffer can not hold the headers.
+ */
+static void utc_image_util_encode_run_to_buffer_n(void)
+{
+    int r;
+    unsigned int size = 0;
+    unsigned char rgb[64 * 3 * 16] = { 0 };
+    unsigned char buffer[64];
+    image_util_planes_s src = { { rgb }, { 64 * 3 } };
+    image_util_encode_h handle = NULL;
+
+    image_util_encode_create(&handle);
+    image_util_encode_set_resolution(handle, 64, 16);
+    r = image_util_encode_run_to_buffer(handle, &src, buffer, sizeof(buffer), &size);
+    image_util_encode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_RUN_TO_BUFFER, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_encode_run_to_buffer(). The buffer is sized by image_util_encode_get_max_size().
+ */
+static void utc_image_util_encode_run_to_buffer_p(void)
+{
+    int r, x;
+    unsigned int max_size = 0, size = 0;
+    unsigned char rgb[64 * 3 * 16];
+    unsigned char *buffer = NULL;
+    image_util_planes_s src = { { rgb }, { 64 * 3 } };
+    image_util_encode_h handle = NULL;
+
+    for(x = 0; x < (int)sizeof(rgb); x++)
+        rgb[x] = x * 7;
+
+    image_util_encode_create(&handle);
+    image_util_encode_set_resolution(handle, 64, 16);
+    image_util_encode_set_quality(handle, 100);
+    r = image_util_encode_get_max_size(handle, &max_size);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        buffer = malloc(max_size);
+        r = image_util_encode_run_to_buffer(handle, &src, buffer, max_size, &size);
+    }
+    image_util_encode_destroy(handle);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (size == 0 || size > max_size || buffer[0] != 0xFF || buffer[1] != 0xD8))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_ENCODE_RUN_TO_BUFFER, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+static int read_file_cb(unsigned char *buffer, unsigned int size, void *user_data)
+{
+    return fread(buffer, 1, size, (FILE *)user_data);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_set_input_callback(). The callback is NULL.
+ */
+static void utc_image_util_decode_set_input_callback_n(void)
+{
+    int r;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_set_input_callback(handle, NULL, NULL);
+    image_util_decode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_SET_INPUT_CALLBACK, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_set_input_callback(). The sample file is read through the callback.
+ */
+static void utc_image_util_decode_set_input_callback_p(void)
+{
+    int r;
+    int width = 0, height = 0;
+    unsigned int size = 0;
+    unsigned char *decoded = NULL;
+    image_util_decode_h handle = NULL;
+    FILE *fp = fopen(SAMPLE_JPEG, "rb");
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_set_input_callback(handle, read_file_cb, fp);
+    if(r == IMAGE_UTIL_ERROR_NONE && fp)
+        r = image_util_decode_run(handle, &decoded, &width, &height, &size);
+    else
+        r = IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+    image_util_decode_destroy(handle);
+    if(fp)
+        fclose(fp);
+    free(decoded);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (width != 480 || height != 320))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_SET_INPUT_CALLBACK, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_set_file_access(). The access is not one of the enumeration.
+ */
+static void utc_image_util_decode_set_file_access_n(void)
+{
+    int r;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_set_file_access(handle, IMAGE_UTIL_FILE_ACCESS_READ + 1);
+    image_util_decode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_SET_FILE_ACCESS, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_set_file_access(). The sample file is decoded from a populated mapping.
+ */
+static void utc_image_util_decode_set_file_access_p(void)
+{
+    int r;
+    int width = 0, height = 0;
+    unsigned int size = 0;
+    unsigned char *decoded = NULL;
+    image_util_decode_h handle = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    r = image_util_decode_set_file_access(handle, IMAGE_UTIL_FILE_ACCESS_MAP_POPULATE);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_decode_run(handle, &decoded, &width, &height, &size);
+    image_util_decode_destroy(handle);
+    free(decoded);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (width != 480 || height != 320))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_SET_FILE_ACCESS, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+static void decode_batch_cb(int index, int error, unsigned char *image_buffer, int width, int height, unsigned int size, void *user_data)
+{
+    int *errors = user_data;
+
+    errors[index] = (error == IMAGE_UTIL_ERROR_NONE && (width != 480 || height != 320)) ? IMAGE_UTIL_ERROR_INVALID_OPERATION : error;
+    free(image_buffer);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_jpeg_batch(). The callback is NULL.
+ */
+static void utc_image_util_decode_jpeg_batch_n(void)
+{
+    int r;
+    image_util_decode_item_s item = { SAMPLE_JPEG, NULL, 0, IMAGE_UTIL_COLORSPACE_RGB888, 0, 0 };
+
+    r = image_util_decode_jpeg_batch(&item, 1, NULL, NULL);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_BATCH, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_jpeg_batch(). The sample file is decoded into two colorspaces.
+ */
+static void utc_image_util_decode_jpeg_batch_p(void)
+{
+    int r;
+    int errors[2] = { -1, -1 };
+    image_util_decode_item_s items[2] = {
+        { SAMPLE_JPEG, NULL, 0, IMAGE_UTIL_COLORSPACE_RGB888, 0, 0 },
+        { SAMPLE_JPEG, NULL, 0, IMAGE_UTIL_COLORSPACE_I420, 0, 0 },
+    };
+
+    r = image_util_decode_jpeg_batch(items, 2, decode_batch_cb, errors);
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = (errors[0] != IMAGE_UTIL_ERROR_NONE) ? errors[0] : errors[1];
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_BATCH, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_run_async(). The handle has no input.
+ */
+static void utc_image_util_decode_run_async_n(void)
+{
+    int r;
+    image_util_decode_h handle = NULL;
+    image_util_request_h request = NULL;
+
+    image_util_decode_create(&handle);
+    r = image_util_decode_run_async(handle, NULL, NULL, &request);
+    image_util_decode_destroy(handle);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN_ASYNC, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_run_async(). The request is waited for and its image taken.
+ */
+static void utc_image_util_decode_run_async_p(void)
+{
+    int r;
+    int width = 0, height = 0;
+    unsigned int size = 0;
+    unsigned char *decoded = NULL;
+    image_util_decode_h handle = NULL;
+    image_util_request_h request = NULL;
+
+    image_util_decode_create(&handle);
+    image_util_decode_set_input_path(handle, SAMPLE_JPEG);
+    r = image_util_decode_run_async(handle, NULL, NULL, &request);
+    image_util_decode_destroy(handle);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        r = image_util_request_wait(request);
+        if(r == IMAGE_UTIL_ERROR_NONE)
+            r = image_util_request_get_result(request, &decoded, &width, &height, &size);
+        image_util_request_destroy(request);
+    }
+    free(decoded);
+
+    if(r == IMAGE_UTIL_ERROR_NONE && (width != 480 || height != 320 || size == 0))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_RUN_ASYNC, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of image_util_decode_jpeg_thumbnail(). The smallest size can not be negative.
+ */
+static void utc_image_util_decode_jpeg_thumbnail_n(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+
+    r = image_util_decode_jpeg_thumbnail(SAMPLE_JPEG, -1, 120, IMAGE_UTIL_COLORSPACE_RGB888, &buffer, &w, &h, &size);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_THUMBNAIL, r, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_jpeg_thumbnail(). sample.jpg has no EXIF thumbnail,
+ *        and 1/2 is the smallest scale of its 480x320 with a height of at least 100.
+ */
+static void utc_image_util_decode_jpeg_thumbnail_p(void)
+{
+    int r;
+    int w = 0, h = 0;
+    unsigned int size = 0;
+    unsigned char *buffer = NULL;
+
+    r = image_util_decode_jpeg_thumbnail(SAMPLE_JPEG, 100, 100, IMAGE_UTIL_COLORSPACE_RGB888, &buffer, &w, &h, &size);
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 240 || h != 160 || size != (unsigned int)(w * h * 3)))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_THUMBNAIL, r, IMAGE_UTIL_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of image_util_decode_jpeg_thumbnail(). 472 pixels are 59 at 1/8, which I420 cuts to 58,
+ *        so a smallest width of 59 needs the 1/4 scale.
+ */
+static void utc_image_util_decode_jpeg_thumbnail_p_2(void)
+{
+    int r, x;
+    int w = 0, h = 0;
+    unsigned int max_size = 0, jpeg_size = 0, size = 0;
+    unsigned char *rgb = NULL;
+    unsigned char *jpeg = NULL;
+    unsigned char *buffer = NULL;
+    image_util_planes_s src = { { NULL }, { 472 * 3 } };
+    image_util_encode_h handle = NULL;
+    FILE *fp = NULL;
+
+    rgb = malloc(472 * 320 * 3);
+    if(rgb == NULL){
+        dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_THUMBNAIL, IMAGE_UTIL_ERROR_OUT_OF_MEMORY, IMAGE_UTIL_ERROR_NONE);
+        return;
+    }
+    for(x = 0; x < 472 * 320 * 3; x++)
+        rgb[x] = x * 7;
+    src.data[0] = rgb;
+
+    image_util_encode_create(&handle);
+    image_util_encode_set_resolution(handle, 472, 320);
+    r = image_util_encode_get_max_size(handle, &max_size);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        jpeg = malloc(max_size);
+        r = image_util_encode_run_to_buffer(handle, &src, jpeg, max_size, &jpeg_size);
+    }
+    image_util_encode_destroy(handle);
+    if(r == IMAGE_UTIL_ERROR_NONE){
+        fp = fopen(THUMBNAIL_JPEG, "wb");
+        if(fp == NULL || fwrite(jpeg, 1, jpeg_size, fp) != jpeg_size)
+            r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+        if(fp)
+            fclose(fp);
+    }
+
+    if(r == IMAGE_UTIL_ERROR_NONE)
+        r = image_util_decode_jpeg_thumbnail(THUMBNAIL_JPEG, 59, 40, IMAGE_UTIL_COLORSPACE_I420, &buffer, &w, &h, &size);
+    if(r == IMAGE_UTIL_ERROR_NONE && (w != 118 || h != 80 || size != (unsigned int)(w * h * 3 / 2)))
+        r = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+    remove(THUMBNAIL_JPEG);
+    free(rgb);
+    free(jpeg);
+    free(buffer);
+    dts_check_eq(API_NAME_IMAGE_UTIL_DECODE_JPEG_THUMBNAIL, r, IMAGE_UTIL_ERROR_NONE);
+}
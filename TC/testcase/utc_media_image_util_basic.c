@@ -14,7 +14,13 @@
 * limitations under the License. 
 */
 
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include <tet_api.h>
 #include <image_util.h>
 
@@ -22,8 +28,19 @@
 
 #define API_NAME_IMAGEUTIL_COLORSPACE "image_util_colorspace"
 #define API_NAME_IMAGEUTIL_COLOR_CONVERT "image_util_color_convert"
+#define API_NAME_IMAGEUTIL_COLOR_CONVERT_EX "image_util_color_convert_ex"
 #define API_NAME_IMAGEUTIL_BUFFER_SIZE "image_util_buffer_size"
 #define API_NAME_IMAGEUTIL_TRANSFORM "image_util_color_transform"
+#define API_NAME_IMAGEUTIL_NUM_THREADS "image_util_num_threads"
+#define API_NAME_IMAGEUTIL_PLANE_LAYOUT "image_util_plane_layout"
+#define API_NAME_IMAGEUTIL_TRANSFORM_HANDLE "image_util_transform_handle"
+#define API_NAME_IMAGEUTIL_RESIZE_WITH_FILTER "image_util_resize_with_filter"
+#define API_NAME_IMAGEUTIL_ROTATE_IN_PLACE "image_util_rotate_in_place"
+#define API_NAME_IMAGEUTIL_CROP_VIEW "image_util_crop_view"
+#define API_NAME_IMAGEUTIL_IMAGE_CREATE "image_util_image_create"
+#define API_NAME_IMAGEUTIL_SET_ALLOCATOR "image_util_set_allocator"
+#define API_NAME_IMAGEUTIL_SET_HUGEPAGES "image_util_set_hugepages"
+#define API_NAME_IMAGEUTIL_DECODE_JPEG "image_util_decode_jpeg"
 
 #define SAMPLE_FILENAME "./sample.jpg"
 
@@ -44,6 +61,11 @@ static void utc_image_util_supported_jpeg_colorspace_3_p(void); // does ,,foreac
 static void utc_image_util_convert_colorspace_p(void);
 static void utc_image_util_convert_colorspace_1_n(void);
 static void utc_image_util_convert_colorspace_2_n(void);
+static void utc_image_util_convert_colorspace_3_p(void);
+static void utc_image_util_convert_colorspace_4_p(void);
+static void utc_image_util_convert_colorspace_5_p(void);
+static void utc_image_util_convert_colorspace_6_p(void);
+static void utc_image_util_convert_colorspace_7_p(void);
 
 //Calculates the size of image buffer for the specified resolution and colorspace.
 static void utc_image_util_calculate_bufsize_result_p(void);
@@ -58,6 +80,57 @@ static void utc_image_util_calculate_bufsize_result_5_p(void);
 static void utc_image_util_file_rotate_p(void);
 static void utc_image_util_file_rotate_2_p(void);
 static void utc_image_util_file_rotate_3_p(void);
+static void utc_image_util_file_rotate_4_p(void);
+static void utc_image_util_file_rotate_5_p(void);
+static void utc_image_util_file_rotate_6_p(void);
+
+//Sets and gets the number of threads used by image operations.
+static void utc_image_util_set_num_threads_p(void);
+static void utc_image_util_set_num_threads_n(void);
+static void utc_image_util_get_num_threads_n(void);
+
+//Plane layouts and functions taking plane pointers and strides.
+static void utc_image_util_get_plane_layout_p(void);
+static void utc_image_util_get_plane_layout_n(void);
+static void utc_image_util_convert_colorspace_ex_p(void);
+static void utc_image_util_convert_colorspace_ex_n(void);
+static void utc_image_util_crop_ex_n(void);
+static void utc_image_util_crop_ex_2_n(void);
+
+// transformation handle
+static void utc_image_util_transform_create_p(void);
+static void utc_image_util_transform_run_p(void);
+static void utc_image_util_transform_run_n(void);
+static void utc_image_util_transform_run_2_n(void);
+
+// resize filters
+static void utc_image_util_resize_with_filter_n(void);
+static void utc_image_util_resize_with_filter_p(void);
+static void utc_image_util_resize_with_filter_2_p(void);
+static void utc_image_util_resize_with_filter_3_p(void);
+
+// rotation in place
+static void utc_image_util_rotate_in_place_n(void);
+static void utc_image_util_rotate_in_place_p(void);
+
+// crop views
+static void utc_image_util_crop_view_n(void);
+static void utc_image_util_crop_view_2_n(void);
+static void utc_image_util_crop_view_p(void);
+
+// reference counted images
+static void utc_image_util_image_create_n(void);
+static void utc_image_util_image_create_p(void);
+
+// allocator
+static void utc_image_util_set_allocator_n(void);
+static void utc_image_util_set_allocator_p(void);
+
+// huge pages
+static void utc_image_util_set_hugepages_p(void);
+
+// alignment of the decoded images
+static void utc_image_util_decode_jpeg_aligned_p(void);
 
 
 
@@ -104,18 +177,142 @@ struct tet_testlist tet_testlist[] = {
 	{ utc_image_util_file_rotate_p, 13},
 	{ utc_image_util_file_rotate_2_p, 14},
 	{ utc_image_util_file_rotate_3_p, 15},
+	{ utc_image_util_convert_colorspace_3_p, 16},
+	{ utc_image_util_set_num_threads_p, 17},
+	{ utc_image_util_set_num_threads_n, 18},
+	{ utc_image_util_get_num_threads_n, 19},
+	{ utc_image_util_get_plane_layout_p, 20},
+	{ utc_image_util_get_plane_layout_n, 21},
+	{ utc_image_util_convert_colorspace_ex_p, 22},
+	{ utc_image_util_convert_colorspace_ex_n, 23},
+	{ utc_image_util_crop_ex_n, 24},
+	{ utc_image_util_transform_create_p, 25},
+	{ utc_image_util_transform_run_p, 26},
+	{ utc_image_util_transform_run_n, 27},
+	{ utc_image_util_convert_colorspace_4_p, 28},
+	{ utc_image_util_convert_colorspace_5_p, 29},
+	{ utc_image_util_convert_colorspace_6_p, 30},
+	{ utc_image_util_convert_colorspace_7_p, 31},
+	{ utc_image_util_crop_ex_2_n, 32},
+	{ utc_image_util_transform_run_2_n, 33},
+	{ utc_image_util_resize_with_filter_n, 34},
+	{ utc_image_util_resize_with_filter_p, 35},
+	{ utc_image_util_resize_with_filter_2_p, 36},
+	{ utc_image_util_resize_with_filter_3_p, 37},
+	{ utc_image_util_file_rotate_4_p, 38},
+	{ utc_image_util_file_rotate_5_p, 39},
+	{ utc_image_util_file_rotate_6_p, 40},
+	{ utc_image_util_rotate_in_place_n, 41},
+	{ utc_image_util_rotate_in_place_p, 42},
+	{ utc_image_util_crop_view_n, 43},
+	{ utc_image_util_crop_view_2_n, 44},
+	{ utc_image_util_crop_view_p, 45},
+	{ utc_image_util_image_create_n, 46},
+	{ utc_image_util_image_create_p, 47},
+	{ utc_image_util_set_allocator_n, 48},
+	{ utc_image_util_set_allocator_p, 49},
+	{ utc_image_util_set_hugepages_p, 50},
+	{ utc_image_util_decode_jpeg_aligned_p, 51},
 	{ NULL, 0},
 };
 
 
+//known conversions, the values follow from the BT.601 studio range coefficients
+typedef struct
+{
+	unsigned char y, u, v;
+	unsigned char r, g, b;
+} known_color_s;
+
+#define KC_COUNT 4
+const known_color_s yuv_to_rgb_colors[KC_COUNT] =
+{
+	{  16, 128, 128,   0,   0,   0 },
+	{ 235, 128, 128, 255, 255, 255 },
+	{ 128, 128, 128, 130, 130, 130 },
+	{  81,  90, 240, 254,   0,   0 },
+};
+const known_color_s rgb_to_yuv_colors[KC_COUNT] =
+{
+	{  16, 128, 128,   0,   0,   0 },
+	{ 235, 128, 128, 255, 255, 255 },
+	{ 128, 128, 128, 130, 130, 130 },
+	{  82,  90, 240, 255,   0,   0 },
+};
+
+//conversions compared between the vector kernels and the C kernels
+#define SIMD_WIDTH	70	// not a multiple of the vector width, the row tails are converted too
+#define SIMD_HEIGHT	34
+#define SC_COUNT 6
+const image_util_colorspace_e simd_conversions[SC_COUNT][2] =
+{
+	{ IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_COLORSPACE_I420 },
+	{ IMAGE_UTIL_COLORSPACE_I420, IMAGE_UTIL_COLORSPACE_RGBA8888 },
+	{ IMAGE_UTIL_COLORSPACE_RGBA8888, IMAGE_UTIL_COLORSPACE_NV12 },
+	{ IMAGE_UTIL_COLORSPACE_NV12, IMAGE_UTIL_COLORSPACE_RGB888 },
+	{ IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_COLORSPACE_YUYV },
+	{ IMAGE_UTIL_COLORSPACE_YUYV, IMAGE_UTIL_COLORSPACE_RGBA8888 },
+};
+
+static unsigned char * simd_none_result = NULL;
+static unsigned int simd_none_size = 0;
+
+static unsigned char * convert_simd_pattern( unsigned int * size );
+
+
 static void startup(void)
 {
 	// TC start
+	// the kernels are picked once per process, so the C results are made in a child
+	// that starts with IMAGE_UTIL_SIMD=none before anything was converted here
+	unsigned int offset = 0;
+	int fds[2];
+	pid_t pid;
+
+	if( pipe( fds ) != 0 )
+		return;
+
+	pid = fork();
+	if( pid == 0 ){
+		unsigned int size = 0;
+		unsigned char * result;
+
+		close( fds[0] );
+		setenv( "IMAGE_UTIL_SIMD", "none", 1 );
+		result = convert_simd_pattern( &size );
+		while( result && offset < size ){
+			ssize_t n = write( fds[1], result + offset, size - offset );
+			if( n <= 0 )
+				break;
+			offset += n;
+		}
+		_exit( result && offset == size ? 0 : 1 );
+	}
+
+	close( fds[1] );
+	if( pid > 0 ){
+		unsigned char buffer[4096];
+		ssize_t n;
+
+		while( (n = read( fds[0], buffer, sizeof(buffer) )) > 0 ){
+			unsigned char * grown = realloc( simd_none_result, simd_none_size + n );
+			if( grown == NULL )
+				break;
+			memcpy( grown + simd_none_size, buffer, n );
+			simd_none_result = grown;
+			simd_none_size += n;
+		}
+		waitpid( pid, NULL, 0 );
+	}
+	close( fds[0] );
 }
 
 static void cleanup(void)
 {
 	// TC end
+	free( simd_none_result );
+	simd_none_result = NULL;
+	simd_none_size = 0;
 }
 
 
@@ -160,6 +357,281 @@ static bool jpeg_colorspace_size_cb( image_util_colorspace_e colorspace, void *
 
 
 
+// fills a 4:2:0 or 4:2:2 image with one color
+static void fill_yuv( unsigned char * buf, image_util_colorspace_e colorspace, int width, int height, const known_color_s * color )
+{
+	int i, luma = width * height, chroma = width * height / 4;
+
+	switch( colorspace ){
+	case IMAGE_UTIL_COLORSPACE_I420:
+		memset( buf, color->y, luma );
+		memset( buf + luma, color->u, chroma );
+		memset( buf + luma + chroma, color->v, chroma );
+		break;
+	case IMAGE_UTIL_COLORSPACE_NV12:
+		memset( buf, color->y, luma );
+		for( i = 0; i < chroma; ++i ){
+			buf[luma + 2 * i] = color->u;
+			buf[luma + 2 * i + 1] = color->v;
+		}
+		break;
+	default:	// YUYV
+		for( i = 0; i < luma / 2; ++i ){
+			buf[4 * i] = color->y;
+			buf[4 * i + 1] = color->u;
+			buf[4 * i + 2] = color->y;
+			buf[4 * i + 3] = color->v;
+		}
+		break;
+	}
+}
+
+// checks that every sample of a 4:2:0 or 4:2:2 image has the color
+static bool check_yuv( const unsigned char * buf, image_util_colorspace_e colorspace, int width, int height, const known_color_s * color )
+{
+	int i, luma = width * height, chroma = width * height / 4;
+
+	switch( colorspace ){
+	case IMAGE_UTIL_COLORSPACE_I420:
+		for( i = 0; i < luma; ++i )
+			if( buf[i] != color->y )
+				return false;
+		for( i = 0; i < chroma; ++i )
+			if( buf[luma + i] != color->u || buf[luma + chroma + i] != color->v )
+				return false;
+		return true;
+	case IMAGE_UTIL_COLORSPACE_NV12:
+		for( i = 0; i < luma; ++i )
+			if( buf[i] != color->y )
+				return false;
+		for( i = 0; i < chroma; ++i )
+			if( buf[luma + 2 * i] != color->u || buf[luma + 2 * i + 1] != color->v )
+				return false;
+		return true;
+	default:	// YUYV
+		for( i = 0; i < luma / 2; ++i )
+			if( buf[4 * i] != color->y || buf[4 * i + 1] != color->u || buf[4 * i + 2] != color->y || buf[4 * i + 3] != color->v )
+				return false;
+		return true;
+	}
+}
+
+// fills an RGB888 or RGBA8888 image with one color
+static void fill_rgb( unsigned char * buf, image_util_colorspace_e colorspace, int width, int height, const known_color_s * color )
+{
+	int i, bpp = colorspace == IMAGE_UTIL_COLORSPACE_RGB888 ? 3 : 4;
+
+	for( i = 0; i < width * height; ++i ){
+		buf[bpp * i] = color->r;
+		buf[bpp * i + 1] = color->g;
+		buf[bpp * i + 2] = color->b;
+		if( bpp == 4 )
+			buf[bpp * i + 3] = 0xff;
+	}
+}
+
+// checks that every pixel of an RGB888 or RGBA8888 image has the color and is opaque
+static bool check_rgb( const unsigned char * buf, image_util_colorspace_e colorspace, int width, int height, const known_color_s * color )
+{
+	int i, bpp = colorspace == IMAGE_UTIL_COLORSPACE_RGB888 ? 3 : 4;
+
+	for( i = 0; i < width * height; ++i ){
+		if( buf[bpp * i] != color->r || buf[bpp * i + 1] != color->g || buf[bpp * i + 2] != color->b )
+			return false;
+		if( bpp == 4 && buf[bpp * i + 3] != 0xff )
+			return false;
+	}
+	return true;
+}
+
+// points planes into a packed buffer of the layout
+static void packed_planes( unsigned char * buf, const image_util_plane_layout_s * layout, image_util_planes_s * planes )
+{
+	int p;
+
+	memset( planes, 0, sizeof(image_util_planes_s) );
+	for( p = 0; p < layout->num_planes; ++p ){
+		planes->data[p] = buf + layout->offset[p];
+		planes->stride[p] = layout->stride[p];
+	}
+}
+
+// converts the known colors from yuv to rgb and back in the library
+static int convert_known_colors( image_util_colorspace_e yuv, image_util_colorspace_e rgb )
+{
+	const int width = 40, height = 4; // one vector body and a tail per row
+	image_util_plane_layout_s yuv_layout, rgb_layout;
+	image_util_planes_s yuv_planes, rgb_planes;
+	unsigned char * yuv_buf = 0;
+	unsigned char * rgb_buf = 0;
+	int i;
+
+	int ret = image_util_get_plane_layout( width, height, yuv, 1, &yuv_layout );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_get_plane_layout( width, height, rgb, 1, &rgb_layout );
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	yuv_buf = malloc( yuv_layout.size );
+	rgb_buf = malloc( rgb_layout.size );
+	if( yuv_buf == NULL || rgb_buf == NULL )
+		ret = IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	else{
+		packed_planes( yuv_buf, &yuv_layout, &yuv_planes );
+		packed_planes( rgb_buf, &rgb_layout, &rgb_planes );
+	}
+
+	for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < KC_COUNT; ++i ){
+		fill_yuv( yuv_buf, yuv, width, height, &yuv_to_rgb_colors[i] );
+		ret = image_util_convert_colorspace_ex( &rgb_planes, rgb, &yuv_planes, width, height, yuv );
+		if( ret == IMAGE_UTIL_ERROR_NONE && !check_rgb( rgb_buf, rgb, width, height, &yuv_to_rgb_colors[i] ) )
+			ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+	for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < KC_COUNT; ++i ){
+		fill_rgb( rgb_buf, rgb, width, height, &rgb_to_yuv_colors[i] );
+		ret = image_util_convert_colorspace_ex( &yuv_planes, yuv, &rgb_planes, width, height, rgb );
+		if( ret == IMAGE_UTIL_ERROR_NONE && !check_yuv( yuv_buf, yuv, width, height, &rgb_to_yuv_colors[i] ) )
+			ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+
+	free( yuv_buf );
+	free( rgb_buf );
+	return ret;
+}
+
+// runs the conversions of simd_conversions on a noise pattern in the library, the results are concatenated
+static unsigned char * convert_simd_pattern( unsigned int * size )
+{
+	unsigned int total = 0;
+	unsigned int seed = 12345;
+	unsigned char * src = 0;
+	unsigned char * result = 0;
+	image_util_plane_layout_s src_layout, dest_layout;
+	image_util_planes_s src_planes, dest_planes;
+	int i, ret = IMAGE_UTIL_ERROR_NONE;
+
+	for( i = 0; i < SC_COUNT; ++i ){
+		if( image_util_get_plane_layout( SIMD_WIDTH, SIMD_HEIGHT, simd_conversions[i][1], 1, &dest_layout ) != IMAGE_UTIL_ERROR_NONE )
+			return NULL;
+		total += dest_layout.size;
+	}
+	result = malloc( total );
+	src = malloc( SIMD_WIDTH * SIMD_HEIGHT * 4 );
+	if( result == NULL || src == NULL ){
+		free( result );
+		free( src );
+		return NULL;
+	}
+	for( i = 0; i < SIMD_WIDTH * SIMD_HEIGHT * 4; ++i ){
+		seed = seed * 1103515245 + 12345;
+		src[i] = seed >> 16;
+	}
+
+	total = 0;
+	for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < SC_COUNT; ++i ){
+		ret = image_util_get_plane_layout( SIMD_WIDTH, SIMD_HEIGHT, simd_conversions[i][0], 1, &src_layout );
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = image_util_get_plane_layout( SIMD_WIDTH, SIMD_HEIGHT, simd_conversions[i][1], 1, &dest_layout );
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			break;
+		packed_planes( src, &src_layout, &src_planes );
+		packed_planes( result + total, &dest_layout, &dest_planes );
+		ret = image_util_convert_colorspace_ex( &dest_planes, simd_conversions[i][1], &src_planes, SIMD_WIDTH, SIMD_HEIGHT, simd_conversions[i][0] );
+		total += dest_layout.size;
+	}
+	free( src );
+
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		free( result );
+		return NULL;
+	}
+	*size = total;
+	return result;
+}
+
+
+// allocator counting its allocations in user_data[0] and its frees in user_data[1]
+static void * counting_alloc( size_t size, void * user_data )
+{
+	((int*)user_data)[0]++;
+	return malloc( size );
+}
+
+static void counting_free( void * data, void * user_data )
+{
+	((int*)user_data)[1]++;
+	free( data );
+}
+
+static void * counting_aligned_alloc( size_t alignment, size_t size, void * user_data )
+{
+	void * data = NULL;
+
+	((int*)user_data)[0]++;
+	if( posix_memalign( &data, alignment, size ) != 0 )
+		return NULL;
+	return data;
+}
+
+// turns a noise pattern by 90 and 270 degrees and compares every plane with a plain transpose,
+// bytes gives the size of the plane elements, e.g. 2 for the NV12 chroma pairs
+static int rotate_pattern( image_util_colorspace_e colorspace, int width, int height, const int * bytes )
+{
+	const image_util_rotation_e rotations[2] = { IMAGE_UTIL_ROTATION_90, IMAGE_UTIL_ROTATION_270 };
+	image_util_plane_layout_s src_layout, dest_layout;
+	unsigned int seed = 4321;
+	unsigned char * src = 0;
+	unsigned char * dest = 0;
+	int i, p, x, y;
+
+	int ret = image_util_get_plane_layout( width, height, colorspace, 1, &src_layout );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_get_plane_layout( height, width, colorspace, 1, &dest_layout );
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	src = malloc( src_layout.size );
+	dest = malloc( dest_layout.size );
+	if( src == NULL || dest == NULL ){
+		free( src );
+		free( dest );
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	}
+	for( i = 0; i < src_layout.size; ++i ){
+		seed = seed * 1103515245 + 12345;
+		src[i] = seed >> 16;
+	}
+
+	for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < 2; ++i ){
+		int dest_width = 0, dest_height = 0;
+
+		memset( dest, 0, dest_layout.size );
+		ret = image_util_rotate( dest, &dest_width, &dest_height, rotations[i], src, width, height, colorspace );
+		if( ret == IMAGE_UTIL_ERROR_NONE && (dest_width != height || dest_height != width) )
+			ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+		// 90 degrees turn clockwise, the first source column becomes the first row, bottom up
+		for( p = 0; ret == IMAGE_UTIL_ERROR_NONE && p < src_layout.num_planes; ++p ){
+			int src_elements = src_layout.stride[p] / bytes[p];
+			int src_rows = src_layout.height[p];
+			for( y = 0; y < src_elements; ++y ){
+				for( x = 0; x < src_rows; ++x ){
+					int sx = rotations[i] == IMAGE_UTIL_ROTATION_90 ? y : src_elements - 1 - y;
+					int sy = rotations[i] == IMAGE_UTIL_ROTATION_90 ? src_rows - 1 - x : x;
+					if( memcmp( dest + dest_layout.offset[p] + y * dest_layout.stride[p] + x * bytes[p],
+								src + src_layout.offset[p] + sy * src_layout.stride[p] + sx * bytes[p], bytes[p] ) != 0 )
+						ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+				}
+			}
+		}
+	}
+
+	free( src );
+	free( dest );
+	return ret;
+}
+
+
+
 
 
 /**
@@ -541,3 +1013,901 @@ static void utc_image_util_file_rotate_3_p(void)
 
     dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_NONE );
 }
+
+
+
+
+
+/**
+ * @brief check if color conversion gives the same result with several threads
+ */
+static void utc_image_util_convert_colorspace_3_p(void)
+{
+	int width = 0, height = 0;
+	unsigned int size_decode = 0;
+	unsigned char * img_target_1 = 0;
+	unsigned char * img_target_4 = 0;
+	unsigned char * img_source = 0;
+	image_util_plane_layout_s layout;
+	image_util_planes_s src_planes, planes_1, planes_4;
+	const image_util_colorspace_e cs_target = IMAGE_UTIL_COLORSPACE_I420;
+	const image_util_colorspace_e cs_source = IMAGE_UTIL_COLORSPACE_RGB888;
+
+	// load jpeg sample file
+	image_util_decode_jpeg( SAMPLE_FILENAME, cs_source, &img_source, &width, &height, &size_decode );
+	int ret = image_util_get_plane_layout( width, height, cs_target, 1, &layout );
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		free( img_source );
+		dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+		return;
+	}
+	img_target_1 = malloc( layout.size );
+	img_target_4 = malloc( layout.size );
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	src_planes.data[0] = img_source;
+	src_planes.stride[0] = width * 3;
+	packed_planes( img_target_1, &layout, &planes_1 );
+	packed_planes( img_target_4, &layout, &planes_4 );
+
+	// do conversion with one and with four threads
+	image_util_set_num_threads( 1 );
+	ret = image_util_convert_colorspace_ex( &planes_1, cs_target, &src_planes, width, height, cs_source );
+	image_util_set_num_threads( 4 );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_convert_colorspace_ex( &planes_4, cs_target, &src_planes, width, height, cs_source );
+	image_util_set_num_threads( 1 );
+
+	if( ret == IMAGE_UTIL_ERROR_NONE && memcmp( img_target_1, img_target_4, layout.size ) != 0 )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+    free( img_target_1 );
+    free( img_target_4 );
+    free( img_source );
+
+    dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief set the number of threads and read it back
+ */
+static void utc_image_util_set_num_threads_p(void)
+{
+	int num_threads = 0;
+
+	int ret = image_util_set_num_threads( 4 );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_get_num_threads( &num_threads );
+	image_util_set_num_threads( 1 );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_NUM_THREADS, ret == IMAGE_UTIL_ERROR_NONE && num_threads == 4, 1 );
+}
+
+
+
+
+/**
+ * @brief check if setting the number of threads has the verification of input parameters
+ */
+static void utc_image_util_set_num_threads_n(void)
+{
+	int ret = image_util_set_num_threads( 0 ); // at least the calling thread is needed
+	dts_check_eq( API_NAME_IMAGEUTIL_NUM_THREADS, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief check if getting the number of threads has the verification of input parameters
+ */
+static void utc_image_util_get_num_threads_n(void)
+{
+	int ret = image_util_get_num_threads( NULL );
+	dts_check_eq( API_NAME_IMAGEUTIL_NUM_THREADS, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief the layout with alignment 1 must match the buffer size calculation
+ */
+static void utc_image_util_get_plane_layout_p(void)
+{
+	image_util_plane_layout_s layout;
+	unsigned int size = 0;
+
+	image_util_calculate_buffer_size( 480, 320, IMAGE_UTIL_COLORSPACE_I420, &size );
+	int ret = image_util_get_plane_layout( 480, 320, IMAGE_UTIL_COLORSPACE_I420, 1, &layout );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_PLANE_LAYOUT, ret == IMAGE_UTIL_ERROR_NONE && layout.num_planes == 3 && layout.size == size, 1 );
+}
+
+
+
+
+/**
+ * @brief check if the plane layout has the verification of input parameters
+ */
+static void utc_image_util_get_plane_layout_n(void)
+{
+	image_util_plane_layout_s layout;
+
+	int ret = image_util_get_plane_layout( 480, 320, IMAGE_UTIL_COLORSPACE_I420, 3, &layout ); // not a power of two
+	dts_check_eq( API_NAME_IMAGEUTIL_PLANE_LAYOUT, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief convert into a buffer with aligned rows and compare with the packed conversion
+ */
+static void utc_image_util_convert_colorspace_ex_p(void)
+{
+	int width = 0, height = 0;
+	int size_decode = 0;
+	unsigned char * img_packed = 0;
+	unsigned char * img_aligned = 0;
+	unsigned char * img_source = 0;
+	image_util_plane_layout_s packed, aligned;
+	image_util_planes_s src_planes, dest_planes, packed_dest;
+	int i, row;
+
+	// load jpeg sample file
+	int ret = image_util_decode_jpeg( SAMPLE_FILENAME, IMAGE_UTIL_COLORSPACE_RGB888, &img_source, &width, &height, &size_decode );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_get_plane_layout( width, height, IMAGE_UTIL_COLORSPACE_NV12, 1, &packed );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_get_plane_layout( width, height, IMAGE_UTIL_COLORSPACE_NV12, 64, &aligned );
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		free( img_source );
+		dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+		return;
+	}
+
+	img_packed = malloc( packed.size );
+	img_aligned = malloc( aligned.size );
+	if( img_packed == NULL || img_aligned == NULL ){
+		free( img_packed );
+		free( img_aligned );
+		free( img_source );
+		dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, IMAGE_UTIL_ERROR_OUT_OF_MEMORY, IMAGE_UTIL_ERROR_NONE );
+		return;
+	}
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = img_source;
+	src_planes.stride[0] = width * 3;
+	for( i = 0; i < aligned.num_planes; ++i ){
+		dest_planes.data[i] = img_aligned + aligned.offset[i];
+		dest_planes.stride[i] = aligned.stride[i];
+	}
+
+	packed_planes( img_packed, &packed, &packed_dest );
+	ret = image_util_convert_colorspace_ex( &packed_dest, IMAGE_UTIL_COLORSPACE_NV12, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888 );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_convert_colorspace_ex( &dest_planes, IMAGE_UTIL_COLORSPACE_NV12, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888 );
+
+	for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < packed.num_planes; ++i ){
+		for( row = 0; row < packed.height[i]; ++row ){
+			if( memcmp( img_packed + packed.offset[i] + row * packed.stride[i],
+						img_aligned + aligned.offset[i] + row * aligned.stride[i], packed.stride[i] ) != 0 )
+				ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+		}
+	}
+
+	free( img_packed );
+	free( img_aligned );
+	free( img_source );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief check if color conversion with planes has the verification of input parameters
+ */
+static void utc_image_util_convert_colorspace_ex_n(void)
+{
+	unsigned char buffer[16 * 16 * 4];
+	image_util_planes_s src_planes, dest_planes;
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = buffer;
+	src_planes.stride[0] = 16 * 4;
+	dest_planes.data[0] = buffer; // chroma planes are missing
+
+	int ret = image_util_convert_colorspace_ex( &dest_planes, IMAGE_UTIL_COLORSPACE_I420, &src_planes, 16, 16, IMAGE_UTIL_COLORSPACE_RGBA8888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief crop of a subsampled colorspace must start on a chroma sample
+ */
+static void utc_image_util_crop_ex_n(void)
+{
+	unsigned char src[16 * 16 * 3 / 2];
+	unsigned char dest[8 * 8 * 3 / 2];
+	image_util_planes_s src_planes, dest_planes;
+
+	src_planes.data[0] = src;
+	src_planes.data[1] = src + 16 * 16;
+	src_planes.data[2] = src + 16 * 16 + 8 * 8;
+	src_planes.stride[0] = 16;
+	src_planes.stride[1] = src_planes.stride[2] = 8;
+	dest_planes.data[0] = dest;
+	dest_planes.data[1] = dest + 8 * 8;
+	dest_planes.data[2] = dest + 8 * 8 + 4 * 4;
+	dest_planes.stride[0] = 8;
+	dest_planes.stride[1] = dest_planes.stride[2] = 4;
+
+	int ret = image_util_crop_ex( &dest_planes, 1, 1, 8, 8, &src_planes, 16, 16, IMAGE_UTIL_COLORSPACE_I420 ); // odd start
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief create and destroy a transformation handle
+ */
+static void utc_image_util_transform_create_p(void)
+{
+	image_util_transform_h handle = NULL;
+
+	int ret = image_util_transform_create( &handle );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_transform_destroy( handle );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM_HANDLE, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief crop, resize, rotate and convert in one pass and compare with the single operations
+ */
+static void utc_image_util_transform_run_p(void)
+{
+	int width = 0, height = 0;
+	int dest_width = 0, dest_height = 0;
+	int size_decode = 0;
+	unsigned int size = 0;
+	unsigned char * img_source = 0;
+	unsigned char * img_crop = 0;
+	unsigned char * img_resize = 0;
+	unsigned char * img_rotate = 0;
+	unsigned char * img_chained = 0;
+	unsigned char * img_target = 0;
+	image_util_transform_h handle = NULL;
+	image_util_planes_s src_planes, dest_planes;
+	const int crop_width = 320, crop_height = 240;
+	const int resize_width = 160, resize_height = 120;
+
+	// load jpeg sample file
+	image_util_decode_jpeg( SAMPLE_FILENAME, IMAGE_UTIL_COLORSPACE_RGB888, &img_source, &width, &height, &size_decode );
+
+	// the single operations
+	img_crop = malloc( crop_width * crop_height * 3 );
+	img_resize = malloc( resize_width * resize_height * 3 );
+	img_rotate = malloc( resize_width * resize_height * 3 );
+	image_util_calculate_buffer_size( resize_height, resize_width, IMAGE_UTIL_COLORSPACE_NV12, &size );
+	img_chained = malloc( size );
+	img_target = malloc( size );
+
+	int w = crop_width, h = crop_height;
+	image_util_crop( img_crop, 16, 8, &w, &h, img_source, width, height, IMAGE_UTIL_COLORSPACE_RGB888 );
+	w = resize_width;
+	h = resize_height;
+	image_util_resize( img_resize, &w, &h, img_crop, crop_width, crop_height, IMAGE_UTIL_COLORSPACE_RGB888 );
+	image_util_rotate( img_rotate, &w, &h, IMAGE_UTIL_ROTATION_90, img_resize, resize_width, resize_height, IMAGE_UTIL_COLORSPACE_RGB888 );
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = img_rotate;
+	src_planes.stride[0] = w * 3;
+	dest_planes.data[0] = img_chained;
+	dest_planes.data[1] = img_chained + w * h;
+	dest_planes.stride[0] = dest_planes.stride[1] = w;
+	image_util_convert_colorspace_ex( &dest_planes, IMAGE_UTIL_COLORSPACE_NV12, &src_planes, w, h, IMAGE_UTIL_COLORSPACE_RGB888 );
+
+	// the same in one pass
+	int ret = image_util_transform_create( &handle );
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		image_util_transform_set_crop_area( handle, 16, 8, crop_width, crop_height );
+		image_util_transform_set_resolution( handle, resize_width, resize_height );
+		image_util_transform_set_rotation( handle, IMAGE_UTIL_ROTATION_90 );
+		image_util_transform_set_colorspace( handle, IMAGE_UTIL_COLORSPACE_NV12 );
+		ret = image_util_transform_get_dest_resolution( handle, width, height, IMAGE_UTIL_COLORSPACE_RGB888, &dest_width, &dest_height );
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		memset( &src_planes, 0, sizeof(src_planes) );
+		memset( &dest_planes, 0, sizeof(dest_planes) );
+		src_planes.data[0] = img_source;
+		src_planes.stride[0] = width * 3;
+		dest_planes.data[0] = img_target;
+		dest_planes.data[1] = img_target + dest_width * dest_height;
+		dest_planes.stride[0] = dest_planes.stride[1] = dest_width;
+		ret = image_util_transform_run( handle, &dest_planes, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888 );
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE && (dest_width != w || dest_height != h || memcmp( img_chained, img_target, size ) != 0) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	image_util_transform_destroy( handle );
+	free( img_source );
+	free( img_crop );
+	free( img_resize );
+	free( img_rotate );
+	free( img_chained );
+	free( img_target );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM_HANDLE, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief check if the transformation has the verification of the crop area
+ */
+static void utc_image_util_transform_run_n(void)
+{
+	unsigned char src[16 * 16 * 3];
+	unsigned char dest[16 * 16 * 3];
+	image_util_transform_h handle = NULL;
+	image_util_planes_s src_planes, dest_planes;
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = src;
+	src_planes.stride[0] = 16 * 3;
+	dest_planes.data[0] = dest;
+	dest_planes.stride[0] = 16 * 3;
+
+	image_util_transform_create( &handle );
+	image_util_transform_set_crop_area( handle, 8, 8, 16, 16 ); // outside of the source
+	int ret = image_util_transform_run( handle, &dest_planes, &src_planes, 16, 16, IMAGE_UTIL_COLORSPACE_RGB888 );
+	image_util_transform_destroy( handle );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM_HANDLE, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief convert known colors between I420 and RGB888
+ */
+static void utc_image_util_convert_colorspace_4_p(void)
+{
+	int ret = convert_known_colors( IMAGE_UTIL_COLORSPACE_I420, IMAGE_UTIL_COLORSPACE_RGB888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief convert known colors between NV12 and RGBA8888
+ */
+static void utc_image_util_convert_colorspace_5_p(void)
+{
+	int ret = convert_known_colors( IMAGE_UTIL_COLORSPACE_NV12, IMAGE_UTIL_COLORSPACE_RGBA8888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief convert known colors between YUYV and RGB888
+ */
+static void utc_image_util_convert_colorspace_6_p(void)
+{
+	int ret = convert_known_colors( IMAGE_UTIL_COLORSPACE_YUYV, IMAGE_UTIL_COLORSPACE_RGB888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief the default kernels must convert like the C kernels picked with IMAGE_UTIL_SIMD=none
+ */
+static void utc_image_util_convert_colorspace_7_p(void)
+{
+	unsigned int size = 0;
+	unsigned char * result = convert_simd_pattern( &size );
+	int ret = IMAGE_UTIL_ERROR_NONE;
+
+	if( result == NULL || simd_none_result == NULL )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	else if( size != simd_none_size || memcmp( result, simd_none_result, size ) != 0 )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	free( result );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_COLOR_CONVERT_EX, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief a crop area reaching past the source must be refused even if its end overflows an int
+ */
+static void utc_image_util_crop_ex_2_n(void)
+{
+	unsigned char src[16 * 16 * 3];
+	unsigned char dest[16 * 16 * 3];
+	image_util_planes_s src_planes, dest_planes;
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = src;
+	src_planes.stride[0] = 16 * 3;
+	dest_planes.data[0] = dest;
+	dest_planes.stride[0] = 16 * 3;
+
+	int ret = image_util_crop_ex( &dest_planes, 8, 0, INT_MAX, 8, &src_planes, 16, 16, IMAGE_UTIL_COLORSPACE_RGB888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief a crop area whose end overflows an int must be refused by the transformation
+ */
+static void utc_image_util_transform_run_2_n(void)
+{
+	image_util_transform_h handle = NULL;
+	int dest_width = 0, dest_height = 0;
+
+	image_util_transform_create( &handle );
+	image_util_transform_set_crop_area( handle, 8, 8, INT_MAX, 8 );
+	int ret = image_util_transform_get_dest_resolution( handle, 16, 16, IMAGE_UTIL_COLORSPACE_RGB888, &dest_width, &dest_height );
+	image_util_transform_destroy( handle );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM_HANDLE, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief check if resizing has the verification of the filter
+ */
+static void utc_image_util_resize_with_filter_n(void)
+{
+	unsigned char rgb[64 * 32 * 3] = { 0, };
+	unsigned char resized[16 * 8 * 3];
+	image_util_planes_s src = { { rgb }, { 64 * 3 } };
+	image_util_planes_s dest = { { resized }, { 16 * 3 } };
+
+	int ret = image_util_resize_with_filter( &dest, 16, 8, &src, 64, 32, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_AREA + 1 );
+	dts_check_eq( API_NAME_IMAGEUTIL_RESIZE_WITH_FILTER, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief a flat image stays flat with every filter
+ */
+static void utc_image_util_resize_with_filter_p(void)
+{
+	int ret = IMAGE_UTIL_ERROR_NONE;
+	int filter, i;
+	unsigned char rgb[64 * 32 * 3];
+	unsigned char resized[16 * 8 * 3];
+	image_util_planes_s src = { { rgb }, { 64 * 3 } };
+	image_util_planes_s dest = { { resized }, { 16 * 3 } };
+
+	memset( rgb, 0x80, sizeof(rgb) );
+	for( filter = IMAGE_UTIL_RESIZE_FILTER_NEAREST; ret == IMAGE_UTIL_ERROR_NONE && filter <= IMAGE_UTIL_RESIZE_FILTER_AREA; ++filter ){
+		memset( resized, 0, sizeof(resized) );
+		ret = image_util_resize_with_filter( &dest, 16, 8, &src, 64, 32, IMAGE_UTIL_COLORSPACE_RGB888, filter );
+		for( i = 0; ret == IMAGE_UTIL_ERROR_NONE && i < sizeof(resized); ++i ){
+			if( resized[i] != 0x80 )
+				ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+		}
+	}
+
+	dts_check_eq( API_NAME_IMAGEUTIL_RESIZE_WITH_FILTER, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief halving a ramp with the nearest filter picks every second source pixel,
+ *        the bilinear filter averages them and gives another image
+ */
+static void utc_image_util_resize_with_filter_2_p(void)
+{
+	const int width = 32, height = 16;
+	unsigned char ramp[32 * 16 * 3];
+	unsigned char nearest[16 * 8 * 3];
+	unsigned char bilinear[16 * 8 * 3];
+	image_util_planes_s src = { { ramp }, { 32 * 3 } };
+	image_util_planes_s dest_nearest = { { nearest }, { 16 * 3 } };
+	image_util_planes_s dest_bilinear = { { bilinear }, { 16 * 3 } };
+	int x, y;
+
+	for( y = 0; y < height; ++y ){
+		for( x = 0; x < width; ++x ){
+			ramp[(y * width + x) * 3] = x * 8;
+			ramp[(y * width + x) * 3 + 1] = y * 16;
+			ramp[(y * width + x) * 3 + 2] = x + y;
+		}
+	}
+
+	int ret = image_util_resize_with_filter( &dest_nearest, 16, 8, &src, width, height, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_NEAREST );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_resize_with_filter( &dest_bilinear, 16, 8, &src, width, height, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_BILINEAR );
+
+	// the center of destination pixel x is on the left edge of source pixel 2 * x + 1
+	for( y = 0; ret == IMAGE_UTIL_ERROR_NONE && y < 8; ++y ){
+		for( x = 0; x < 16; ++x ){
+			if( memcmp( nearest + (y * 16 + x) * 3, ramp + ((2 * y + 1) * width + 2 * x + 1) * 3, 3 ) != 0 )
+				ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+		}
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE && memcmp( nearest, bilinear, sizeof(nearest) ) == 0 )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	dts_check_eq( API_NAME_IMAGEUTIL_RESIZE_WITH_FILTER, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+/**
+ * @brief resizing again with the cached plans gives the same image,
+ *        also after the plans of another filter were made in between
+ */
+static void utc_image_util_resize_with_filter_3_p(void)
+{
+	int width = 0, height = 0;
+	int size_decode = 0;
+	unsigned char * img_source = 0;
+	unsigned char * img_first = 0;
+	unsigned char * img_other = 0;
+	unsigned char * img_second = 0;
+	image_util_planes_s src_planes, dest_planes;
+	const int dest_width = 200, dest_height = 130;
+	const unsigned int size = dest_width * dest_height * 3;
+
+	// load jpeg sample file
+	int ret = image_util_decode_jpeg( SAMPLE_FILENAME, IMAGE_UTIL_COLORSPACE_RGB888, &img_source, &width, &height, &size_decode );
+	img_first = malloc( size );
+	img_other = malloc( size );
+	img_second = malloc( size );
+	if( ret == IMAGE_UTIL_ERROR_NONE && (img_first == NULL || img_other == NULL || img_second == NULL) )
+		ret = IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	memset( &src_planes, 0, sizeof(src_planes) );
+	memset( &dest_planes, 0, sizeof(dest_planes) );
+	src_planes.data[0] = img_source;
+	src_planes.stride[0] = width * 3;
+	dest_planes.stride[0] = dest_width * 3;
+
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		dest_planes.data[0] = img_first;
+		ret = image_util_resize_with_filter( &dest_planes, dest_width, dest_height, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_BICUBIC );
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		dest_planes.data[0] = img_other;
+		ret = image_util_resize_with_filter( &dest_planes, dest_width, dest_height, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_LANCZOS );
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		dest_planes.data[0] = img_second;
+		ret = image_util_resize_with_filter( &dest_planes, dest_width, dest_height, &src_planes, width, height, IMAGE_UTIL_COLORSPACE_RGB888, IMAGE_UTIL_RESIZE_FILTER_BICUBIC );
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE && (memcmp( img_first, img_second, size ) != 0 || memcmp( img_first, img_other, size ) == 0) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	free( img_source );
+	free( img_first );
+	free( img_other );
+	free( img_second );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_RESIZE_WITH_FILTER, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+/**
+ * @brief turn I420 by 90 and 270 degrees and compare with a plain transpose
+ */
+static void utc_image_util_file_rotate_4_p(void)
+{
+	const int bytes[3] = { 1, 1, 1 };
+	int ret = rotate_pattern( IMAGE_UTIL_COLORSPACE_I420, 150, 86, bytes ); // more than a tile and not a multiple of it
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief turn NV12 by 90 and 270 degrees, the chroma pairs must stay together
+ */
+static void utc_image_util_file_rotate_5_p(void)
+{
+	const int bytes[2] = { 1, 2 };
+	int ret = rotate_pattern( IMAGE_UTIL_COLORSPACE_NV12, 150, 86, bytes );
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief turn RGB888 of odd size by 90 and 270 degrees, the edges are not whole vector blocks
+ */
+static void utc_image_util_file_rotate_6_p(void)
+{
+	const int bytes[1] = { 3 };
+	int ret = rotate_pattern( IMAGE_UTIL_COLORSPACE_RGB888, 67, 35, bytes );
+	dts_check_eq( API_NAME_IMAGEUTIL_TRANSFORM, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief a quarter turn in place needs a square image
+ */
+static void utc_image_util_rotate_in_place_n(void)
+{
+	unsigned char rgb[4 * 2 * 3] = { 0, };
+	image_util_planes_s planes = { { rgb }, { 4 * 3 } };
+
+	int ret = image_util_rotate_in_place( &planes, IMAGE_UTIL_ROTATION_90, 4, 2, IMAGE_UTIL_COLORSPACE_RGB888 );
+	dts_check_eq( API_NAME_IMAGEUTIL_ROTATE_IN_PLACE, ret, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT );
+}
+
+
+
+
+/**
+ * @brief turned in place, the first column becomes the first row, bottom up
+ */
+static void utc_image_util_rotate_in_place_p(void)
+{
+	unsigned char rgb[3 * 3 * 3];
+	image_util_planes_s planes = { { rgb }, { 3 * 3 } };
+	int i;
+
+	for( i = 0; i < sizeof(rgb); ++i )
+		rgb[i] = i / 3;
+	int ret = image_util_rotate_in_place( &planes, IMAGE_UTIL_ROTATION_90, 3, 3, IMAGE_UTIL_COLORSPACE_RGB888 );
+	if( ret == IMAGE_UTIL_ERROR_NONE && (rgb[0] != 6 || rgb[3] != 3 || rgb[6] != 0 || rgb[12] != 4) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	dts_check_eq( API_NAME_IMAGEUTIL_ROTATE_IN_PLACE, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief check if the crop view has the verification of the area
+ */
+static void utc_image_util_crop_view_n(void)
+{
+	unsigned char rgb[8 * 8 * 3] = { 0, };
+	unsigned char * buffer = NULL;
+	image_util_planes_s src = { { rgb }, { 8 * 3 } };
+	image_util_planes_s view;
+
+	int ret = image_util_crop_view( &view, 4, 4, 8, 2, &src, 8, 8, IMAGE_UTIL_COLORSPACE_RGB888, &buffer ); // outside of the source
+	dts_check_eq( API_NAME_IMAGEUTIL_CROP_VIEW, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief a crop area whose end overflows an int must be refused by the crop view
+ */
+static void utc_image_util_crop_view_2_n(void)
+{
+	unsigned char rgb[8 * 8 * 3] = { 0, };
+	unsigned char * buffer = NULL;
+	image_util_planes_s src = { { rgb }, { 8 * 3 } };
+	image_util_planes_s view;
+
+	int ret = image_util_crop_view( &view, 4, 4, INT_MAX, 2, &src, 8, 8, IMAGE_UTIL_COLORSPACE_RGB888, &buffer );
+	dts_check_eq( API_NAME_IMAGEUTIL_CROP_VIEW, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief the crop view points into the source and needs no copy
+ */
+static void utc_image_util_crop_view_p(void)
+{
+	unsigned char rgb[8 * 8 * 3] = { 0, };
+	unsigned char * buffer = NULL;
+	image_util_planes_s src = { { rgb }, { 8 * 3 } };
+	image_util_planes_s view;
+
+	int ret = image_util_crop_view( &view, 3, 2, 4, 4, &src, 8, 8, IMAGE_UTIL_COLORSPACE_RGB888, &buffer );
+	if( ret == IMAGE_UTIL_ERROR_NONE && (buffer != NULL || view.data[0] != rgb + 2 * 8 * 3 + 3 * 3 || view.stride[0] != 8 * 3) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	free( buffer );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_CROP_VIEW, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief check if creating an image has the verification of the size
+ */
+static void utc_image_util_image_create_n(void)
+{
+	image_util_image_h image = NULL;
+
+	int ret = image_util_image_create( 0, 240, IMAGE_UTIL_COLORSPACE_RGB888, &image );
+	dts_check_eq( API_NAME_IMAGEUTIL_IMAGE_CREATE, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief the image keeps its size and has planes for it
+ */
+static void utc_image_util_image_create_p(void)
+{
+	int width = 0, height = 0;
+	image_util_colorspace_e colorspace = IMAGE_UTIL_COLORSPACE_RGB888;
+	image_util_image_h image = NULL;
+	image_util_planes_s planes;
+
+	int ret = image_util_image_create( 320, 240, IMAGE_UTIL_COLORSPACE_I420, &image );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_image_get_info( image, &width, &height, &colorspace );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_image_get_planes( image, &planes );
+	if( ret == IMAGE_UTIL_ERROR_NONE && (width != 320 || height != 240 || colorspace != IMAGE_UTIL_COLORSPACE_I420 || planes.data[2] == NULL || planes.stride[1] < 160) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	if( image )
+		image_util_image_unref( image );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_IMAGE_CREATE, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief check if setting the allocator needs all of its functions
+ */
+static void utc_image_util_set_allocator_n(void)
+{
+	int counts[2] = { 0, 0 };
+	image_util_allocator_s allocator = { counting_alloc, NULL, counting_aligned_alloc, counts };
+
+	int ret = image_util_set_allocator( &allocator );
+	dts_check_eq( API_NAME_IMAGEUTIL_SET_ALLOCATOR, ret, IMAGE_UTIL_ERROR_INVALID_PARAMETER );
+}
+
+
+
+
+/**
+ * @brief an image comes from the allocator and goes back to it
+ */
+static void utc_image_util_set_allocator_p(void)
+{
+	int counts[2] = { 0, 0 };
+	image_util_allocator_s allocator = { counting_alloc, counting_free, counting_aligned_alloc, counts };
+	image_util_image_h image = NULL;
+
+	int ret = image_util_set_allocator( &allocator );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_image_create( 320, 240, IMAGE_UTIL_COLORSPACE_RGBA8888, &image );
+	if( image )
+		image_util_image_unref( image );
+	if( image_util_set_allocator( NULL ) != IMAGE_UTIL_ERROR_NONE && ret == IMAGE_UTIL_ERROR_NONE )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	if( ret == IMAGE_UTIL_ERROR_NONE && (counts[0] == 0 || counts[0] != counts[1]) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	dts_check_eq( API_NAME_IMAGEUTIL_SET_ALLOCATOR, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief a decoded image larger than 2 MB starts on a huge page when they are on,
+ *        a small one still starts on a cache line
+ */
+static void utc_image_util_set_hugepages_p(void)
+{
+	int width = 0, height = 0;
+	unsigned int size = 0;
+	unsigned char * small = NULL;
+	unsigned char * large = NULL;
+	image_util_decode_h handle = NULL;
+	const unsigned long hugepage_size = 2 * 1024 * 1024;
+
+	image_util_decode_create( &handle );
+	image_util_decode_set_input_path( handle, SAMPLE_FILENAME );
+	image_util_decode_set_colorspace( handle, IMAGE_UTIL_COLORSPACE_RGB888 );
+	int ret = image_util_set_hugepages( true );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = image_util_decode_run( handle, &small, &width, &height, &size );
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		image_util_decode_set_resolution( handle, 1920, 1080 ); // 6 MB of RGB888
+		ret = image_util_decode_run( handle, &large, &width, &height, &size );
+	}
+	image_util_set_hugepages( false );
+	image_util_decode_destroy( handle );
+
+	if( ret == IMAGE_UTIL_ERROR_NONE && (((unsigned long)small & 63) || ((unsigned long)large & (hugepage_size - 1)) || width != 1920 || height != 1080) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	free( small );
+	free( large );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_SET_HUGEPAGES, ret, IMAGE_UTIL_ERROR_NONE );
+}
+
+
+
+
+/**
+ * @brief the legacy decoding calls hand out images starting on a cache line
+ */
+static void utc_image_util_decode_jpeg_aligned_p(void)
+{
+	int width = 0, height = 0;
+	unsigned int size = 0;
+	long jpeg_size = 0;
+	unsigned char * jpeg = NULL;
+	unsigned char * from_file = NULL;
+	unsigned char * from_memory = NULL;
+	FILE * fp = fopen( SAMPLE_FILENAME, "rb" );
+
+	if( fp && fseek( fp, 0, SEEK_END ) == 0 && (jpeg_size = ftell( fp )) > 0 && fseek( fp, 0, SEEK_SET ) == 0 ){
+		jpeg = malloc( jpeg_size );
+		if( jpeg && fread( jpeg, 1, jpeg_size, fp ) != (size_t)jpeg_size ){
+			free( jpeg );
+			jpeg = NULL;
+		}
+	}
+	if( fp )
+		fclose( fp );
+
+	int ret = image_util_decode_jpeg( SAMPLE_FILENAME, IMAGE_UTIL_COLORSPACE_RGB888, &from_file, &width, &height, &size );
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = jpeg ? image_util_decode_jpeg_from_memory( jpeg, jpeg_size, IMAGE_UTIL_COLORSPACE_RGB888, &from_memory, &width, &height, &size ) : IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+	if( ret == IMAGE_UTIL_ERROR_NONE && ((((uintptr_t)from_file & 63) != 0) || (((uintptr_t)from_memory & 63) != 0)) )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	free( jpeg );
+	free( from_file );
+	free( from_memory );
+
+	dts_check_eq( API_NAME_IMAGEUTIL_DECODE_JPEG, ret, IMAGE_UTIL_ERROR_NONE );
+}
@@ -21,6 +21,7 @@
 #define __TIZEN_MEDIA_IMAGE_UTIL_H__
 
 #include <tizen.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -47,7 +48,8 @@ typedef enum
     IMAGE_UTIL_ERROR_OUT_OF_MEMORY =     TIZEN_ERROR_OUT_OF_MEMORY,      			/**< Out of memory */
     IMAGE_UTIL_ERROR_NO_SUCH_FILE  = TIZEN_ERROR_NO_SUCH_FILE, 							/**< No such file */
     IMAGE_UTIL_ERROR_INVALID_OPERATION = TIZEN_ERROR_INVALID_OPERATION,  		/**< Internal error */
-    IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT = TIZEN_ERROR_NOT_SUPPORT_API /**< Not supported format */
+    IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT = TIZEN_ERROR_NOT_SUPPORT_API, /**< Not supported format */
+    IMAGE_UTIL_ERROR_CANCELED = IMAGE_UTIL_ERROR_CLASS | 0x01 /**< The request was canceled */
 } image_util_error_e;
 
 
@@ -90,6 +92,165 @@ typedef enum
     IMAGE_UTIL_ROTATION_FLIP_VERT,       /**< Flip vertical */
 } image_util_rotation_e;
 
+/**
+ * @brief Enumerations of the filter an image is resampled with
+ *
+ * @see image_util_resize_with_filter()
+ */
+typedef enum
+{
+	IMAGE_UTIL_RESIZE_FILTER_NEAREST, 		/**< Nearest pixel, the fastest, for previews */
+	IMAGE_UTIL_RESIZE_FILTER_BILINEAR, 		/**< Linear interpolation, widened when downscaling (Default of image_util_resize_ex()) */
+	IMAGE_UTIL_RESIZE_FILTER_BICUBIC, 		/**< Cubic convolution, sharper than bilinear */
+	IMAGE_UTIL_RESIZE_FILTER_LANCZOS, 		/**< Lanczos with 3 lobes, the sharpest and slowest, for final thumbnails */
+	IMAGE_UTIL_RESIZE_FILTER_AREA, 			/**< Average of the covered source pixels, for large downscales */
+} image_util_resize_filter_e;
+
+/**
+ * @brief Enumerations of the scale a JPEG image is decoded at
+ */
+typedef enum
+{
+	IMAGE_UTIL_DOWNSCALE_1_1, 		/**< 1/1 downscale */
+	IMAGE_UTIL_DOWNSCALE_1_2, 		/**< 1/2 downscale */
+	IMAGE_UTIL_DOWNSCALE_1_4, 		/**< 1/4 downscale */
+	IMAGE_UTIL_DOWNSCALE_1_8, 		/**< 1/8 downscale */
+} image_util_scale_e;
+
+/**
+ * @brief Enumerations of the way a JPEG file is read for decoding
+ */
+typedef enum
+{
+	IMAGE_UTIL_FILE_ACCESS_MAP, 			/**< Mapped into memory and read ahead sequentially (Default) */
+	IMAGE_UTIL_FILE_ACCESS_MAP_POPULATE, 	/**< Mapped into memory and read in whole before decoding */
+	IMAGE_UTIL_FILE_ACCESS_READ, 			/**< Read through a buffer */
+} image_util_file_access_e;
+
+/**
+ * @brief Enumerations of the chroma subsampling of a JPEG image
+ */
+typedef enum
+{
+	IMAGE_UTIL_JPEG_SUBSAMPLING_444, 		/**< No chroma subsampling */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_422, 		/**< Half horizontal chroma resolution */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_420, 		/**< Half horizontal and vertical chroma resolution */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_440, 		/**< Half vertical chroma resolution */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_411, 		/**< Quarter horizontal chroma resolution */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_GRAY, 		/**< No chroma */
+	IMAGE_UTIL_JPEG_SUBSAMPLING_UNKNOWN, 	/**< Any other sampling */
+} image_util_jpeg_subsampling_e;
+
+/**
+ * @brief Properties of a JPEG image read from its header
+ *
+ * @see image_util_get_jpeg_info()
+ */
+typedef struct
+{
+	int width;										/**< The image width */
+	int height;										/**< The image height */
+	int components;									/**< The number of color components */
+	image_util_jpeg_subsampling_e subsampling;	/**< The chroma subsampling */
+	bool progressive;								/**< Whether the image is progressive */
+	int restart_interval;							/**< The MCUs between restart markers, 0 without restart markers */
+	int orientation;								/**< The EXIF orientation (1 ~ 8), 1 without EXIF data */
+} image_util_jpeg_info_s;
+
+/**
+ * @brief A JPEG image to decode with image_util_decode_jpeg_batch()
+ *
+ * @remarks Either @a path or @a buffer is set. With @a width and @a height of 0 the image is decoded at its size.
+ */
+typedef struct
+{
+	const char *path;						/**< The jpeg file path, or NULL */
+	const unsigned char *buffer;			/**< The jpeg image buffer, or NULL */
+	unsigned int size;						/**< The jpeg image buffer size */
+	image_util_colorspace_e colorspace;	/**< The colorspace to decode into */
+	int width;								/**< The width to decode at, or 0 */
+	int height;								/**< The height to decode at, or 0 */
+} image_util_decode_item_s;
+
+#define IMAGE_UTIL_MAX_PLANES	3	/**< Maximum number of planes of an image */
+
+/**
+ * @brief Plane pointers and row strides of an image
+ *
+ * @remarks The planes are in the order of the colorspace name: Y, V, U for #IMAGE_UTIL_COLORSPACE_YV12,\n
+ * Y, U, V for #IMAGE_UTIL_COLORSPACE_I420 and #IMAGE_UTIL_COLORSPACE_YUV422, Y and interleaved UV for #IMAGE_UTIL_COLORSPACE_NV12.\n
+ * Packed colorspaces use the first plane only.
+ *
+ * @see image_util_get_plane_layout()
+ */
+typedef struct
+{
+	unsigned char *data[IMAGE_UTIL_MAX_PLANES];	/**< The first byte of each plane */
+	int stride[IMAGE_UTIL_MAX_PLANES];			/**< The distance between rows of each plane in bytes */
+} image_util_planes_s;
+
+/**
+ * @brief Layout of the planes of an image inside one buffer
+ *
+ * @see image_util_get_plane_layout()
+ */
+typedef struct
+{
+	int num_planes;									/**< The number of planes */
+	unsigned int offset[IMAGE_UTIL_MAX_PLANES];	/**< The offset of each plane from the start of the buffer in bytes */
+	int stride[IMAGE_UTIL_MAX_PLANES];			/**< The distance between rows of each plane in bytes */
+	int height[IMAGE_UTIL_MAX_PLANES];			/**< The number of rows of each plane */
+	unsigned int size;								/**< The size of the whole buffer in bytes */
+} image_util_plane_layout_s;
+
+/**
+ * @brief The handle of a transformation chain
+ *
+ * @see image_util_transform_create()
+ */
+typedef struct image_util_transform_s *image_util_transform_h;
+
+/**
+ * @brief The handle of a JPEG decoding
+ *
+ * @see image_util_decode_create()
+ */
+typedef struct image_util_decode_s *image_util_decode_h;
+
+/**
+ * @brief The handle of a JPEG encoding
+ *
+ * @see image_util_encode_create()
+ */
+typedef struct image_util_encode_s *image_util_encode_h;
+
+/**
+ * @brief The handle of an operation running in the background
+ *
+ * @see image_util_decode_run_async()
+ */
+typedef struct image_util_request_s *image_util_request_h;
+
+/**
+ * @brief The handle of a reference counted image
+ *
+ * @see image_util_image_create()
+ */
+typedef struct image_util_image_s *image_util_image_h;
+
+/**
+ * @brief The functions the library allocates its memory with
+ *
+ * @see image_util_set_allocator()
+ */
+typedef struct
+{
+	void *(*alloc)(size_t size, void *user_data);								/**< Allocates @a size bytes, NULL on failure */
+	void (*free)(void *data, void *user_data);									/**< Releases memory of alloc or aligned_alloc */
+	void *(*aligned_alloc)(size_t alignment, size_t size, void *user_data);	/**< Allocates @a size bytes at a multiple of @a alignment, a power of two */
+	void *user_data;															/**< The user data passed to the functions */
+} image_util_allocator_s;
+
 
 
 
@@ -110,9 +271,100 @@ typedef enum
  */
 typedef bool (*image_util_supported_jpeg_colorspace_cb)( image_util_colorspace_e colorspace , void * user_data);
 
+/**
+ * @brief	Called for each band of rows decoded by image_util_decode_push().
+ *
+ * @remarks The bands come in order from the top of the image. Every band but the last one has an even number of rows.\n
+ * @a rows is only valid in the callback.
+ *
+ * @param[in]	rows	The planes of the band, starting at its first row
+ * @param[in]	first_row	The index of the first row of the band in the image
+ * @param[in]	num_rows	The number of rows of the band
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	user_data	The user data passed from image_util_decode_start_stream()
+ *
+ * @pre		image_util_decode_push() will invoke this callback.
+ *
+ * @see	image_util_decode_start_stream()
+ */
+typedef void (*image_util_decode_rows_cb)(const image_util_planes_s *rows, int first_row, int num_rows, int width, int height, void *user_data);
+
+/**
+ * @brief	Called with the next part of the jpeg data encoded by image_util_encode_push_rows().
+ *
+ * @remarks The parts come in order, together they are the jpeg image.\n
+ * @a data is only valid in the callback.
+ *
+ * @param[in]	data	The next part of the jpeg data
+ * @param[in]	size	The size of @a data
+ * @param[in]	user_data	The user data passed from image_util_encode_start_stream()
+ * @return	@c true to continue encoding, \n @c false to stop it, for example when the data can not be written
+ *
+ * @pre		image_util_encode_start_stream() and image_util_encode_push_rows() will invoke this callback.
+ *
+ * @see	image_util_encode_start_stream()
+ */
+typedef bool (*image_util_encode_output_cb)(const unsigned char *data, unsigned int size, void *user_data);
+
+/**
+ * @brief	Called to read the next part of the jpeg data set with image_util_decode_set_input_callback().
+ *
+ * @remarks The callback may return fewer bytes than @a size, it is called again for the rest.
+ *
+ * @param[out]	buffer	The buffer to read into
+ * @param[in]	size	The size of @a buffer
+ * @param[in]	user_data	The user data passed from image_util_decode_set_input_callback()
+ * @return	The number of bytes read into @a buffer, \n @c 0 at the end of the data, \n a negative value on a read error
+ *
+ * @pre		image_util_decode_run() and the other decoding functions will invoke this callback.
+ *
+ * @see	image_util_decode_set_input_callback()
+ */
+typedef int (*image_util_decode_read_cb)(unsigned char *buffer, unsigned int size, void *user_data);
+
+/**
+ * @brief	Called when an image of image_util_decode_jpeg_batch() is decoded.
+ *
+ * @remarks The callback is invoked from the threads of the batch, for several images at the same time.\n
+ * @a image_buffer must be released with free() by the callback, or with the free function of image_util_set_allocator() when one is set. It is NULL when @a error is not #IMAGE_UTIL_ERROR_NONE.
+ *
+ * @param[in]	index	The index of the image in the batch
+ * @param[in]	error	#IMAGE_UTIL_ERROR_NONE, or the error the image failed with
+ * @param[in]	image_buffer	The decoded image
+ * @param[in]	width	The width of the decoded image
+ * @param[in]	height	The height of the decoded image
+ * @param[in]	size	The size of @a image_buffer
+ * @param[in]	user_data	The user data passed from image_util_decode_jpeg_batch()
+ *
+ * @pre		image_util_decode_jpeg_batch() will invoke this callback.
+ *
+ * @see	image_util_decode_jpeg_batch()
+ */
+typedef void (*image_util_decode_batch_cb)(int index, int error, unsigned char *image_buffer, int width, int height, unsigned int size, void *user_data);
+
+/**
+ * @brief	Called when an operation started in the background is finished.
+ *
+ * @remarks The callback is invoked from a thread of the library. @a request stays valid in the callback,
+ * even when image_util_request_destroy() is called from it.
+ *
+ * @param[in]	request	The request of the operation
+ * @param[in]	error	#IMAGE_UTIL_ERROR_NONE, #IMAGE_UTIL_ERROR_CANCELED, or the error the operation failed with
+ * @param[in]	user_data	The user data passed with the operation
+ *
+ * @see	image_util_request_get_result()
+ */
+typedef void (*image_util_completed_cb)(image_util_request_h request, int error, void *user_data);
+
 /**
  * @brief Retrieves all supported JPEG encoding/decoding colorspace by invoking a callback function once for each one.
  *
+ * @remarks These are the colorspaces both decoding and encoding support. image_util_encode_jpeg() and\n
+ * image_util_encode_jpeg_to_memory() also encode from #IMAGE_UTIL_COLORSPACE_I420, #IMAGE_UTIL_COLORSPACE_NV12,\n
+ * #IMAGE_UTIL_COLORSPACE_UYVY, #IMAGE_UTIL_COLORSPACE_YUYV, #IMAGE_UTIL_COLORSPACE_RGB565 and the 32 bit RGB colorspaces,\n
+ * which are not reported here.
+ *
  * @param[in] 	callback    The callback function to invoke
  * @param[in] 	user_data	The user data to be passed to the callback function
  * @return	  0 on success, otherwise a negative error value.
@@ -195,7 +447,16 @@ int image_util_resize(unsigned char * dest, int *dest_width , int *dest_height,
  * #IMAGE_UTIL_COLORSPACE_YV12 \n
  * #IMAGE_UTIL_COLORSPACE_I420 \n
  * #IMAGE_UTIL_COLORSPACE_NV12 \n
+ * #IMAGE_UTIL_COLORSPACE_RGB565 \n
  * #IMAGE_UTIL_COLORSPACE_RGB888 \n
+ * #IMAGE_UTIL_COLORSPACE_ARGB8888\n
+ * #IMAGE_UTIL_COLORSPACE_BGRA8888\n
+ * #IMAGE_UTIL_COLORSPACE_RGBA8888\n
+ * #IMAGE_UTIL_COLORSPACE_BGRX8888\n
+ *  #IMAGE_UTIL_COLORSPACE_YUV422 is rotated by the library by 180 degrees and flipped, but 90 and 270 degrees are
+ *  left to the platform image processing, as are all rotations of #IMAGE_UTIL_COLORSPACE_UYVY and #IMAGE_UTIL_COLORSPACE_YUYV.
+ *  Their chroma is subsampled only horizontally and would have to be resampled to turn by a quarter.
+ *  The platform image processing can not use @a dest equal to @a src.\n
  *
  * @param[in/out]	dest	The image buffer for result. Must be allocated by you
  * @param[out]	dest_width The rotated image width
@@ -210,8 +471,10 @@ int image_util_resize(unsigned char * dest, int *dest_width , int *dest_height,
  * @retval    #IMAGE_UTIL_ERROR_NONE Successful
  * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
  * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format, when @a dest is @a src
  *
  * @see image_util_calculate_buffer_size()
+ * @see image_util_rotate_in_place()
  */
 int image_util_rotate(unsigned char * dest, int *dest_width, int *dest_height, image_util_rotation_e dest_rotation, const unsigned char * src, int src_width, int src_height, image_util_colorspace_e colorspace);
 
@@ -248,13 +511,212 @@ int image_util_rotate(unsigned char * dest, int *dest_width, int *dest_height, i
  */
 int image_util_crop(unsigned char * dest, int x , int y, int* width, int *height, const unsigned char *src, int src_width, int src_height, image_util_colorspace_e colorspace);
 
+/**
+ * @brief Gets the plane offsets and strides of an image buffer with rows aligned to the specified alignment
+ *
+ * @remarks Each plane starts and each row is padded to a multiple of @a alignment bytes.\n
+ * With an alignment of 1 the layout is the one used by image_util_convert_colorspace() and the other functions taking a single buffer.
+ *
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	colorspace	The image colorspace
+ * @param[in]	alignment	The row alignment in bytes, a power of two
+ * @param[out]	layout	The layout of the planes
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_calculate_buffer_size()
+ */
+int image_util_get_plane_layout(int width, int height, image_util_colorspace_e colorspace, int alignment, image_util_plane_layout_s *layout);
+
+/**
+ * @brief Convert the image's colorspace, with separate plane pointers and strides
+ *
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	dest_colorspace	The colorspace to be converted
+ * @param[in]	src	The planes of source image
+ * @param[in]	width	The width of source image
+ * @param[in]	height	The height of source image
+ * @param[in]	src_colorspace	The colorspace of source image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_convert_colorspace()
+ * @see image_util_get_plane_layout()
+ */
+int image_util_convert_colorspace_ex(image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, int width, int height, image_util_colorspace_e src_colorspace);
+
+/**
+ * @brief Resize the image to the specified width and height, with separate plane pointers and strides
+ *
+ * @remarks #IMAGE_UTIL_COLORSPACE_RGB565, #IMAGE_UTIL_COLORSPACE_UYVY and #IMAGE_UTIL_COLORSPACE_YUYV are not supported.\n
+ * Subsampled colorspaces need even source and destination sizes.
+ *
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	dest_width	The width of the resized image
+ * @param[in]	dest_height	The height of the resized image
+ * @param[in]	src	The planes of origin image
+ * @param[in]	src_width	The origin image width
+ * @param[in]	src_height	The origin image height
+ * @param[in]	colorspace	The image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_resize()
+ * @see image_util_resize_with_filter()
+ * @see image_util_get_plane_layout()
+ */
+int image_util_resize_ex(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Resize the image to the specified width and height with a chosen filter, with separate plane pointers and strides
+ *
+ * @remarks image_util_resize_ex() is the same as #IMAGE_UTIL_RESIZE_FILTER_BILINEAR.\n
+ * The colorspaces and sizes supported are the ones of image_util_resize_ex().
+ *
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	dest_width	The width of the resized image
+ * @param[in]	dest_height	The height of the resized image
+ * @param[in]	src	The planes of origin image
+ * @param[in]	src_width	The origin image width
+ * @param[in]	src_height	The origin image height
+ * @param[in]	colorspace	The image colorspace
+ * @param[in]	filter	The filter to resample with
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_resize_ex()
+ */
+int image_util_resize_with_filter(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_resize_filter_e filter);
+
+/**
+ * @brief Rotate the image, with separate plane pointers and strides
+ *
+ * @remarks The rotated image is @a src_height x @a src_width for #IMAGE_UTIL_ROTATION_90 and #IMAGE_UTIL_ROTATION_270,\n
+ * otherwise @a src_width x @a src_height.\n
+ * #IMAGE_UTIL_COLORSPACE_UYVY and #IMAGE_UTIL_COLORSPACE_YUYV are not supported, #IMAGE_UTIL_COLORSPACE_YUV422 only\n
+ * for #IMAGE_UTIL_ROTATION_180 and the flips. Subsampled colorspaces need even sizes.\n
+ * @a dest may be the planes of @a src, the image is then rotated as by image_util_rotate_in_place().
+ *
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	dest_rotation	The angle to rotate
+ * @param[in]	src	The planes of origin image
+ * @param[in]	src_width	The origin image width
+ * @param[in]	src_height	The origin image height
+ * @param[in]	colorspace	The image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_rotate()
+ * @see image_util_rotate_in_place()
+ * @see image_util_get_plane_layout()
+ */
+int image_util_rotate_ex(image_util_planes_s *dest, image_util_rotation_e dest_rotation, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Rotate the image within its own planes, without a buffer for the result
+ *
+ * @remarks #IMAGE_UTIL_ROTATION_180 and the flips work for every size, #IMAGE_UTIL_ROTATION_90 and\n
+ * #IMAGE_UTIL_ROTATION_270 only for square images. The colorspaces are those of image_util_rotate_ex().\n
+ * Each row is read and written once, about half of the memory traffic of a rotation into another buffer.
+ *
+ * @param[in]	planes	The planes of the image, rotated in place
+ * @param[in]	rotation	The angle to rotate
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	colorspace	The image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format or size
+ *
+ * @see image_util_rotate_ex()
+ */
+int image_util_rotate_in_place(image_util_planes_s *planes, image_util_rotation_e rotation, int width, int height, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Crop the image to the specified point and dimension, with separate plane pointers and strides
+ *
+ * @remarks @a x and @a y must be even where the colorspace shares chroma between neighbouring pixels or rows.
+ *
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	x The starting x-axis of crop
+ * @param[in]	y The starting y-axis of crop
+ * @param[in]	width  The image width to crop
+ * @param[in]	height  The image height to crop
+ * @param[in]	src	The planes of origin image
+ * @param[in]	src_width	The origin image width
+ * @param[in]	src_height	The origin image height
+ * @param[in]	colorspace	The image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_crop()
+ * @see image_util_crop_view()
+ * @see image_util_get_plane_layout()
+ */
+int image_util_crop_ex(image_util_planes_s *dest, int x, int y, int width, int height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Gets the planes of an area of the image, pointing into the planes of the image
+ *
+ * @remarks Nothing is copied when the area starts on a whole chroma sample, @a view then points into @a src\n
+ * with the strides of @a src and is valid as long as @a src, and @a buffer is set to NULL.\n
+ * When @a x or @a y splits a chroma sample, the area is copied with its chroma interpolated half a sample\n
+ * over, @a view points into the copy and @a buffer is set to it. It should be released by free(), or by the free function of image_util_set_allocator() when one is set.\n
+ * The planes and the rows of the copy start at multiples of 64 bytes.\n
+ * The view can be passed as the source of every function that takes planes, such as image_util_resize_ex(),\n
+ * image_util_convert_colorspace_ex() or image_util_encode_run().
+ *
+ * @param[out]	view	The planes of the area
+ * @param[in]	x The starting x-axis of crop
+ * @param[in]	y The starting y-axis of crop
+ * @param[in]	width  The image width to crop
+ * @param[in]	height  The image height to crop
+ * @param[in]	src	The planes of origin image
+ * @param[in]	src_width	The origin image width
+ * @param[in]	src_height	The origin image height
+ * @param[in]	colorspace	The image colorspace
+ * @param[out]	buffer	The copy of the area, NULL when @a view points into @a src
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_crop_ex()
+ */
+int image_util_crop_view(image_util_planes_s *view, int x, int y, int width, int height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, unsigned char **buffer);
+
 
 
 
 /**
  * @brief Decodes jpeg image to the buffer
  *
- * @remarks @a image_buffer must be released with free() by you.
+ * @remarks @a image_buffer must be released with free() by you, or with the free function of image_util_set_allocator() when one is set.\n
+ * When the width and height suit @a colorspace, e.g. even ones for #IMAGE_UTIL_COLORSPACE_YV12, @a image_buffer starts at a multiple of 64 bytes.
+ * Its rows follow each other without padding, image_util_decode_run_to_image() gives aligned rows.
  *
  * @param[in]	path	The image file path
  * @param[in]	colorspace	The decoded image colorspace
@@ -279,7 +741,9 @@ int image_util_decode_jpeg( const char *path , image_util_colorspace_e colorspac
 /**
  * @brief Decodes jpeg image(on memory) to the buffer
  *
- * @remarks @a image_buffer must be released with free() by you.
+ * @remarks @a image_buffer must be released with free() by you, or with the free function of image_util_set_allocator() when one is set.\n
+ * When the width and height suit @a colorspace, e.g. even ones for #IMAGE_UTIL_COLORSPACE_YV12, @a image_buffer starts at a multiple of 64 bytes.
+ * Its rows follow each other without padding, image_util_decode_run_to_image() gives aligned rows.
  *
  * @param[in]	jpeg_buffer	The jpeg image buffer
  * @param[in]	jpeg_size		The jpeg image buffer size
@@ -303,53 +767,1186 @@ int image_util_decode_jpeg( const char *path , image_util_colorspace_e colorspac
 int image_util_decode_jpeg_from_memory( const unsigned char * jpeg_buffer , int jpeg_size , image_util_colorspace_e colorspace, unsigned char ** image_buffer , int *width , int *height , unsigned int *size);
 
 /**
- * @brief Encodes image to the jpeg image
+ * @brief Decodes a preview of a jpeg image, for thumbnails and grid views
  *
- * @param[in]	buffer	The origin image buffer
- * @param[in]	width	The origin image width
- * @param[in]	height	The origin image height
- * @param[in]	colorspace	The origin image colorspace
- * @param[in]	quality The quality for JPEG image encoding (1 ~ 100)
- * @param[in]	path	The file path to be created
+ * @remarks The thumbnail a camera stores in the EXIF data of the image is decoded when there is one of at least
+ * @a min_width x @a min_height, which is much faster than the image itself. Otherwise the image is decoded at the smallest
+ * scale of 1/8, 1/4 or 1/2 that is still at least @a min_width x @a min_height, or at full size.
+ * The sizes are in the orientation the image is stored in, and the EXIF orientation is not applied, see image_util_get_jpeg_info().\n
+ * The preview is not resized to the requested size, @a width and @a height are the ones of the decoded preview.\n
+ * @a image_buffer must be released with free() by you, or with the free function of image_util_set_allocator() when one is set.
+ *
+ * @param[in]	path	The image file path
+ * @param[in]	min_width	The smallest width the preview may have, 0 for any
+ * @param[in]	min_height	The smallest height the preview may have, 0 for any
+ * @param[in]	colorspace	The decoded image colorspace
+ * @param[out]	image_buffer	The image buffer for the decoded preview
+ * @param[out]	width	The preview width
+ * @param[out]	height	The preview height
+ * @param[out]	size	The image buffer size
  *
  * @return	  0 on success, otherwise a negative error value.
  * @retval    #IMAGE_UTIL_ERROR_NONE Successful
  * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
- * @retval	 #IMAGE_UTIL_ERROR_NO_SUCH_FILE no such file
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
  * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
- * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation 
+ * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation
  *
- * @see image_util_supported_jpeg_colorspace_cb()
- * @see image_util_foreach_supported_jpeg_colorspace() 
- * @see image_util_encode_jpeg_to_memory()
+ * @see	image_util_decode_jpeg()
+ * @see	image_util_decode_set_jpeg_downscale()
  */
-int image_util_encode_jpeg( const unsigned char *buffer, int width, int height, image_util_colorspace_e colorspace,  int quality, const char *path);
+int image_util_decode_jpeg_thumbnail(const char *path, int min_width, int min_height, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *size);
 
 /**
- * @brief Encodes image to the jpeg image
+ * @brief Gets the properties of a jpeg file from its header
  *
- * @remarks @a jpeg_buffer must be released with free() by you.
- * 
- * @param[in]	image_buffer	The origin image buffer
- * @param[in]	width	The image width
- * @param[in]	height	The image height
- * @param[in]	colorspace	The origin image colorspace
- * @param[in]	quality The quality for JPEG image encoding (1 ~ 100)
- * @param[out]	jpeg_buffer	The created jpeg image buffer.  The buffer is created by frameworks
- * @param[out]	jpeg_size		The created jpeg image buffer size
+ * @remarks Only the markers before the image data are read, the image is not decoded.
+ *
+ * @param[in]	path	The jpeg file path
+ * @param[out]	info	The properties of the image
  *
  * @return	  0 on success, otherwise a negative error value.
  * @retval    #IMAGE_UTIL_ERROR_NONE Successful
  * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
  * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
- * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
- * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation 
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The file is not a jpeg image
  *
- * @see image_util_supported_jpeg_colorspace_cb()
- * @see image_util_foreach_supported_jpeg_colorspace()
- * @see image_util_encode_jpeg()
+ * @see image_util_get_jpeg_info_from_memory()
  */
-int image_util_encode_jpeg_to_memory(const unsigned char *image_buffer, int width, int height, image_util_colorspace_e colorspace, int quality,  unsigned char** jpeg_buffer, unsigned int *jpeg_size);
+int image_util_get_jpeg_info(const char *path, image_util_jpeg_info_s *info);
+
+/**
+ * @brief Gets the properties of a jpeg image in memory from its header
+ *
+ * @remarks Only the markers before the image data are read, the image is not decoded.
+ *
+ * @param[in]	jpeg_buffer	The jpeg image buffer
+ * @param[in]	jpeg_size	The jpeg image buffer size
+ * @param[out]	info	The properties of the image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The buffer is not a jpeg image
+ *
+ * @see image_util_get_jpeg_info()
+ */
+int image_util_get_jpeg_info_from_memory(const unsigned char *jpeg_buffer, unsigned int jpeg_size, image_util_jpeg_info_s *info);
+
+/**
+ * @brief Decodes a number of jpeg images in parallel
+ *
+ * @remarks The images are decoded on the threads set with image_util_set_num_threads(), one image on each thread at a time.
+ * A thread takes the next image as soon as it is done with one, so a few large images do not hold the others up.\n
+ * The threads serve one operation of the process at a time. While a batch runs, the operations other threads start,
+ * such as image_util_convert_colorspace(), image_util_resize(), image_util_rotate() or another batch, run on their calling thread alone.
+ * A batch started while another operation runs on the threads decodes its images one after the other on the calling thread.\n
+ * The function returns when all images are decoded. The result of each image is given to @a callback.
+ *
+ * @param[in]	items	The images to decode
+ * @param[in]	num_items	The number of images
+ * @param[in]	callback	The callback function to invoke with each decoded image
+ * @param[in]	user_data	The user data to be passed to the callback function
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful, the results of the images are given to @a callback
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @post	This function invokes image_util_decode_batch_cb() once for each image.
+ * @see image_util_set_num_threads()
+ */
+int image_util_decode_jpeg_batch(const image_util_decode_item_s *items, int num_items, image_util_decode_batch_cb callback, void *user_data);
+
+/**
+ * @brief Creates a JPEG decoding handle
+ *
+ * @remarks The image is decoded into #IMAGE_UTIL_COLORSPACE_RGB888 at its full size unless set otherwise.\n
+ * @a handle must be released with image_util_decode_destroy().
+ *
+ * @param[out]	handle	The decoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_decode_destroy()
+ * @see image_util_decode_run()
+ */
+int image_util_decode_create(image_util_decode_h *handle);
+
+/**
+ * @brief Sets the path of the jpeg file to decode
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	path	The jpeg file path
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_decode_set_input_buffer()
+ */
+int image_util_decode_set_input_path(image_util_decode_h handle, const char *path);
+
+/**
+ * @brief Sets the way the jpeg file set with image_util_decode_set_input_path() is read
+ *
+ * @remarks A mapped file is decoded from the page cache without being copied, and the pages are shared by all processes decoding it.\n
+ * A file that can not be mapped, like a pipe, is read through a buffer whatever is set.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	access	The way the file is read
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_set_input_path()
+ */
+int image_util_decode_set_file_access(image_util_decode_h handle, image_util_file_access_e access);
+
+/**
+ * @brief Sets the jpeg image on memory to decode
+ *
+ * @remarks @a jpeg_buffer is not copied and must stay valid until the decoding is done.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	jpeg_buffer	The jpeg image buffer
+ * @param[in]	jpeg_size	The jpeg image buffer size
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_set_input_path()
+ */
+int image_util_decode_set_input_buffer(image_util_decode_h handle, const unsigned char *jpeg_buffer, unsigned int jpeg_size);
+
+/**
+ * @brief Sets a callback to read the jpeg data to decode from
+ *
+ * @remarks The data is read in small parts while it is decoded, it is never held in memory as a whole.\n
+ * The data can be read once only, so the input is used by the next decoding and must be set again for another one.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	callback	The callback function to read the data with
+ * @param[in]	user_data	The user data to be passed to the callback function
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @post	The decoding functions invoke image_util_decode_read_cb() repeatedly.
+ * @see image_util_decode_set_input_fd()
+ */
+int image_util_decode_set_input_callback(image_util_decode_h handle, image_util_decode_read_cb callback, void *user_data);
+
+/**
+ * @brief Sets a file descriptor to read the jpeg data to decode from
+ *
+ * @remarks The data is read from the current position of @a fd, which can be a pipe or a socket.\n
+ * @a fd is not closed, and must stay open until the decoding is done.\n
+ * The data can be read once only, so the input is used by the next decoding and must be set again for another one.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	fd	The file descriptor
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_set_input_callback()
+ */
+int image_util_decode_set_input_fd(image_util_decode_h handle, int fd);
+
+/**
+ * @brief Sets the colorspace of the decoded image
+ *
+ * @remarks Unlike image_util_decode_jpeg(), every colorspace is supported.\n
+ * For colorspaces with subsampled chroma an odd last column or row of the decoded image is dropped.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	colorspace	The decoded image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_decode_set_colorspace(image_util_decode_h handle, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Sets the area of the image to decode
+ *
+ * @remarks The area is given in pixels of the full size image. Only the parts of the jpeg image covering it are decoded,\n
+ * so the time and memory of the decoding follow the size of the area rather than the size of the image.\n
+ * The area is scaled together with the image by image_util_decode_set_jpeg_downscale(),\n
+ * and image_util_decode_set_resolution() gives the size the area is decoded to.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	x The starting x-axis of the area
+ * @param[in]	y The starting y-axis of the area
+ * @param[in]	width  The width of the area
+ * @param[in]	height  The height of the area
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_run()
+ */
+int image_util_decode_set_crop_area(image_util_decode_h handle, int x, int y, int width, int height);
+
+/**
+ * @brief Sets the scale the image is decoded at
+ *
+ * @remarks The image is scaled while it is decoded, which is much faster than decoding it at its full size\n
+ * and resizing it. The decoded width and height are the image size divided by the scale, rounded up.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	downscale	The scale
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_set_resolution()
+ */
+int image_util_decode_set_jpeg_downscale(image_util_decode_h handle, image_util_scale_e downscale);
+
+/**
+ * @brief Sets the size of the decoded image
+ *
+ * @remarks The image, or the area set by image_util_decode_set_crop_area(), is decoded at the smallest scale\n
+ * which is not smaller than @a width x @a height and resized to exactly @a width x @a height. The scale of image_util_decode_set_jpeg_downscale() is not used then.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	width	The width of the decoded image
+ * @param[in]	height	The height of the decoded image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_set_jpeg_downscale()
+ */
+int image_util_decode_set_resolution(image_util_decode_h handle, int width, int height);
+
+/**
+ * @brief Decodes the jpeg image to the buffer
+ *
+ * @remarks @a image_buffer must be released with free() by you, or with the free function of image_util_set_allocator() when one is set.\n
+ * @a image_buffer starts at a multiple of 64 bytes. Its rows follow each other without padding, image_util_decode_run_to_image() gives aligned rows.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[out]	image_buffer	The image buffer for decoded image. The buffer is created by frameworks
+ * @param[out]	width	The image width
+ * @param[out]	height	The image height
+ * @param[out]	size	The image buffer size
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_decode_create()
+ * @see image_util_decode_set_crop_area()
+ */
+int image_util_decode_run(image_util_decode_h handle, unsigned char **image_buffer, int *width, int *height, unsigned int *size);
+
+/**
+ * @brief Gets the size of the image image_util_decode_run() would decode
+ *
+ * @remarks Only the header of the jpeg image is read. The crop area, the scale and the resolution of the handle are applied.\n
+ * An input set with image_util_decode_set_input_callback() or image_util_decode_set_input_fd() can not be read twice, so it is not probed.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[out]	width	The width of the decoded image
+ * @param[out]	height	The height of the decoded image
+ * @param[out]	size	The size of the decoded image in a packed buffer
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation, or the input is a callback or a file descriptor
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_decode_run_to_buffer()
+ * @see image_util_decode_run_ex()
+ */
+int image_util_decode_get_dest_resolution(image_util_decode_h handle, int *width, int *height, unsigned int *size);
+
+/**
+ * @brief Decodes the jpeg image into a buffer of the caller
+ *
+ * @remarks The image is packed as by image_util_calculate_buffer_size().
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	buffer	The buffer for the decoded image
+ * @param[in]	capacity	The size of @a buffer
+ * @param[out]	width	The image width
+ * @param[out]	height	The image height
+ * @param[out]	size	The size of the decoded image in @a buffer
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or @a capacity is too small
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_decode_get_dest_resolution()
+ */
+int image_util_decode_run_to_buffer(image_util_decode_h handle, unsigned char *buffer, unsigned int capacity, int *width, int *height, unsigned int *size);
+
+/**
+ * @brief Decodes the jpeg image into planes of the caller
+ *
+ * @remarks The planes must hold an image of the size given by image_util_decode_get_dest_resolution(),\n
+ * their strides may be larger than the rows, see image_util_get_plane_layout().
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	dest	The planes for the decoded image
+ * @param[out]	width	The image width
+ * @param[out]	height	The image height
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or a plane is missing or too narrow
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_decode_get_dest_resolution()
+ */
+int image_util_decode_run_ex(image_util_decode_h handle, image_util_planes_s *dest, int *width, int *height);
+
+/**
+ * @brief Decodes the jpeg image into a new image
+ *
+ * @remarks The image comes from the pool of image_util_image_create(), and should be released by image_util_image_unref().\n
+ * Its size is read from the header first, so the input can not be a callback or a file descriptor.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[out]	image	The decoded image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NO_SUCH_FILE No such file
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation, or the input is a callback or a file descriptor
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_decode_run_ex()
+ * @see image_util_image_get_planes()
+ */
+int image_util_decode_run_to_image(image_util_decode_h handle, image_util_image_h *image);
+
+/**
+ * @brief Starts decoding a jpeg image whose data is pushed in parts
+ *
+ * @remarks The colorspace and the scale of the handle are used, a crop area or a resolution can not be set.\n
+ * The decoded rows are handed to @a callback in bands of a few rows as soon as the data for them has been pushed,\n
+ * so neither the jpeg data nor the decoded image is kept in memory as a whole.\n
+ * A progressive jpeg image is decoded once all of its data has been pushed.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	callback	The callback function to invoke for each band of rows
+ * @param[in]	user_data	The user data to be passed to the callback function
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A crop area or a resolution is set
+ *
+ * @post	image_util_decode_push() decodes the data and invokes image_util_decode_rows_cb().
+ * @see image_util_decode_push()
+ * @see image_util_decode_finish_stream()
+ */
+int image_util_decode_start_stream(image_util_decode_h handle, image_util_decode_rows_cb callback, void *user_data);
+
+/**
+ * @brief Pushes the next part of the jpeg data
+ *
+ * @remarks The rows completed by @a data are handed to the callback before the function returns.\n
+ * @a data is not needed after the function returns.
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	data	The next part of the jpeg data
+ * @param[in]	size	The size of @a data
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The data is not a valid jpeg image, or no stream is started
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @pre	image_util_decode_start_stream()
+ * @see image_util_decode_finish_stream()
+ */
+int image_util_decode_push(image_util_decode_h handle, const unsigned char *data, unsigned int size);
+
+/**
+ * @brief Ends decoding a jpeg image whose data is pushed in parts
+ *
+ * @param[in]	handle	The decoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful, all rows of the image were decoded
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The image is not complete, or no stream is started
+ *
+ * @pre	image_util_decode_start_stream()
+ * @see image_util_decode_push()
+ */
+int image_util_decode_finish_stream(image_util_decode_h handle);
+
+/**
+ * @brief Destroys a JPEG decoding handle
+ *
+ * @param[in]	handle	The decoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_decode_create()
+ */
+int image_util_decode_destroy(image_util_decode_h handle);
+
+/**
+ * @brief Encodes image to the jpeg image
+ *
+ * @remarks Besides the colorspaces of image_util_foreach_supported_jpeg_colorspace(), #IMAGE_UTIL_COLORSPACE_I420,\n
+ * #IMAGE_UTIL_COLORSPACE_NV12, #IMAGE_UTIL_COLORSPACE_UYVY, #IMAGE_UTIL_COLORSPACE_YUYV, #IMAGE_UTIL_COLORSPACE_RGB565\n
+ * and the 32 bit RGB colorspaces are encoded as they are, without a converted copy of the image.\n
+ * The subsampled ones among them are not supported with an odd width or height.
+ *
+ * @param[in]	buffer	The origin image buffer
+ * @param[in]	width	The origin image width
+ * @param[in]	height	The origin image height
+ * @param[in]	colorspace	The origin image colorspace
+ * @param[in]	quality The quality for JPEG image encoding (1 ~ 100)
+ * @param[in]	path	The file path to be created
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_NO_SUCH_FILE no such file
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation 
+ *
+ * @see image_util_supported_jpeg_colorspace_cb()
+ * @see image_util_foreach_supported_jpeg_colorspace() 
+ * @see image_util_encode_jpeg_to_memory()
+ */
+int image_util_encode_jpeg( const unsigned char *buffer, int width, int height, image_util_colorspace_e colorspace,  int quality, const char *path);
+
+/**
+ * @brief Encodes image to the jpeg image
+ *
+ * @remarks @a jpeg_buffer must be released with free() by you, or with the free function of image_util_set_allocator() when one is set.\n
+ * The colorspaces of image_util_encode_jpeg() are supported.
+ * 
+ * @param[in]	image_buffer	The origin image buffer
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	colorspace	The origin image colorspace
+ * @param[in]	quality The quality for JPEG image encoding (1 ~ 100)
+ * @param[out]	jpeg_buffer	The created jpeg image buffer.  The buffer is created by frameworks
+ * @param[out]	jpeg_size		The created jpeg image buffer size
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ * @retval	 #IMAGE_UTIL_ERROR_INVALID_OPERATION Invalid operation 
+ *
+ * @see image_util_supported_jpeg_colorspace_cb()
+ * @see image_util_foreach_supported_jpeg_colorspace()
+ * @see image_util_encode_jpeg()
+ */
+int image_util_encode_jpeg_to_memory(const unsigned char *image_buffer, int width, int height, image_util_colorspace_e colorspace, int quality,  unsigned char** jpeg_buffer, unsigned int *jpeg_size);
+
+/**
+ * @brief Creates a JPEG encoding handle
+ *
+ * @remarks The quality is 75 unless set otherwise.\n
+ * @a handle must be released with image_util_encode_destroy().
+ *
+ * @param[out]	handle	The encoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_encode_destroy()
+ * @see image_util_encode_start_stream()
+ */
+int image_util_encode_create(image_util_encode_h *handle);
+
+/**
+ * @brief Sets the size of the image to encode
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started
+ *
+ * @see image_util_encode_create()
+ */
+int image_util_encode_set_resolution(image_util_encode_h handle, int width, int height);
+
+/**
+ * @brief Sets the colorspace of the image to encode
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	colorspace	The colorspace of the pushed rows
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started
+ *
+ * @see image_util_foreach_supported_jpeg_colorspace()
+ */
+int image_util_encode_set_colorspace(image_util_encode_h handle, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Sets the quality of the encoding
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	quality	The quality for JPEG image encoding (1 ~ 100)
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started
+ */
+int image_util_encode_set_quality(image_util_encode_h handle, int quality);
+
+/**
+ * @brief Starts encoding a jpeg image whose rows are pushed in parts
+ *
+ * @remarks The jpeg data is handed to @a callback as soon as the pushed rows complete it,\n
+ * so neither the image nor the jpeg data is kept in memory as a whole.
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	callback	The callback function to invoke with the jpeg data
+ * @param[in]	user_data	The user data to be passed to the callback function
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or no resolution is set
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is already started, or @a callback stopped the encoding
+ *
+ * @post	image_util_encode_push_rows() encodes the rows and invokes image_util_encode_output_cb().
+ * @see image_util_encode_push_rows()
+ * @see image_util_encode_finish_stream()
+ */
+int image_util_encode_start_stream(image_util_encode_h handle, image_util_encode_output_cb callback, void *user_data);
+
+/**
+ * @brief Pushes the next rows of the image
+ *
+ * @remarks The rows come in order from the top of the image. For colorspaces with vertically subsampled chroma\n
+ * every push but the last one must have an even number of rows.\n
+ * @a rows is not needed after the function returns.
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	rows	The planes of the rows, starting at their first row
+ * @param[in]	num_rows	The number of rows
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or more rows than the image has
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION No stream is started, or @a callback stopped the encoding
+ *
+ * @pre	image_util_encode_start_stream()
+ * @see image_util_encode_finish_stream()
+ */
+int image_util_encode_push_rows(image_util_encode_h handle, const image_util_planes_s *rows, int num_rows);
+
+/**
+ * @brief Ends encoding a jpeg image whose rows are pushed in parts
+ *
+ * @param[in]	handle	The encoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful, all of the jpeg data was handed to the callback
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION Not all rows were pushed, or no stream is started
+ *
+ * @pre	image_util_encode_start_stream()
+ * @see image_util_encode_push_rows()
+ */
+int image_util_encode_finish_stream(image_util_encode_h handle);
+
+/**
+ * @brief Gets the largest size the jpeg image of the handle can take
+ *
+ * @remarks A buffer of this size always holds the result of image_util_encode_run_to_buffer(),\n
+ * whatever the image and the quality.
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[out]	size	The largest size of the jpeg data
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or no resolution is set
+ *
+ * @see image_util_encode_run_to_buffer()
+ */
+int image_util_encode_get_max_size(image_util_encode_h handle, unsigned int *size);
+
+/**
+ * @brief Encodes a whole image and hands the jpeg data to a callback
+ *
+ * @remarks The jpeg data is handed to @a callback in parts as it is compressed, it is not kept in memory as a whole.\n
+ * The function returns once the whole image is encoded.
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	src	The planes of the image, of the resolution and colorspace of the handle
+ * @param[in]	callback	The callback function to invoke with the jpeg data
+ * @param[in]	user_data	The user data to be passed to the callback function
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or no resolution is set
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started, or @a callback stopped the encoding
+ *
+ * @post	This function invokes image_util_encode_output_cb() repeatedly.
+ * @see image_util_encode_run_to_buffer()
+ */
+int image_util_encode_run(image_util_encode_h handle, const image_util_planes_s *src, image_util_encode_output_cb callback, void *user_data);
+
+/**
+ * @brief Encodes a whole image into a buffer of the caller
+ *
+ * @remarks The jpeg data is compressed into @a buffer directly. A buffer of the size given by\n
+ * image_util_encode_get_max_size() is always large enough.
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	src	The planes of the image, of the resolution and colorspace of the handle
+ * @param[in]	buffer	The buffer for the jpeg data
+ * @param[in]	capacity	The size of @a buffer
+ * @param[out]	size	The size of the jpeg data in @a buffer
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or the jpeg data does not fit @a capacity
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started
+ *
+ * @see image_util_encode_get_max_size()
+ */
+int image_util_encode_run_to_buffer(image_util_encode_h handle, const image_util_planes_s *src, unsigned char *buffer, unsigned int capacity, unsigned int *size);
+
+/**
+ * @brief Destroys a JPEG encoding handle
+ *
+ * @param[in]	handle	The encoding handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_encode_create()
+ */
+int image_util_encode_destroy(image_util_encode_h handle);
+
+/**
+ * @brief Creates a transformation handle
+ *
+ * @remarks A transformation runs crop, resize, rotation and colorspace conversion, in this order,\n
+ * in one pass over the source without full size intermediate buffers.\n
+ * The result is the same as calling image_util_crop_ex(), image_util_resize_ex(), image_util_rotate_ex()\n
+ * and image_util_convert_colorspace_ex() one after the other. Steps which are not set are skipped.\n
+ * @a handle must be released with image_util_transform_destroy().
+ *
+ * @param[out]	handle	The transformation handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_transform_destroy()
+ * @see image_util_transform_run()
+ */
+int image_util_transform_create(image_util_transform_h *handle);
+
+/**
+ * @brief Sets the area of the source to transform
+ *
+ * @remarks @a x and @a y must be even where the source colorspace shares chroma between neighbouring pixels or rows.
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	x The starting x-axis of crop
+ * @param[in]	y The starting y-axis of crop
+ * @param[in]	width  The width of the area
+ * @param[in]	height  The height of the area
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_crop_ex()
+ */
+int image_util_transform_set_crop_area(image_util_transform_h handle, int x, int y, int width, int height);
+
+/**
+ * @brief Sets the size the cropped image is resized to, before the rotation
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	width	The width to resize
+ * @param[in]	height	The height to resize
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_resize_ex()
+ */
+int image_util_transform_set_resolution(image_util_transform_h handle, int width, int height);
+
+/**
+ * @brief Sets the rotation of the resized image
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	rotation	The angle to rotate
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_rotate_ex()
+ */
+int image_util_transform_set_rotation(image_util_transform_h handle, image_util_rotation_e rotation);
+
+/**
+ * @brief Sets the colorspace of the result
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	colorspace	The colorspace to be converted
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_convert_colorspace_ex()
+ */
+int image_util_transform_set_colorspace(image_util_transform_h handle, image_util_colorspace_e colorspace);
+
+/**
+ * @brief Gets the size of the result for a source image
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	src_width	The source image width
+ * @param[in]	src_height	The source image height
+ * @param[in]	src_colorspace	The source image colorspace
+ * @param[out]	width	The width of the result
+ * @param[out]	height	The height of the result
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_get_plane_layout()
+ */
+int image_util_transform_get_dest_resolution(image_util_transform_h handle, int src_width, int src_height, image_util_colorspace_e src_colorspace, int *width, int *height);
+
+/**
+ * @brief Runs the transformation
+ *
+ * @remarks The resampling plans are kept in @a handle and reused while the sizes stay the same.\n
+ * A handle must not be run from several threads at the same time.
+ *
+ * @param[in]	handle	The transformation handle
+ * @param[in]	dest	The planes for result. Must be allocated by you
+ * @param[in]	src	The planes of source image
+ * @param[in]	src_width	The source image width
+ * @param[in]	src_height	The source image height
+ * @param[in]	src_colorspace	The source image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ *
+ * @see image_util_transform_get_dest_resolution()
+ */
+int image_util_transform_run(image_util_transform_h handle, image_util_planes_s *dest, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e src_colorspace);
+
+/**
+ * @brief Destroys a transformation handle
+ *
+ * @param[in]	handle	The transformation handle
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_transform_create()
+ */
+int image_util_transform_destroy(image_util_transform_h handle);
+
+/**
+ * @brief Decodes the jpeg image of a decoding handle in the background
+ *
+ * @remarks The options of @a handle are taken when the function is called, the handle can be changed or destroyed afterwards.
+ * A jpeg buffer set on the handle must stay valid until the request is finished.\n
+ * The decoded image is taken with image_util_request_get_result(). @a request must be released with image_util_request_destroy().
+ *
+ * @param[in]	handle	The decoding handle
+ * @param[in]	callback	The callback function to invoke when the image is decoded, or NULL
+ * @param[in]	user_data	The user data to be passed to the callback function
+ * @param[out]	request	The request of the decoding
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The background threads can not be started
+ *
+ * @post	image_util_completed_cb() is invoked when the request is finished.
+ * @see image_util_decode_run()
+ */
+int image_util_decode_run_async(image_util_decode_h handle, image_util_completed_cb callback, void *user_data, image_util_request_h *request);
+
+/**
+ * @brief Encodes an image with the options of an encoding handle in the background
+ *
+ * @remarks The options of @a handle are taken when the function is called. The planes of @a src must stay valid until the request is finished.\n
+ * The jpeg data is taken with image_util_request_get_result(). @a request must be released with image_util_request_destroy().
+ *
+ * @param[in]	handle	The encoding handle
+ * @param[in]	src	The planes of the image, of the resolution and colorspace of the handle
+ * @param[in]	callback	The callback function to invoke when the image is encoded, or NULL
+ * @param[in]	user_data	The user data to be passed to the callback function
+ * @param[out]	request	The request of the encoding
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter, or no resolution is set
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION A stream is started, or the background threads can not be started
+ *
+ * @post	image_util_completed_cb() is invoked when the request is finished.
+ * @see image_util_encode_run()
+ */
+int image_util_encode_run_async(image_util_encode_h handle, const image_util_planes_s *src, image_util_completed_cb callback, void *user_data, image_util_request_h *request);
+
+/**
+ * @brief Converts the colorspace of an image in the background
+ *
+ * @remarks The planes of @a dest and @a src must stay valid until the request is finished.
+ * @a request must be released with image_util_request_destroy().
+ *
+ * @param[in]	dest	The planes of the destination image
+ * @param[in]	dest_colorspace	The destination colorspace
+ * @param[in]	src	The planes of the source image
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	src_colorspace	The source colorspace
+ * @param[in]	callback	The callback function to invoke when the image is converted, or NULL
+ * @param[in]	user_data	The user data to be passed to the callback function
+ * @param[out]	request	The request of the conversion
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The background threads can not be started
+ *
+ * @post	image_util_completed_cb() is invoked when the request is finished.
+ * @see image_util_convert_colorspace_ex()
+ */
+int image_util_convert_colorspace_async(image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, int width, int height, image_util_colorspace_e src_colorspace, image_util_completed_cb callback, void *user_data, image_util_request_h *request);
+
+/**
+ * @brief Resizes an image in the background
+ *
+ * @remarks The planes of @a dest and @a src must stay valid until the request is finished.
+ * @a request must be released with image_util_request_destroy().
+ *
+ * @param[in]	dest	The planes of the destination image
+ * @param[in]	dest_width	The destination width
+ * @param[in]	dest_height	The destination height
+ * @param[in]	src	The planes of the source image
+ * @param[in]	src_width	The source width
+ * @param[in]	src_height	The source height
+ * @param[in]	colorspace	The image colorspace
+ * @param[in]	callback	The callback function to invoke when the image is resized, or NULL
+ * @param[in]	user_data	The user data to be passed to the callback function
+ * @param[out]	request	The request of the resize
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ * @retval    #IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT Not supported format
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The background threads can not be started
+ *
+ * @post	image_util_completed_cb() is invoked when the request is finished.
+ * @see image_util_resize_ex()
+ */
+int image_util_resize_async(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_completed_cb callback, void *user_data, image_util_request_h *request);
+
+/**
+ * @brief Gets a file descriptor that becomes readable when a request is finished
+ *
+ * @remarks The descriptor is an eventfd to poll in a main loop. It belongs to @a request and is closed by image_util_request_destroy().
+ *
+ * @param[in]	request	The request
+ * @param[out]	fd	The file descriptor
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The descriptor can not be created
+ */
+int image_util_request_get_fd(image_util_request_h request, int *fd);
+
+/**
+ * @brief Waits until a request is finished
+ *
+ * @param[in]	request	The request
+ *
+ * @return	  The result of the request.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_CANCELED The request was canceled
+ */
+int image_util_request_wait(image_util_request_h request);
+
+/**
+ * @brief Cancels a request
+ *
+ * @remarks A request that has not started yet does not run. A running request stops at its next band of rows and
+ * finishes with #IMAGE_UTIL_ERROR_CANCELED. A request that is already finished keeps its result.
+ *
+ * @param[in]	request	The request
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_request_cancel(image_util_request_h request);
+
+/**
+ * @brief Gets the result of a finished request
+ *
+ * @remarks For a decoding @a buffer is the decoded image and for an encoding it is the jpeg data. It is handed over once and must be released with free(), or with the free function of image_util_set_allocator() when one is set.\n
+ * For a conversion or a resize the image is in the planes passed with the request, @a buffer is NULL and @a size is 0.
+ *
+ * @param[in]	request	The request
+ * @param[out]	buffer	The image made by the request, or NULL
+ * @param[out]	width	The image width
+ * @param[out]	height	The image height
+ * @param[out]	size	The size of @a buffer
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_OPERATION The request is not finished
+ * @retval    #IMAGE_UTIL_ERROR_CANCELED The request was canceled
+ */
+int image_util_request_get_result(image_util_request_h request, unsigned char **buffer, int *width, int *height, unsigned int *size);
+
+/**
+ * @brief Releases a request
+ *
+ * @remarks A request that is not finished is canceled, and its callback is not invoked any more.
+ *
+ * @param[in]	request	The request
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_request_destroy(image_util_request_h request);
+
+/**
+ * @brief Sets the number of threads used by image operations
+ *
+ * @remarks The setting applies to the whole process. By default operations run on the calling thread only.\n
+ * With more threads, image_util_convert_colorspace(), image_util_resize() and image_util_rotate() split
+ * the image into bands of rows and process them in parallel. The result does not depend on the number of threads.\n
+ * image_util_decode_jpeg_batch() decodes one image on each thread.\n
+ * The threads serve one operation at a time. An operation started while another one runs on them, from another thread
+ * or in a callback of image_util_decode_jpeg_batch(), runs on its calling thread alone.
+ *
+ * @param[in]	num_threads	The number of threads including the calling thread (1 ~ 64)
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_get_num_threads()
+ */
+int image_util_set_num_threads(int num_threads);
+
+/**
+ * @brief Gets the number of threads used by image operations
+ *
+ * @param[out]	num_threads	The number of threads including the calling thread
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_set_num_threads()
+ */
+int image_util_get_num_threads(int *num_threads);
+
+/**
+ * @brief Creates an image with its own planes
+ *
+ * @remarks The planes are laid out as by image_util_get_plane_layout() with rows aligned to 64 bytes.\n
+ * The image is created with one reference. When the last one is dropped its memory goes back to a pool,\n
+ * and is reused by the next image of about the same size, so a loop over frames of one size does not\n
+ * allocate after its first frames. Up to 64 MB of released images are kept.
+ *
+ * @param[in]	width	The image width
+ * @param[in]	height	The image height
+ * @param[in]	colorspace	The image colorspace
+ * @param[out]	image	The created image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval	 #IMAGE_UTIL_ERROR_OUT_OF_MEMORY out of memory
+ *
+ * @see image_util_image_unref()
+ * @see image_util_image_get_planes()
+ */
+int image_util_image_create(int width, int height, image_util_colorspace_e colorspace, image_util_image_h *image);
+
+/**
+ * @brief Adds a reference to an image
+ *
+ * @remarks References may be added and dropped from any thread.
+ *
+ * @param[in]	image	The image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_image_unref()
+ */
+int image_util_image_ref(image_util_image_h image);
+
+/**
+ * @brief Drops a reference to an image, the image is released with the last one
+ *
+ * @param[in]	image	The image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ *
+ * @see image_util_image_ref()
+ */
+int image_util_image_unref(image_util_image_h image);
+
+/**
+ * @brief Gets the size and the colorspace of an image
+ *
+ * @param[in]	image	The image
+ * @param[out]	width	The image width
+ * @param[out]	height	The image height
+ * @param[out]	colorspace	The image colorspace
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_image_get_info(image_util_image_h image, int *width, int *height, image_util_colorspace_e *colorspace);
+
+/**
+ * @brief Gets the planes of an image
+ *
+ * @remarks The planes belong to the image and are valid while it has a reference.\n
+ * They can be passed to every function that takes planes, as source or as destination.
+ *
+ * @param[in]	image	The image
+ * @param[out]	planes	The planes of the image
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_image_get_planes(image_util_image_h image, image_util_planes_s *planes);
+
+/**
+ * @brief Sets the functions the library allocates its memory with
+ *
+ * @remarks The setting applies to the whole process. Every buffer the library hands out, the decoded images,
+ * the jpeg data, the copies of image_util_crop_view() and the planes of images, as well as its handles and scratch memory
+ * come from @a allocator. The buffers handed out are released with its free function instead of free().\n
+ * The buffers image_util_decode_jpeg(), image_util_decode_jpeg_from_memory() and image_util_encode_jpeg_to_memory() get from mm_util,
+ * for the colorspaces and sizes the library does not handle itself, are copied into memory of @a allocator when one is set.
+ * Without one they are handed out as mm_util allocated them.\n
+ * It must be set while the library holds no memory: no handle, image, request or buffer of the library is alive and no operation is running.
+ * The memory the library keeps for reuse is released with the previous allocator.\n
+ * The library calls the functions of @a allocator from any thread, also at the same time, so they must be thread-safe.
+ * image_util_set_allocator() itself is not thread-safe: it must not run at the same time as any other function of the library.\n
+ * The buffers handed out are taken from aligned_alloc, at an alignment of at least 64 bytes, apart from the ones mm_util allocated.\n
+ *
+ * @param[in]	allocator	The allocator, NULL to go back to malloc() and free()
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ * @retval    #IMAGE_UTIL_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int image_util_set_allocator(const image_util_allocator_s *allocator);
+
+/**
+ * @brief Sets whether large buffers of the library are backed by huge pages
+ *
+ * @remarks The setting applies to the whole process, it is off by default.\n
+ * When it is on, the buffers handed out and the images larger than 2 MB, apart from the ones mm_util allocated for the legacy calls
+ * with the default allocator, are aligned to 2 MB, advised to the kernel
+ * for transparent huge pages and faulted in when they are allocated, instead of on the first write. This cuts
+ * the TLB misses of the conversions and the resize of large images, at the cost of the size being rounded up to 2 MB.\n
+ * Whether huge pages are used in the end depends on the transparent huge page setting of the system.
+ *
+ * @param[in]	enable	true to back large buffers by huge pages, false for normal pages
+ *
+ * @return	  0 on success, otherwise a negative error value.
+ * @retval    #IMAGE_UTIL_ERROR_NONE Successful
+ *
+ * @see image_util_set_allocator()
+ */
+int image_util_set_hugepages(bool enable);
 
 
 
@@ -0,0 +1,342 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __TIZEN_MEDIA_IMAGE_UTIL_PRIVATE_H__
+#define __TIZEN_MEDIA_IMAGE_UTIL_PRIVATE_H__
+
+#include <image_util.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define IMAGE_UTIL_COLORSPACE_NUM	(IMAGE_UTIL_COLORSPACE_BGRX8888 + 1)
+#define IMAGE_UTIL_MAX_THREADS		64
+#define IMAGE_UTIL_RESIZE_PRECISION	14
+#define IMAGE_UTIL_OUTPUT_ALIGN		64		/* the buffers handed out start on a cache line */
+
+/**
+ * @brief Byte position of each channel inside a 32bit RGB pixel
+ */
+typedef struct
+{
+	unsigned char r;
+	unsigned char g;
+	unsigned char b;
+	unsigned char a;
+} image_util_rgb32_order_s;
+
+/**
+ * @brief Row kernels of the colorspace conversion engine.
+ *
+ * @remarks YUV is BT.601 limited range; @a u and @a v rows are horizontally subsampled by 2.\n
+ * The resize kernels sum pixels times #IMAGE_UTIL_RESIZE_PRECISION bit fixed point weights, the weights of\n
+ * a horizontal output start at pixel @a start of @a src, and are padded by 8 zero weights past the last output.\n
+ * The transpose turns @a width x @a height elements of @a bytes each into @a height x @a width, the strides may be negative.
+ */
+typedef struct
+{
+	const char *name;
+	void (*yuv_to_rgb32_row)(const unsigned char *y, const unsigned char *u, const unsigned char *v, unsigned char *dst, int width, const image_util_rgb32_order_s *order);
+	void (*rgb32_to_y_row)(const unsigned char *src, unsigned char *y, int width, const image_util_rgb32_order_s *order);
+	void (*rgb32_to_uv_row)(const unsigned char *src, unsigned char *u, unsigned char *v, int width, const image_util_rgb32_order_s *order);
+	void (*resize_row_h)(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size, int channels);
+	void (*resize_row_v)(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int size);
+	void (*transpose)(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int width, int height, int bytes);
+} image_util_simd_ops_s;
+
+/**
+ * @brief Resampling plans of an image size change, and the row ring of one sequential pass over it
+ *
+ * @remarks Resizers are shared through a cache of the last used ones, they are taken with
+ * _image_util_resizer_get() and let go with _image_util_resizer_release().
+ */
+typedef struct _image_util_resizer_s image_util_resizer_s;
+typedef struct _image_util_resize_state_s image_util_resize_state_s;
+
+/**
+ * @brief A JPEG image decoded while its data is pushed
+ */
+typedef struct _image_util_jpeg_stream_s image_util_jpeg_stream_s;
+
+/**
+ * @brief A JPEG image encoded while its rows are pushed
+ */
+typedef struct _image_util_jpeg_encoder_s image_util_jpeg_encoder_s;
+
+/**
+ * @brief The steps recorded in an image_util_transform_h
+ */
+typedef struct image_util_transform_s
+{
+	bool crop;
+	int crop_x;
+	int crop_y;
+	int crop_width;
+	int crop_height;
+	bool resize;
+	int width;
+	int height;
+	image_util_rotation_e rotation;
+	bool convert;
+	image_util_colorspace_e colorspace;
+	image_util_resizer_s *resizer;		/* plans of the last run */
+} image_util_transform_s;
+
+/**
+ * @brief A file mapped read-only into memory
+ */
+typedef struct
+{
+	const unsigned char *data;
+	unsigned int size;
+} image_util_mapped_file_s;
+
+/**
+ * @brief The input and options recorded in an image_util_decode_h
+ */
+typedef struct image_util_decode_s
+{
+	char *path;
+	const unsigned char *buffer;
+	unsigned int size;
+	image_util_decode_read_cb read;		/* read once, cleared by the decoding */
+	void *read_user_data;
+	int fd;								/* read once like read, -1 for none */
+	image_util_file_access_e file_access;	/* for path */
+	image_util_colorspace_e colorspace;
+	bool crop;							/* area of the full size image */
+	int crop_x;
+	int crop_y;
+	int crop_width;
+	int crop_height;
+	image_util_scale_e downscale;
+	int width;							/* requested resolution, 0 for the decoded size */
+	int height;
+	image_util_jpeg_stream_s *stream;	/* between image_util_decode_start_stream() and image_util_decode_finish_stream() */
+} image_util_decode_s;
+
+/**
+ * @brief Memory of the caller to decode into, either planes or a packed buffer
+ */
+typedef struct
+{
+	const image_util_planes_s *planes;
+	unsigned char *buffer;
+	unsigned int capacity;
+} image_util_decode_dest_s;
+
+/**
+ * @brief The image and options recorded in an image_util_encode_h
+ */
+typedef struct image_util_encode_s
+{
+	int width;
+	int height;
+	image_util_colorspace_e colorspace;
+	int quality;
+	image_util_jpeg_encoder_s *encoder;	/* between image_util_encode_start_stream() and image_util_encode_finish_stream() */
+} image_util_encode_s;
+
+typedef enum
+{
+	IMAGE_UTIL_REQUEST_DECODE,
+	IMAGE_UTIL_REQUEST_ENCODE,
+	IMAGE_UTIL_REQUEST_CONVERT,
+	IMAGE_UTIL_REQUEST_RESIZE,
+} image_util_request_type_e;
+
+/**
+ * @brief An operation run in the background, and its result
+ */
+typedef struct image_util_request_s
+{
+	image_util_request_type_e type;
+	image_util_completed_cb callback;
+	void *user_data;
+
+	/* the operation, copied from the caller */
+	image_util_decode_s decode;
+	image_util_encode_s encode;
+	image_util_planes_s dest;
+	image_util_planes_s src;
+	image_util_colorspace_e dest_colorspace;
+	image_util_colorspace_e src_colorspace;
+	int dest_width;
+	int dest_height;
+	int src_width;
+	int src_height;
+
+	/* owned by the executor, under its lock */
+	struct image_util_request_s *next;
+	int state;
+	int refs;
+	bool detached;			/* destroyed before it was finished */
+	int canceled;			/* also read by the running operation */
+	int error;
+	int fd;
+
+	/* the result */
+	unsigned char *buffer;
+	int width;
+	int height;
+	unsigned int size;
+} image_util_request_s;
+
+/**
+ * @brief An image and its planes, in one block of the image pool
+ *
+ * The header of scratch blocks of the pool as well, with only the pool fields in use.
+ */
+typedef struct image_util_image_s
+{
+	int refs;
+	int width;
+	int height;
+	image_util_colorspace_e colorspace;
+	image_util_planes_s planes;
+	unsigned int size;					/* of the planes */
+
+	/* owned by the pool */
+	unsigned int capacity;				/* of the block */
+	int pool_class;						/* -1 when the block is not pooled */
+	struct image_util_image_s *next;	/* in the free list */
+} image_util_image_s;
+
+/**
+ * @brief Work item of a parallel job, returns an image_util_error_e value
+ */
+typedef int (*image_util_task_cb)(void *data, int index);
+
+
+/* image_util_convert.c */
+bool _image_util_colorspace_is_yuv(image_util_colorspace_e colorspace);
+bool _image_util_is_native_size(int width, int height, image_util_colorspace_e colorspace);
+int _image_util_get_num_planes(image_util_colorspace_e colorspace);
+void _image_util_get_plane_geometry(image_util_colorspace_e colorspace, int plane, int width, int height, int *elements, int *rows, int *bytes);
+int _image_util_get_plane_layout(image_util_colorspace_e colorspace, int width, int height, int alignment, image_util_plane_layout_s *layout);
+int _image_util_get_packed_planes(image_util_colorspace_e colorspace, int width, int height, const unsigned char *buffer, image_util_planes_s *planes, unsigned int *size);
+int _image_util_check_planes(image_util_colorspace_e colorspace, int width, int height, const image_util_planes_s *planes);
+int _image_util_get_crop_planes(image_util_colorspace_e colorspace, const image_util_planes_s *src, int x, int y, image_util_planes_s *view);
+int _image_util_crop_resample(const image_util_planes_s *dest, image_util_colorspace_e colorspace, const image_util_planes_s *src, int src_width, int src_height, int x, int y, int width, int height);
+int _image_util_convert_rows(const image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, image_util_colorspace_e src_colorspace, int width, int height, int row_start, int row_end);
+int _image_util_convert(const image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, image_util_colorspace_e src_colorspace, int width, int height);
+const image_util_simd_ops_s *_image_util_get_simd_ops(void);
+
+void _image_util_yuv_to_rgb32_row_c(const unsigned char *y, const unsigned char *u, const unsigned char *v, unsigned char *dst, int width, const image_util_rgb32_order_s *order);
+void _image_util_rgb32_to_y_row_c(const unsigned char *src, unsigned char *y, int width, const image_util_rgb32_order_s *order);
+void _image_util_rgb32_to_uv_row_c(const unsigned char *src, unsigned char *u, unsigned char *v, int width, const image_util_rgb32_order_s *order);
+
+/* image_util_rotate.c */
+bool _image_util_rotate_supported(image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation);
+int _image_util_rotate(const image_util_planes_s *dest, const image_util_planes_s *src, image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation);
+bool _image_util_rotate_in_place_supported(image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation);
+int _image_util_rotate_in_place(const image_util_planes_s *planes, image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation);
+void _image_util_transpose_c(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int width, int height, int bytes);
+
+/* image_util_resize.c */
+bool _image_util_resize_supported(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height);
+int _image_util_resize(const image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_resize_filter_e filter);
+image_util_resizer_s *_image_util_resizer_get(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter);
+void _image_util_resizer_release(image_util_resizer_s *resizer);
+void _image_util_resizer_flush(void);
+bool _image_util_resizer_matches(const image_util_resizer_s *resizer, image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter);
+image_util_resize_state_s *_image_util_resize_state_create(const image_util_resizer_s *resizer);
+void _image_util_resize_state_destroy(image_util_resize_state_s *state);
+int _image_util_resize_rows(const image_util_resizer_s *resizer, image_util_resize_state_s *state, const image_util_planes_s *dest, const image_util_planes_s *src, int row_start, int row_end);
+
+void _image_util_resize_row_h_c(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size, int channels);
+void _image_util_resize_row_v_c(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int size);
+
+/* image_util_transform.c */
+int _image_util_transform_get_dest_size(const image_util_transform_s *transform, int src_width, int src_height, image_util_colorspace_e src_colorspace, int *crop_width, int *crop_height, int *width, int *height);
+int _image_util_transform_run(image_util_transform_s *transform, const image_util_planes_s *dest, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e src_colorspace);
+void _image_util_transform_reset_plan(image_util_transform_s *transform);
+
+/* image_util_jpeg.c */
+int _image_util_jpeg_decode(const image_util_decode_s *decode, const image_util_decode_dest_s *target, unsigned char **image_buffer, int *width, int *height, unsigned int *size);
+int _image_util_jpeg_stream_create(const image_util_decode_s *decode, image_util_decode_rows_cb callback, void *user_data, image_util_jpeg_stream_s **stream);
+int _image_util_jpeg_stream_push(image_util_jpeg_stream_s *stream, const unsigned char *data, unsigned int size);
+int _image_util_jpeg_stream_finish(image_util_jpeg_stream_s *stream);
+void _image_util_jpeg_stream_destroy(image_util_jpeg_stream_s *stream);
+int _image_util_jpeg_decode_batch(const image_util_decode_item_s *items, int num_items, image_util_decode_batch_cb callback, void *user_data);
+int _image_util_jpeg_decode_thumbnail(const char *path, const unsigned char *buffer, unsigned int size, int min_width, int min_height, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *image_size);
+int _image_util_jpeg_encoder_create(const image_util_encode_s *encode, image_util_encode_output_cb callback, void *user_data, image_util_jpeg_encoder_s **encoder);
+int _image_util_jpeg_encoder_write(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *rows, int num_rows);
+int _image_util_jpeg_encoder_finish(image_util_jpeg_encoder_s *encoder);
+void _image_util_jpeg_encoder_destroy(image_util_jpeg_encoder_s *encoder);
+int _image_util_jpeg_encode(const image_util_encode_s *encode, const image_util_planes_s *src, image_util_encode_output_cb callback, void *user_data);
+int _image_util_jpeg_encode_to_buffer(const image_util_encode_s *encode, const image_util_planes_s *src, unsigned char *buffer, unsigned int capacity, unsigned int *size);
+unsigned int _image_util_jpeg_get_max_size(int width, int height);
+int _image_util_jpeg_encode_to_file(const image_util_encode_s *encode, const image_util_planes_s *src, const char *path);
+int _image_util_jpeg_encode_to_memory(const image_util_encode_s *encode, const image_util_planes_s *src, unsigned char **jpeg_buffer, unsigned int *jpeg_size);
+
+/* image_util_async.c */
+image_util_request_s *_image_util_request_create(image_util_request_type_e type, image_util_completed_cb callback, void *user_data);
+int _image_util_request_submit(image_util_request_s *request);
+int _image_util_request_wait(image_util_request_s *request);
+void _image_util_request_cancel(image_util_request_s *request);
+int _image_util_request_get_fd(image_util_request_s *request, int *fd);
+int _image_util_request_get_result(image_util_request_s *request, unsigned char **buffer, int *width, int *height, unsigned int *size);
+void _image_util_request_destroy(image_util_request_s *request);
+bool _image_util_is_canceled(void);
+const int *_image_util_get_cancel_flag(void);
+
+/* image_util_image.c */
+int _image_util_image_create(int width, int height, image_util_colorspace_e colorspace, image_util_image_s **image);
+void _image_util_image_ref(image_util_image_s *image);
+void _image_util_image_unref(image_util_image_s *image);
+void *_image_util_pool_alloc(unsigned int size);
+void _image_util_pool_free(void *data);
+void _image_util_pool_flush(void);
+
+/* image_util_alloc.c */
+int _image_util_set_allocator(const image_util_allocator_s *allocator);
+bool _image_util_is_default_allocator(void);
+void *_image_util_malloc(size_t size);
+void *_image_util_calloc(size_t count, size_t size);
+void *_image_util_aligned_alloc(size_t alignment, size_t size);
+void _image_util_free(void *data);
+char *_image_util_strdup(const char *str);
+void *_image_util_adopt(void *data, size_t size);
+void _image_util_set_hugepages(bool enable);
+void *_image_util_output_alloc(size_t size);
+
+/* image_util_file.c */
+int _image_util_map_file(const char *path, bool populate, image_util_mapped_file_s *map);
+void _image_util_unmap_file(image_util_mapped_file_s *map);
+
+/* image_util_jpeg_info.c */
+int _image_util_jpeg_get_info(const char *path, const unsigned char *buffer, unsigned int size, image_util_jpeg_info_s *info);
+int _image_util_jpeg_get_thumbnail(const char *path, const unsigned char *buffer, unsigned int size, unsigned char **segment, unsigned int *offset, unsigned int *length);
+
+/* image_util_thread.c */
+int _image_util_set_num_threads(int num_threads);
+int _image_util_get_num_threads(void);
+int _image_util_parallel_for(int count, image_util_task_cb task, void *data);
+int _image_util_get_band_size(int rows, int align, int min_rows);
+
+/* image_util_simd_*.c */
+bool _image_util_simd_init_sse2(image_util_simd_ops_s *ops);
+bool _image_util_simd_init_avx2(image_util_simd_ops_s *ops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIZEN_MEDIA_IMAGE_UTIL_PRIVATE_H__ */
@@ -10,6 +10,7 @@ BuildRequires:  pkgconfig(mm-common)
 BuildRequires:  pkgconfig(mmutil-jpeg)
 BuildRequires:  pkgconfig(mmutil-imgp)
 BuildRequires:  pkgconfig(capi-base-common)
+BuildRequires:  pkgconfig(libjpeg)
 
 BuildRequires:  cmake
 BuildRequires:  gettext-devel
@@ -20,8 +20,12 @@
 #include <mm_util_imgp.h>
 #include <mm_util_jpeg.h>
 #include <image_util.h>
+#include <image_util_private.h>
 #include <mm.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 
 static int _convert_colorspace_tbl[] = { 
 	MM_UTIL_IMG_FMT_YUV420 , 		/* IMAGE_UTIL_COLORSPACE_YUV420 */
@@ -66,6 +70,7 @@ static int _convert_image_util_error_code(const char *func, int code){
 			errorstr = "ERROR_NONE";
 			break;
 		case MM_ERROR_IMAGE_FILEOPEN :
+		case IMAGE_UTIL_ERROR_NO_SUCH_FILE:
 			ret = IMAGE_UTIL_ERROR_NO_SUCH_FILE;
 			errorstr = "NO_SUCH_FILE";
 			break;
@@ -74,6 +79,10 @@ static int _convert_image_util_error_code(const char *func, int code){
 			ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
 			errorstr = "INVALID_OPERATION";
 			break;
+		case IMAGE_UTIL_ERROR_OUT_OF_MEMORY:
+			ret = IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+			errorstr = "OUT_OF_MEMORY";
+			break;
 		case IMAGE_UTIL_ERROR_INVALID_PARAMETER:
 		case MM_ERROR_NO_DECODED_DATA:
 		case MM_ERROR_IMAGE_INVALID_VALUE:
@@ -82,9 +91,14 @@ static int _convert_image_util_error_code(const char *func, int code){
 			break;
 		case MM_ERROR_IMAGE_NOT_SUPPORT_FORMAT:
 		case MM_ERROR_IMAGE_DEVICE_NOT_SUPPORT:
+		case IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT:
 			ret = IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
 			errorstr = "NOT_SUPPORTED_FORMAT";
 			break;			
+		case IMAGE_UTIL_ERROR_CANCELED:
+			ret = IMAGE_UTIL_ERROR_CANCELED;
+			errorstr = "CANCELED";
+			break;
 
 
 		default:
@@ -98,6 +112,33 @@ static int _convert_image_util_error_code(const char *func, int code){
 }
 
 
+int image_util_set_num_threads(int num_threads){
+	int ret;
+
+	ret = _image_util_set_num_threads(num_threads);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_get_num_threads(int *num_threads){
+	if( num_threads == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	*num_threads = _image_util_get_num_threads();
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_set_allocator(const image_util_allocator_s *allocator){
+	int ret;
+
+	ret = _image_util_set_allocator(allocator);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_set_hugepages(bool enable){
+	_image_util_set_hugepages(enable);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
 int image_util_foreach_supported_jpeg_colorspace(image_util_supported_jpeg_colorspace_cb callback, void * user_data){
 	if( callback == NULL )
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
@@ -120,8 +161,17 @@ int image_util_convert_colorspace( unsigned char * dest , image_util_colorspace_
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 	if( src_colorspace < 0 || src_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
-	
-	
+
+	/* without vector kernels for the CPU mm_util converts as fast as the C kernels */
+	if( strcmp(_image_util_get_simd_ops()->name, "c") != 0
+			&& _image_util_is_native_size(width, height, src_colorspace) && _image_util_is_native_size(width, height, dest_colorspace) ){
+		image_util_planes_s src_planes, dest_planes;
+		_image_util_get_packed_planes(src_colorspace, width, height, src, &src_planes, NULL);
+		_image_util_get_packed_planes(dest_colorspace, width, height, dest, &dest_planes, NULL);
+		ret = _image_util_convert(&dest_planes, dest_colorspace, &src_planes, src_colorspace, width, height);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+
 	ret = mm_util_convert_colorspace( src , width,height,  _convert_colorspace_tbl[src_colorspace] , dest, _convert_colorspace_tbl[dest_colorspace] );
 
 	return _convert_image_util_error_code(__func__, ret);
@@ -146,9 +196,17 @@ int image_util_resize(unsigned char * dest, int *dest_width , int *dest_height,
 	if( dest_width == NULL || dest_height == NULL)
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 
-	if( *dest_width <= 0 || dest_height <= 0 )
+	if( *dest_width <= 0 || *dest_height <= 0 )
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 
+	if( _image_util_resize_supported(colorspace, src_width, src_height, *dest_width, *dest_height) ){
+		image_util_planes_s src_planes, dest_planes;
+		_image_util_get_packed_planes(colorspace, src_width, src_height, src, &src_planes, NULL);
+		_image_util_get_packed_planes(colorspace, *dest_width, *dest_height, dest, &dest_planes, NULL);
+		ret = _image_util_resize(&dest_planes, *dest_width, *dest_height, &src_planes, src_width, src_height, colorspace, IMAGE_UTIL_RESIZE_FILTER_BILINEAR);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+
 	unsigned int dest_w, dest_h;
 	dest_w = *dest_width;
 	dest_h = *dest_height;
@@ -172,6 +230,23 @@ int image_util_rotate(unsigned char * dest, int *dest_width, int *dest_height, i
 	if( dest_width == NULL || dest_height == NULL)
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 
+	if( _image_util_rotate_supported(colorspace, src_width, src_height, dest_rotation) ){
+		image_util_planes_s src_planes, dest_planes;
+		bool swap = (dest_rotation == IMAGE_UTIL_ROTATION_90 || dest_rotation == IMAGE_UTIL_ROTATION_270);
+		_image_util_get_packed_planes(colorspace, src_width, src_height, src, &src_planes, NULL);
+		_image_util_get_packed_planes(colorspace, swap ? src_height : src_width, swap ? src_width : src_height, dest, &dest_planes, NULL);
+		ret = _image_util_rotate(&dest_planes, &src_planes, colorspace, src_width, src_height, dest_rotation);
+		if( ret == IMAGE_UTIL_ERROR_NONE ){
+			*dest_width = swap ? src_height : src_width;
+			*dest_height = swap ? src_width : src_height;
+		}
+		return _convert_image_util_error_code(__func__, ret);
+	}
+
+	/* the fallback can not rotate in place */
+	if( dest == src )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
 	unsigned int dest_w, dest_h;
 	ret = mm_util_rotate_image(src, src_width, src_height, _convert_colorspace_tbl[colorspace], dest,&dest_w, &dest_h, dest_rotation);
 	if( ret == 0){
@@ -187,11 +262,21 @@ int image_util_crop(unsigned char * dest, int x , int y, int* width, int* height
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
-	if( width == NULL )
+	if( width == NULL || height == NULL )
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 	if( src_width <= x  || src_height <= y || src_width < x+*width || src_height< y+*height)
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 
+	if( x >= 0 && y >= 0 && _image_util_is_native_size(src_width, src_height, colorspace) && _image_util_is_native_size(*width, *height, colorspace) ){
+		image_util_planes_s src_planes, dest_planes, view;
+		_image_util_get_packed_planes(colorspace, src_width, src_height, src, &src_planes, NULL);
+		_image_util_get_packed_planes(colorspace, *width, *height, dest, &dest_planes, NULL);
+		if( _image_util_get_crop_planes(colorspace, &src_planes, x, y, &view) == IMAGE_UTIL_ERROR_NONE ){
+			ret = _image_util_convert(&dest_planes, colorspace, &view, colorspace, *width, *height);
+			return _convert_image_util_error_code(__func__, ret);
+		}
+	}
+
 	unsigned int dest_w, dest_h;
 	dest_w = *width;
 	dest_h = *height;
@@ -204,6 +289,328 @@ int image_util_crop(unsigned char * dest, int x , int y, int* width, int* height
 	return _convert_image_util_error_code(__func__, ret);
 }
 
+int image_util_get_plane_layout(int width, int height, image_util_colorspace_e colorspace, int alignment, image_util_plane_layout_s *layout){
+	int ret;
+	if( layout == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_get_plane_layout(colorspace, width, height, alignment, layout);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_convert_colorspace_ex(image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, int width, int height, image_util_colorspace_e src_colorspace){
+	int ret;
+	if( dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( dest_colorspace < 0 || dest_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( src_colorspace < 0 || src_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(src_colorspace, width, height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(dest_colorspace, width, height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_convert(dest, dest_colorspace, src, src_colorspace, width, height);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_resize_ex(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace){
+	int ret;
+	if( dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(colorspace, dest_width, dest_height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_image_util_resize_supported(colorspace, src_width, src_height, dest_width, dest_height) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
+	ret = _image_util_resize(dest, dest_width, dest_height, src, src_width, src_height, colorspace, IMAGE_UTIL_RESIZE_FILTER_BILINEAR);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_resize_with_filter(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_resize_filter_e filter){
+	int ret;
+	if( dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( filter < IMAGE_UTIL_RESIZE_FILTER_NEAREST || filter > IMAGE_UTIL_RESIZE_FILTER_AREA )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(colorspace, dest_width, dest_height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_image_util_resize_supported(colorspace, src_width, src_height, dest_width, dest_height) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
+	ret = _image_util_resize(dest, dest_width, dest_height, src, src_width, src_height, colorspace, filter);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_rotate_ex(image_util_planes_s *dest, image_util_rotation_e dest_rotation, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace){
+	int ret;
+	bool swap = (dest_rotation == IMAGE_UTIL_ROTATION_90 || dest_rotation == IMAGE_UTIL_ROTATION_270);
+	if( dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( dest_rotation < 0 || dest_rotation > IMAGE_UTIL_ROTATION_FLIP_VERT )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(colorspace, swap ? src_height : src_width, swap ? src_width : src_height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_image_util_rotate_supported(colorspace, src_width, src_height, dest_rotation) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
+	ret = _image_util_rotate(dest, src, colorspace, src_width, src_height, dest_rotation);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_rotate_in_place(image_util_planes_s *planes, image_util_rotation_e rotation, int width, int height, image_util_colorspace_e colorspace){
+	int ret;
+	if( planes == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( rotation < 0 || rotation > IMAGE_UTIL_ROTATION_FLIP_VERT )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, width, height, planes) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_image_util_rotate_in_place_supported(colorspace, width, height, rotation) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
+	ret = _image_util_rotate_in_place(planes, colorspace, width, height, rotation);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_crop_ex(image_util_planes_s *dest, int x, int y, int width, int height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace){
+	int ret;
+	image_util_planes_s view;
+	if( dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( x < 0 || y < 0 || width <= 0 || height <= 0 || src_width <= x || src_height <= y || width > src_width - x || height > src_height - y )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(colorspace, width, height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_get_crop_planes(colorspace, src, x, y, &view);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = _image_util_convert(dest, colorspace, &view, colorspace, width, height);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_crop_view(image_util_planes_s *view, int x, int y, int width, int height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, unsigned char **buffer){
+	int ret, i;
+	image_util_plane_layout_s layout;
+	unsigned char *block;
+	if( view == NULL || src == NULL || buffer == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( x < 0 || y < 0 || width <= 0 || height <= 0 || src_width <= x || src_height <= y || width > src_width - x || height > src_height - y )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	*buffer = NULL;
+	if( _image_util_get_crop_planes(colorspace, src, x, y, view) == IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+
+	/* x or y splits a chroma sample, the area is copied */
+	_image_util_get_plane_layout(colorspace, width, height, IMAGE_UTIL_OUTPUT_ALIGN, &layout);
+	block = _image_util_output_alloc(layout.size);
+	if( block == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	memset(view, 0, sizeof(image_util_planes_s));
+	for( i = 0 ; i < layout.num_planes ; i++ ){
+		view->data[i] = block + layout.offset[i];
+		view->stride[i] = layout.stride[i];
+	}
+
+	ret = _image_util_crop_resample(view, colorspace, src, src_width, src_height, x, y, width, height);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_free(block);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	*buffer = block;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_create(image_util_transform_h *handle){
+	image_util_transform_s *transform;
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	transform = _image_util_calloc(1, sizeof(image_util_transform_s));
+	if( transform == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+
+	transform->rotation = IMAGE_UTIL_ROTATION_NONE;
+	*handle = transform;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_set_crop_area(image_util_transform_h handle, int x, int y, int width, int height){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( x < 0 || y < 0 || width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->crop = true;
+	handle->crop_x = x;
+	handle->crop_y = y;
+	handle->crop_width = width;
+	handle->crop_height = height;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_set_resolution(image_util_transform_h handle, int width, int height){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->resize = true;
+	handle->width = width;
+	handle->height = height;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_set_rotation(image_util_transform_h handle, image_util_rotation_e rotation){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( rotation < 0 || rotation > IMAGE_UTIL_ROTATION_FLIP_VERT )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->rotation = rotation;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_set_colorspace(image_util_transform_h handle, image_util_colorspace_e colorspace){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->convert = true;
+	handle->colorspace = colorspace;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_transform_get_dest_resolution(image_util_transform_h handle, int src_width, int src_height, image_util_colorspace_e src_colorspace, int *width, int *height){
+	int ret;
+	if( handle == NULL || width == NULL || height == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( src_colorspace < 0 || src_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_transform_get_dest_size(handle, src_width, src_height, src_colorspace, NULL, NULL, width, height);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_transform_run(image_util_transform_h handle, image_util_planes_s *dest, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e src_colorspace){
+	int ret;
+	int width, height;
+	if( handle == NULL || dest == NULL || src == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( src_colorspace < 0 || src_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_transform_get_dest_size(handle, src_width, src_height, src_colorspace, NULL, NULL, &width, &height);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, ret);
+	if( _image_util_check_planes(src_colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE
+		|| _image_util_check_planes(handle->convert ? handle->colorspace : src_colorspace, width, height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_transform_run(handle, dest, src, src_width, src_height, src_colorspace);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_transform_destroy(image_util_transform_h handle){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_transform_reset_plan(handle);
+	_image_util_free(handle);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_image_create(int width, int height, image_util_colorspace_e colorspace, image_util_image_h *image){
+	int ret;
+	if( image == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_image_create(width, height, colorspace, image);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_image_ref(image_util_image_h image){
+	if( image == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_image_ref(image);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_image_unref(image_util_image_h image){
+	if( image == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_image_unref(image);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_image_get_info(image_util_image_h image, int *width, int *height, image_util_colorspace_e *colorspace){
+	if( image == NULL || (width == NULL && height == NULL && colorspace == NULL) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	if( width )
+		*width = image->width;
+	if( height )
+		*height = image->height;
+	if( colorspace )
+		*colorspace = image->colorspace;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_image_get_planes(image_util_image_h image, image_util_planes_s *planes){
+	if( image == NULL || planes == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	*planes = image->planes;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+/*
+ * The legacy calls decode in the library into memory of the output allocator,
+ * when the image has a size the colorspace holds without rounding. mm_util
+ * decodes the other sizes and the data the library can not read, and reports
+ * their errors as before. mm_util lays MM_UTIL_JPEG_FMT_YUV420 out as I420.
+ */
+static int _decode_jpeg_native(const unsigned char *buffer, unsigned int size, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *image_size){
+	image_util_decode_s decode;
+	image_util_jpeg_info_s info;
+
+	if( colorspace == IMAGE_UTIL_COLORSPACE_YV12 )
+		colorspace = IMAGE_UTIL_COLORSPACE_I420;
+	if( _image_util_jpeg_get_info(NULL, buffer, size, &info) != IMAGE_UTIL_ERROR_NONE || !_image_util_is_native_size(info.width, info.height, colorspace) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+
+	memset(&decode, 0, sizeof(image_util_decode_s));
+	decode.buffer = buffer;
+	decode.size = size;
+	decode.fd = -1;
+	decode.colorspace = colorspace;
+	decode.downscale = IMAGE_UTIL_DOWNSCALE_1_1;
+	return _image_util_jpeg_decode(&decode, NULL, image_buffer, width, height, image_size);
+}
+
 int image_util_decode_jpeg( const char *path , image_util_colorspace_e colorspace, unsigned char ** image_buffer , int *width , int *height , unsigned int *size){
 	int ret;
 
@@ -215,9 +622,25 @@ int image_util_decode_jpeg( const char *path , image_util_colorspace_e colorspac
 		return _convert_image_util_error_code(__func__, MM_ERROR_IMAGE_NOT_SUPPORT_FORMAT);
 
 	mm_util_jpeg_yuv_data decoded;
-	
-	ret = mm_util_decode_from_jpeg_file(&decoded, (char*)path, _convert_encode_colorspace_tbl[colorspace]);
+	image_util_mapped_file_s map;
+
+	/* a mapped file is decoded from the page cache, others are read by mm_util */
+	if( _image_util_map_file(path, false, &map) == IMAGE_UTIL_ERROR_NONE && map.size <= INT_MAX ){
+		ret = _decode_jpeg_native(map.data, map.size, colorspace, image_buffer, width, height, size);
+		if( ret != IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT ){
+			_image_util_unmap_file(&map);
+			return _convert_image_util_error_code(__func__, ret);
+		}
+		ret = mm_util_decode_from_jpeg_memory(&decoded, (void *)map.data, map.size, _convert_encode_colorspace_tbl[colorspace]);
+		_image_util_unmap_file(&map);
+	}else{
+		_image_util_unmap_file(&map);
+		ret = mm_util_decode_from_jpeg_file(&decoded, (char*)path, _convert_encode_colorspace_tbl[colorspace]);
+	}
 	if( ret == 0 ){
+		decoded.data = _image_util_adopt(decoded.data, decoded.size);
+		if( decoded.data == NULL )
+			return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
 		*image_buffer = decoded.data;
 		if(width)
 			*width = decoded.width;
@@ -240,9 +663,18 @@ int image_util_decode_jpeg_from_memory( const unsigned char * jpeg_buffer , int
 
 	mm_util_jpeg_yuv_data decoded;
 
+	if( jpeg_size > 0 ){
+		ret = _decode_jpeg_native(jpeg_buffer, jpeg_size, colorspace, image_buffer, width, height, size);
+		if( ret != IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT )
+			return _convert_image_util_error_code(__func__, ret);
+	}
+
 	ret = mm_util_decode_from_jpeg_memory(&decoded , jpeg_buffer, jpeg_size, _convert_encode_colorspace_tbl[colorspace] );
 
 	if( ret == 0 ){
+		decoded.data = _image_util_adopt(decoded.data, decoded.size);
+		if( decoded.data == NULL )
+			return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
 		*image_buffer = decoded.data;
 		if(width)
 			*width = decoded.width;
@@ -255,12 +687,478 @@ int image_util_decode_jpeg_from_memory( const unsigned char * jpeg_buffer , int
 	return _convert_image_util_error_code(__func__, ret);	
 }
 
+int image_util_decode_jpeg_thumbnail(const char *path, int min_width, int min_height, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *size){
+	int ret;
+	if( path == NULL || image_buffer == NULL || min_width < 0 || min_height < 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_decode_thumbnail(path, NULL, 0, min_width, min_height, colorspace, image_buffer, width, height, size);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_get_jpeg_info(const char *path, image_util_jpeg_info_s *info){
+	int ret;
+	if( path == NULL || info == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_get_info(path, NULL, 0, info);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_get_jpeg_info_from_memory(const unsigned char *jpeg_buffer, unsigned int jpeg_size, image_util_jpeg_info_s *info){
+	int ret;
+	if( jpeg_buffer == NULL || jpeg_size == 0 || info == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_get_info(NULL, jpeg_buffer, jpeg_size, info);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_jpeg_batch(const image_util_decode_item_s *items, int num_items, image_util_decode_batch_cb callback, void *user_data){
+	int ret;
+	if( items == NULL || num_items <= 0 || callback == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_decode_batch(items, num_items, callback, user_data);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+static bool _has_decode_input(image_util_decode_s *decode){
+	return decode->path || decode->buffer || decode->read || decode->fd >= 0;
+}
+
+static void _clear_decode_input(image_util_decode_s *decode){
+	_image_util_free(decode->path);
+	decode->path = NULL;
+	decode->buffer = NULL;
+	decode->size = 0;
+	decode->read = NULL;
+	decode->read_user_data = NULL;
+	decode->fd = -1;
+}
+
+/* a callback or a descriptor is read by one decoding only */
+static void _clear_read_once_input(image_util_decode_s *decode){
+	if( decode->read || decode->fd >= 0 )
+		_clear_decode_input(decode);
+}
+
+int image_util_decode_create(image_util_decode_h *handle){
+	image_util_decode_s *decode;
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	decode = _image_util_calloc(1, sizeof(image_util_decode_s));
+	if( decode == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+
+	decode->colorspace = IMAGE_UTIL_COLORSPACE_RGB888;
+	decode->downscale = IMAGE_UTIL_DOWNSCALE_1_1;
+	decode->fd = -1;
+	*handle = decode;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_input_path(image_util_decode_h handle, const char *path){
+	char *copy;
+	if( handle == NULL || path == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	copy = _image_util_strdup(path);
+	if( copy == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+
+	_clear_decode_input(handle);
+	handle->path = copy;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_input_buffer(image_util_decode_h handle, const unsigned char *jpeg_buffer, unsigned int jpeg_size){
+	if( handle == NULL || jpeg_buffer == NULL || jpeg_size == 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_clear_decode_input(handle);
+	handle->buffer = jpeg_buffer;
+	handle->size = jpeg_size;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_input_callback(image_util_decode_h handle, image_util_decode_read_cb callback, void *user_data){
+	if( handle == NULL || callback == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_clear_decode_input(handle);
+	handle->read = callback;
+	handle->read_user_data = user_data;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_input_fd(image_util_decode_h handle, int fd){
+	if( handle == NULL || fd < 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_clear_decode_input(handle);
+	handle->fd = fd;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_file_access(image_util_decode_h handle, image_util_file_access_e access){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( access < IMAGE_UTIL_FILE_ACCESS_MAP || access > IMAGE_UTIL_FILE_ACCESS_READ )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->file_access = access;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_colorspace(image_util_decode_h handle, image_util_colorspace_e colorspace){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->colorspace = colorspace;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_crop_area(image_util_decode_h handle, int x, int y, int width, int height){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( x < 0 || y < 0 || width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->crop = true;
+	handle->crop_x = x;
+	handle->crop_y = y;
+	handle->crop_width = width;
+	handle->crop_height = height;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_jpeg_downscale(image_util_decode_h handle, image_util_scale_e downscale){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( downscale < IMAGE_UTIL_DOWNSCALE_1_1 || downscale > IMAGE_UTIL_DOWNSCALE_1_8 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->downscale = downscale;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_set_resolution(image_util_decode_h handle, int width, int height){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	handle->width = width;
+	handle->height = height;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_run(image_util_decode_h handle, unsigned char **image_buffer, int *width, int *height, unsigned int *size){
+	int ret;
+	if( handle == NULL || image_buffer == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_decode(handle, NULL, image_buffer, width, height, size);
+	_clear_read_once_input(handle);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_get_dest_resolution(image_util_decode_h handle, int *width, int *height, unsigned int *size){
+	int ret;
+	if( handle == NULL || (width == NULL && height == NULL && size == NULL) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	if( handle->read || handle->fd >= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_decode(handle, NULL, NULL, width, height, size);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_run_to_buffer(image_util_decode_h handle, unsigned char *buffer, unsigned int capacity, int *width, int *height, unsigned int *size){
+	image_util_decode_dest_s target = { NULL, buffer, capacity };
+	int ret;
+	if( handle == NULL || buffer == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_decode(handle, &target, NULL, width, height, size);
+	_clear_read_once_input(handle);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_run_ex(image_util_decode_h handle, image_util_planes_s *dest, int *width, int *height){
+	image_util_decode_dest_s target = { dest, NULL, 0 };
+	int ret;
+	if( handle == NULL || dest == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_jpeg_decode(handle, &target, NULL, width, height, NULL);
+	_clear_read_once_input(handle);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_run_to_image(image_util_decode_h handle, image_util_image_h *image){
+	image_util_decode_dest_s target = { NULL, NULL, 0 };
+	image_util_image_s *decoded;
+	int width, height, ret;
+	if( handle == NULL || image == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	/* the image is allocated before the decoding, from the size in the header */
+	if( handle->read || handle->fd >= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_decode(handle, NULL, NULL, &width, &height, NULL);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, ret);
+	ret = _image_util_image_create(width, height, handle->colorspace, &decoded);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, ret);
+
+	target.planes = &decoded->planes;
+	ret = _image_util_jpeg_decode(handle, &target, NULL, NULL, NULL, NULL);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_image_unref(decoded);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	*image = decoded;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_decode_start_stream(image_util_decode_h handle, image_util_decode_rows_cb callback, void *user_data){
+	int ret;
+	if( handle == NULL || callback == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->crop || handle->width > 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	_image_util_jpeg_stream_destroy(handle->stream);
+	handle->stream = NULL;
+	ret = _image_util_jpeg_stream_create(handle, callback, user_data, &handle->stream);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_push(image_util_decode_h handle, const unsigned char *data, unsigned int size){
+	int ret;
+	if( handle == NULL || data == NULL || size == 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->stream == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_stream_push(handle->stream, data, size);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_finish_stream(image_util_decode_h handle){
+	int ret;
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->stream == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_stream_finish(handle->stream);
+	_image_util_jpeg_stream_destroy(handle->stream);
+	handle->stream = NULL;
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_decode_destroy(image_util_decode_h handle){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_jpeg_stream_destroy(handle->stream);
+	_clear_decode_input(handle);
+	_image_util_free(handle);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_create(image_util_encode_h *handle){
+	image_util_encode_s *encode;
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	encode = _image_util_calloc(1, sizeof(image_util_encode_s));
+	if( encode == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+
+	encode->colorspace = IMAGE_UTIL_COLORSPACE_RGB888;
+	encode->quality = 75;
+	*handle = encode;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_set_resolution(image_util_encode_h handle, int width, int height){
+	if( handle == NULL || width <= 0 || height <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	handle->width = width;
+	handle->height = height;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_set_colorspace(image_util_encode_h handle, image_util_colorspace_e colorspace){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	handle->colorspace = colorspace;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_set_quality(image_util_encode_h handle, int quality){
+	if( handle == NULL || quality < 1 || quality > 100 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	handle->quality = quality;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_start_stream(image_util_encode_h handle, image_util_encode_output_cb callback, void *user_data){
+	int ret;
+	if( handle == NULL || callback == NULL || handle->width <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_encoder_create(handle, callback, user_data, &handle->encoder);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_encode_push_rows(image_util_encode_h handle, const image_util_planes_s *rows, int num_rows){
+	int ret;
+	if( handle == NULL || rows == NULL || num_rows <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_encoder_write(handle->encoder, rows, num_rows);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_encode_finish_stream(image_util_encode_h handle){
+	int ret;
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_encoder_finish(handle->encoder);
+	_image_util_jpeg_encoder_destroy(handle->encoder);
+	handle->encoder = NULL;
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_encode_get_max_size(image_util_encode_h handle, unsigned int *size){
+	if( handle == NULL || size == NULL || handle->width <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	*size = _image_util_jpeg_get_max_size(handle->width, handle->height);
+	if( *size == 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_run(image_util_encode_h handle, const image_util_planes_s *src, image_util_encode_output_cb callback, void *user_data){
+	int ret;
+	if( handle == NULL || src == NULL || callback == NULL || handle->width <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_encode(handle, src, callback, user_data);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_encode_run_to_buffer(image_util_encode_h handle, const image_util_planes_s *src, unsigned char *buffer, unsigned int capacity, unsigned int *size){
+	int ret;
+	if( handle == NULL || src == NULL || buffer == NULL || capacity == 0 || handle->width <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	ret = _image_util_jpeg_encode_to_buffer(handle, src, buffer, capacity, size);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_encode_destroy(image_util_encode_h handle){
+	if( handle == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_jpeg_encoder_destroy(handle->encoder);
+	_image_util_free(handle);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+/* colorspaces mm_util can not encode, which are fed to libjpeg without a conversion of the whole image */
+static bool _is_native_encode_colorspace(image_util_colorspace_e colorspace){
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_I420:
+		case IMAGE_UTIL_COLORSPACE_NV12:
+		case IMAGE_UTIL_COLORSPACE_UYVY:
+		case IMAGE_UTIL_COLORSPACE_YUYV:
+		case IMAGE_UTIL_COLORSPACE_RGB565:
+		case IMAGE_UTIL_COLORSPACE_ARGB8888:
+		case IMAGE_UTIL_COLORSPACE_BGRA8888:
+		case IMAGE_UTIL_COLORSPACE_RGBA8888:
+		case IMAGE_UTIL_COLORSPACE_BGRX8888:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static int _set_native_encode(image_util_encode_s *encode, image_util_planes_s *planes, const unsigned char *buffer, int width, int height, image_util_colorspace_e colorspace, int quality){
+	if( quality < 1 || quality > 100 || width <= 0 || height <= 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	/* these colorspaces were not supported with mm_util, odd sizes of the subsampled ones still are not */
+	if( !_image_util_is_native_size(width, height, colorspace) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+
+	memset(encode, 0, sizeof(image_util_encode_s));
+	encode->width = width;
+	encode->height = height;
+	encode->colorspace = colorspace;
+	encode->quality = quality;
+	return _image_util_get_packed_planes(colorspace, width, height, buffer, planes, NULL);
+}
+
 int image_util_encode_jpeg( const unsigned char *buffer, int width, int height, image_util_colorspace_e colorspace,  int quality, const char *path){
 	int ret;
+	image_util_encode_s encode;
+	image_util_planes_s planes;
 	if( path == NULL || buffer == NULL )
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _is_native_encode_colorspace(colorspace) ){
+		ret = _set_native_encode(&encode, &planes, buffer, width, height, colorspace, quality);
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = _image_util_jpeg_encode_to_file(&encode, &planes, path);
+		return _convert_image_util_error_code(__func__, ret);
+	}
 	if( _convert_encode_colorspace_tbl[colorspace] == -1 )
 		return _convert_image_util_error_code(__func__, MM_ERROR_IMAGE_NOT_SUPPORT_FORMAT);
 
@@ -271,17 +1169,186 @@ int image_util_encode_jpeg( const unsigned char *buffer, int width, int height,
 int image_util_encode_jpeg_to_memory( const unsigned char *image_buffer, int width, int height, image_util_colorspace_e colorspace, int quality,  unsigned char** jpeg_buffer, unsigned int *jpeg_size){
 	int ret;
 	int isize;
+	image_util_encode_s encode;
+	image_util_planes_s planes;
 	if( jpeg_buffer == NULL || image_buffer == NULL || jpeg_size == NULL )
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
 	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
 		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _is_native_encode_colorspace(colorspace) ){
+		ret = _set_native_encode(&encode, &planes, image_buffer, width, height, colorspace, quality);
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = _image_util_jpeg_encode_to_memory(&encode, &planes, jpeg_buffer, jpeg_size);
+		return _convert_image_util_error_code(__func__, ret);
+	}
 	if( _convert_encode_colorspace_tbl[colorspace] == -1 )
 		return _convert_image_util_error_code(__func__, MM_ERROR_IMAGE_NOT_SUPPORT_FORMAT);
 
 	ret = mm_util_jpeg_encode_to_memory( (void**)jpeg_buffer, &isize, image_buffer, width, height, _convert_encode_colorspace_tbl[colorspace] , quality );
-	if( ret == 0 )
+	if( ret == 0 ){
+		*jpeg_buffer = _image_util_adopt(*jpeg_buffer, isize);
+		if( *jpeg_buffer == NULL )
+			return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
 		*jpeg_size = isize;
+	}
 	
 	return _convert_image_util_error_code(__func__, ret);	
 }
 
+int image_util_decode_run_async(image_util_decode_h handle, image_util_completed_cb callback, void *user_data, image_util_request_h *request){
+	image_util_request_s *req;
+	int ret;
+	if( handle == NULL || request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_has_decode_input(handle) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	req = _image_util_request_create(IMAGE_UTIL_REQUEST_DECODE, callback, user_data);
+	if( req == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	req->decode = *handle;
+	req->decode.stream = NULL;
+	req->decode.path = handle->path ? _image_util_strdup(handle->path) : NULL;
+	if( handle->path && req->decode.path == NULL ){
+		_image_util_request_destroy(req);
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	}
+
+	ret = _image_util_request_submit(req);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_request_destroy(req);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	_clear_read_once_input(handle);
+	*request = req;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_encode_run_async(image_util_encode_h handle, const image_util_planes_s *src, image_util_completed_cb callback, void *user_data, image_util_request_h *request){
+	image_util_request_s *req;
+	int ret;
+	if( handle == NULL || src == NULL || request == NULL || handle->width <= 0 )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( handle->encoder )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_OPERATION);
+
+	req = _image_util_request_create(IMAGE_UTIL_REQUEST_ENCODE, callback, user_data);
+	if( req == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	req->encode = *handle;
+	req->src = *src;
+
+	ret = _image_util_request_submit(req);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_request_destroy(req);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	*request = req;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_convert_colorspace_async(image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, int width, int height, image_util_colorspace_e src_colorspace, image_util_completed_cb callback, void *user_data, image_util_request_h *request){
+	image_util_request_s *req;
+	int ret;
+	if( dest == NULL || src == NULL || request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( dest_colorspace < 0 || dest_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( src_colorspace < 0 || src_colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(src_colorspace, width, height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(dest_colorspace, width, height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	req = _image_util_request_create(IMAGE_UTIL_REQUEST_CONVERT, callback, user_data);
+	if( req == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	req->dest = *dest;
+	req->dest_colorspace = dest_colorspace;
+	req->src = *src;
+	req->src_colorspace = src_colorspace;
+	req->src_width = width;
+	req->src_height = height;
+
+	ret = _image_util_request_submit(req);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_request_destroy(req);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	*request = req;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_resize_async(image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_completed_cb callback, void *user_data, image_util_request_h *request){
+	image_util_request_s *req;
+	int ret;
+	if( dest == NULL || src == NULL || request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( colorspace < 0 || colorspace >= sizeof(_convert_colorspace_tbl)/sizeof(int))
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( _image_util_check_planes(colorspace, src_width, src_height, src) != IMAGE_UTIL_ERROR_NONE || _image_util_check_planes(colorspace, dest_width, dest_height, dest) != IMAGE_UTIL_ERROR_NONE )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+	if( !_image_util_resize_supported(colorspace, src_width, src_height, dest_width, dest_height) )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT);
+
+	req = _image_util_request_create(IMAGE_UTIL_REQUEST_RESIZE, callback, user_data);
+	if( req == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_OUT_OF_MEMORY);
+	req->dest = *dest;
+	req->dest_width = dest_width;
+	req->dest_height = dest_height;
+	req->src = *src;
+	req->src_colorspace = colorspace;
+	req->src_width = src_width;
+	req->src_height = src_height;
+
+	ret = _image_util_request_submit(req);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_request_destroy(req);
+		return _convert_image_util_error_code(__func__, ret);
+	}
+	*request = req;
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_request_get_fd(image_util_request_h request, int *fd){
+	int ret;
+	if( request == NULL || fd == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_request_get_fd(request, fd);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_request_wait(image_util_request_h request){
+	int ret;
+	if( request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_request_wait(request);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_request_cancel(image_util_request_h request){
+	if( request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_request_cancel(request);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
+
+int image_util_request_get_result(image_util_request_h request, unsigned char **buffer, int *width, int *height, unsigned int *size){
+	int ret;
+	if( request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	ret = _image_util_request_get_result(request, buffer, width, height, size);
+	return _convert_image_util_error_code(__func__, ret);
+}
+
+int image_util_request_destroy(image_util_request_h request){
+	if( request == NULL )
+		return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_INVALID_PARAMETER);
+
+	_image_util_request_destroy(request);
+	return _convert_image_util_error_code(__func__, IMAGE_UTIL_ERROR_NONE);
+}
@@ -0,0 +1,191 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+/*
+ * The allocator of the library.
+ *
+ * Every buffer, handle and scratch block the library allocates itself goes
+ * through the functions below, so an application can put image memory where
+ * it wants it. The allocator is only changed while the library holds no
+ * memory, so it is read without a lock. What is cached across calls, the
+ * image pool and the resize plans, is released before the switch with the
+ * allocator that made it.
+ *
+ * The buffers mm_util allocates on its own are copied into memory of the
+ * allocator before they are handed out when one is set. With malloc() they
+ * are handed out as they are, without the alignment below.
+ *
+ * Buffers handed out start on a cache line. With huge pages, the ones above
+ * a huge page are aligned to one, advised to the kernel for transparent huge
+ * pages and faulted in up front, so the kernels running over them later
+ * neither fault nor miss the TLB every 4 KiB.
+ */
+
+#define _HUGEPAGE_SIZE	((size_t)2 << 20)
+#define _PAGE_SIZE		4096
+
+static void *__default_alloc(size_t size, void *user_data)
+{
+	return malloc(size);
+}
+
+static void __default_free(void *data, void *user_data)
+{
+	free(data);
+}
+
+static void *__default_aligned_alloc(size_t alignment, size_t size, void *user_data)
+{
+	void *data;
+
+	if( posix_memalign(&data, alignment, size) != 0 )
+		return NULL;
+	return data;
+}
+
+static const image_util_allocator_s _default_allocator = {
+	.alloc = __default_alloc,
+	.free = __default_free,
+	.aligned_alloc = __default_aligned_alloc,
+};
+
+static image_util_allocator_s _allocator = {
+	.alloc = __default_alloc,
+	.free = __default_free,
+	.aligned_alloc = __default_aligned_alloc,
+};
+
+static pthread_mutex_t _allocator_lock = PTHREAD_MUTEX_INITIALIZER;
+static int _use_hugepages;
+
+
+int _image_util_set_allocator(const image_util_allocator_s *allocator)
+{
+	if( allocator && (allocator->alloc == NULL || allocator->free == NULL || allocator->aligned_alloc == NULL) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&_allocator_lock);
+	_image_util_pool_flush();
+	_image_util_resizer_flush();
+	_allocator = allocator ? *allocator : _default_allocator;
+	pthread_mutex_unlock(&_allocator_lock);
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+bool _image_util_is_default_allocator(void)
+{
+	return _allocator.alloc == __default_alloc;
+}
+
+void *_image_util_malloc(size_t size)
+{
+	return _allocator.alloc(size, _allocator.user_data);
+}
+
+void *_image_util_calloc(size_t count, size_t size)
+{
+	void *data;
+
+	if( size && count > (size_t)-1 / size )
+		return NULL;
+	data = _allocator.alloc(count * size, _allocator.user_data);
+	if( data )
+		memset(data, 0, count * size);
+	return data;
+}
+
+void *_image_util_aligned_alloc(size_t alignment, size_t size)
+{
+	return _allocator.aligned_alloc(alignment, size, _allocator.user_data);
+}
+
+void _image_util_free(void *data)
+{
+	if( data )
+		_allocator.free(data, _allocator.user_data);
+}
+
+char *_image_util_strdup(const char *str)
+{
+	size_t size = strlen(str) + 1;
+	char *copy = _image_util_malloc(size);
+
+	if( copy )
+		memcpy(copy, str, size);
+	return copy;
+}
+
+static void __prefault_hugepages(unsigned char *data, size_t size)
+{
+	size_t i;
+
+#ifdef MADV_HUGEPAGE
+	madvise(data, size, MADV_HUGEPAGE);
+#endif
+#ifdef MADV_POPULATE_WRITE
+	if( madvise(data, size, MADV_POPULATE_WRITE) == 0 )
+		return;
+#endif
+	for( i = 0 ; i < size ; i += _PAGE_SIZE )
+		((volatile unsigned char *)data)[i] = 0;
+}
+
+void _image_util_set_hugepages(bool enable)
+{
+	__atomic_store_n(&_use_hugepages, enable, __ATOMIC_RELAXED);
+}
+
+void *_image_util_output_alloc(size_t size)
+{
+	unsigned char *data;
+	size_t rounded;
+
+	if( size > _HUGEPAGE_SIZE && __atomic_load_n(&_use_hugepages, __ATOMIC_RELAXED) ){
+		rounded = (size + _HUGEPAGE_SIZE - 1) & ~(_HUGEPAGE_SIZE - 1);
+		data = _image_util_aligned_alloc(_HUGEPAGE_SIZE, rounded);
+		if( data ){
+			__prefault_hugepages(data, rounded);
+			return data;
+		}
+	}
+	return _image_util_aligned_alloc(IMAGE_UTIL_OUTPUT_ALIGN, size);
+}
+
+void *_image_util_adopt(void *data, size_t size)
+{
+	void *copy;
+
+	if( data == NULL || _image_util_is_default_allocator() )
+		return data;
+
+	copy = _image_util_output_alloc(size);
+	if( copy )
+		memcpy(copy, data, size);
+	else
+		LOGE("[%s] can not copy %zu bytes", __func__, size);
+	free(data);
+	return copy;
+}
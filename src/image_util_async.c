@@ -0,0 +1,311 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+/*
+ * Operations run in the background.
+ *
+ * Requests are queued to a couple of executor threads, apart from the pool
+ * of image_util_thread.c, so the bands of a running request still go to
+ * the pool. A request is referenced by its caller and by the executor, and
+ * is freed when both let it go.
+ *
+ * Cancellation is a flag of the request that the running operation polls
+ * between bands of rows through a thread local pointer to the request, so
+ * the code of the operations does not have to know about requests.
+ */
+
+#define _EXECUTOR_THREADS	2
+
+typedef enum
+{
+	_REQUEST_QUEUED,
+	_REQUEST_RUNNING,
+	_REQUEST_DONE,
+} _request_state_e;
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	pthread_t threads[_EXECUTOR_THREADS];
+	int num_threads;
+	bool shutdown;
+	image_util_request_s *head;
+	image_util_request_s *tail;
+} _executor_s;
+
+static _executor_s _executor = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.work_cond = PTHREAD_COND_INITIALIZER,
+	.done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* the request run by the executor thread, NULL on other threads */
+static __thread image_util_request_s *_current;
+
+
+/* must be called with the executor lock held */
+static void __release(image_util_request_s *request)
+{
+	if( --request->refs > 0 )
+		return;
+
+	if( request->fd >= 0 )
+		close(request->fd);
+	_image_util_free(request->decode.path);
+	_image_util_free(request->buffer);
+	_image_util_free(request);
+}
+
+/* must be called with the executor lock held */
+static void __signal_fd(image_util_request_s *request)
+{
+	uint64_t one = 1;
+
+	if( request->fd >= 0 && write(request->fd, &one, sizeof(one)) != sizeof(one) )
+		LOGE("[%s] can not signal the request", __func__);
+}
+
+static int __run(image_util_request_s *request)
+{
+	switch( request->type ){
+		case IMAGE_UTIL_REQUEST_DECODE:
+			return _image_util_jpeg_decode(&request->decode, NULL, &request->buffer, &request->width, &request->height, &request->size);
+		case IMAGE_UTIL_REQUEST_ENCODE:
+			request->width = request->encode.width;
+			request->height = request->encode.height;
+			return _image_util_jpeg_encode_to_memory(&request->encode, &request->src, &request->buffer, &request->size);
+		case IMAGE_UTIL_REQUEST_CONVERT:
+			request->width = request->src_width;
+			request->height = request->src_height;
+			return _image_util_convert(&request->dest, request->dest_colorspace, &request->src, request->src_colorspace, request->src_width, request->src_height);
+		case IMAGE_UTIL_REQUEST_RESIZE:
+			request->width = request->dest_width;
+			request->height = request->dest_height;
+			return _image_util_resize(&request->dest, request->dest_width, request->dest_height, &request->src, request->src_width, request->src_height, request->src_colorspace, IMAGE_UTIL_RESIZE_FILTER_BILINEAR);
+		default:
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	}
+}
+
+static void *__executor_main(void *arg)
+{
+	image_util_request_s *request;
+	image_util_completed_cb callback;
+	int ret;
+
+	pthread_mutex_lock(&_executor.lock);
+	while( !_executor.shutdown ){
+		request = _executor.head;
+		if( request == NULL ){
+			pthread_cond_wait(&_executor.work_cond, &_executor.lock);
+			continue;
+		}
+		_executor.head = request->next;
+		if( _executor.head == NULL )
+			_executor.tail = NULL;
+		request->state = _REQUEST_RUNNING;
+		pthread_mutex_unlock(&_executor.lock);
+
+		ret = IMAGE_UTIL_ERROR_CANCELED;
+		if( !__atomic_load_n(&request->canceled, __ATOMIC_RELAXED) ){
+			_current = request;
+			ret = __run(request);
+			_current = NULL;
+		}
+		if( ret != IMAGE_UTIL_ERROR_NONE ){
+			_image_util_free(request->buffer);
+			request->buffer = NULL;
+			request->size = 0;
+		}
+
+		pthread_mutex_lock(&_executor.lock);
+		request->error = ret;
+		request->state = _REQUEST_DONE;
+		__signal_fd(request);
+		pthread_cond_broadcast(&_executor.done_cond);
+		callback = request->detached ? NULL : request->callback;
+		pthread_mutex_unlock(&_executor.lock);
+
+		if( callback )
+			callback(request, ret, request->user_data);
+
+		pthread_mutex_lock(&_executor.lock);
+		__release(request);
+	}
+	pthread_mutex_unlock(&_executor.lock);
+
+	return NULL;
+}
+
+static void __attribute__((destructor)) __stop_executor(void)
+{
+	int i, num_threads;
+
+	pthread_mutex_lock(&_executor.lock);
+	_executor.shutdown = true;
+	num_threads = _executor.num_threads;
+	pthread_cond_broadcast(&_executor.work_cond);
+	pthread_mutex_unlock(&_executor.lock);
+
+	for( i = 0 ; i < num_threads ; i++ )
+		pthread_join(_executor.threads[i], NULL);
+}
+
+
+image_util_request_s *_image_util_request_create(image_util_request_type_e type, image_util_completed_cb callback, void *user_data)
+{
+	image_util_request_s *request = _image_util_calloc(1, sizeof(image_util_request_s));
+
+	if( request == NULL )
+		return NULL;
+
+	request->type = type;
+	request->callback = callback;
+	request->user_data = user_data;
+	request->decode.fd = -1;
+	request->fd = -1;
+	return request;
+}
+
+int _image_util_request_submit(image_util_request_s *request)
+{
+	pthread_mutex_lock(&_executor.lock);
+	while( _executor.num_threads < _EXECUTOR_THREADS ){
+		if( pthread_create(&_executor.threads[_executor.num_threads], NULL, __executor_main, NULL) != 0 ){
+			LOGE("[%s] failed to start executor thread %d", __func__, _executor.num_threads);
+			break;
+		}
+		_executor.num_threads++;
+	}
+	if( _executor.num_threads == 0 ){
+		pthread_mutex_unlock(&_executor.lock);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+
+	/* one reference for the caller, one for the executor */
+	request->refs = 2;
+	request->state = _REQUEST_QUEUED;
+	request->next = NULL;
+	if( _executor.tail )
+		_executor.tail->next = request;
+	else
+		_executor.head = request;
+	_executor.tail = request;
+	pthread_cond_signal(&_executor.work_cond);
+	pthread_mutex_unlock(&_executor.lock);
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_request_wait(image_util_request_s *request)
+{
+	int ret;
+
+	pthread_mutex_lock(&_executor.lock);
+	while( request->state != _REQUEST_DONE )
+		pthread_cond_wait(&_executor.done_cond, &_executor.lock);
+	ret = request->error;
+	pthread_mutex_unlock(&_executor.lock);
+
+	return ret;
+}
+
+void _image_util_request_cancel(image_util_request_s *request)
+{
+	pthread_mutex_lock(&_executor.lock);
+	if( request->state != _REQUEST_DONE )
+		__atomic_store_n(&request->canceled, 1, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&_executor.lock);
+}
+
+int _image_util_request_get_fd(image_util_request_s *request, int *fd)
+{
+	pthread_mutex_lock(&_executor.lock);
+	if( request->fd < 0 ){
+		request->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if( request->fd < 0 ){
+			pthread_mutex_unlock(&_executor.lock);
+			LOGE("[%s] can not create an eventfd", __func__);
+			return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+		}
+		if( request->state == _REQUEST_DONE )
+			__signal_fd(request);
+	}
+	*fd = request->fd;
+	pthread_mutex_unlock(&_executor.lock);
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_request_get_result(image_util_request_s *request, unsigned char **buffer, int *width, int *height, unsigned int *size)
+{
+	int ret;
+
+	pthread_mutex_lock(&_executor.lock);
+	ret = (request->state == _REQUEST_DONE) ? request->error : IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		if( buffer ){
+			*buffer = request->buffer;
+			request->buffer = NULL;
+		}
+		if( width )
+			*width = request->width;
+		if( height )
+			*height = request->height;
+		if( size )
+			*size = request->size;
+	}
+	pthread_mutex_unlock(&_executor.lock);
+
+	return ret;
+}
+
+void _image_util_request_destroy(image_util_request_s *request)
+{
+	pthread_mutex_lock(&_executor.lock);
+	if( request->refs == 0 ){
+		/* never submitted */
+		request->refs = 1;
+	}else if( request->state != _REQUEST_DONE ){
+		__atomic_store_n(&request->canceled, 1, __ATOMIC_RELAXED);
+		request->detached = true;
+	}
+	__release(request);
+	pthread_mutex_unlock(&_executor.lock);
+}
+
+bool _image_util_is_canceled(void)
+{
+	return _current && __atomic_load_n(&_current->canceled, __ATOMIC_RELAXED);
+}
+
+const int *_image_util_get_cancel_flag(void)
+{
+	return _current ? &_current->canceled : NULL;
+}
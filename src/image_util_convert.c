@@ -0,0 +1,752 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Every conversion runs on pairs of rows. The source rows are unpacked to
+ * either a YUV 4:2:2 row set (Y, U, V with half width chroma) or a 32bit RGB
+ * row, and the destination rows are packed from there. 4:2:0 chroma is
+ * replicated on unpack and averaged over the row pair on pack, so that any
+ * band of rows starting on an even row converts exactly like the whole image.
+ */
+
+typedef struct
+{
+	bool is_yuv;
+	int num_planes;
+	int h_shift[IMAGE_UTIL_MAX_PLANES];		/* log2 of pixels per plane element */
+	int v_shift[IMAGE_UTIL_MAX_PLANES];		/* log2 of image rows per plane row */
+	int bytes[IMAGE_UTIL_MAX_PLANES];		/* bytes per plane element */
+} _format_info_s;
+
+static const _format_info_s _format_info_tbl[] = {
+	{ true,  3, {0, 1, 1}, {0, 1, 1}, {1, 1, 1} },	/* IMAGE_UTIL_COLORSPACE_YV12 */
+	{ true,  3, {0, 1, 1}, {0, 0, 0}, {1, 1, 1} },	/* IMAGE_UTIL_COLORSPACE_YUV422 */
+	{ true,  3, {0, 1, 1}, {0, 1, 1}, {1, 1, 1} },	/* IMAGE_UTIL_COLORSPACE_I420 */
+	{ true,  2, {0, 1, 0}, {0, 1, 0}, {1, 2, 0} },	/* IMAGE_UTIL_COLORSPACE_NV12 */
+	{ true,  1, {1, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_UYVY */
+	{ true,  1, {1, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_YUYV */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {2, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_RGB565 */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {3, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_RGB888 */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_ARGB8888 */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_BGRA8888 */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_RGBA8888 */
+	{ false, 1, {0, 0, 0}, {0, 0, 0}, {4, 0, 0} },	/* IMAGE_UTIL_COLORSPACE_BGRX8888 */
+};
+
+static const image_util_rgb32_order_s _rgb32_order_tbl[] = {
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_YV12 */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_YUV422 */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_I420 */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_NV12 */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_UYVY */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_YUYV */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_RGB565 */
+	{ 0, 0, 0, 0 },	/* IMAGE_UTIL_COLORSPACE_RGB888 */
+	{ 1, 2, 3, 0 },	/* IMAGE_UTIL_COLORSPACE_ARGB8888 */
+	{ 2, 1, 0, 3 },	/* IMAGE_UTIL_COLORSPACE_BGRA8888 */
+	{ 0, 1, 2, 3 },	/* IMAGE_UTIL_COLORSPACE_RGBA8888 */
+	{ 2, 1, 0, 3 },	/* IMAGE_UTIL_COLORSPACE_BGRX8888 */
+};
+
+/* canonical order of the intermediate 32bit RGB rows */
+static const image_util_rgb32_order_s _rgba_order = { 0, 1, 2, 3 };
+
+#define _CLAMP_U8(v)	((v) < 0 ? 0 : ((v) > 255 ? 255 : (v)))
+#define _IS_RGB32(cs)	((cs) >= IMAGE_UTIL_COLORSPACE_ARGB8888 && (cs) <= IMAGE_UTIL_COLORSPACE_BGRX8888)
+
+typedef struct
+{
+	int width;
+	int cwidth;
+	unsigned char *y[2];
+	unsigned char *u[2];
+	unsigned char *v[2];
+	unsigned char *y_out[2];
+	unsigned char *u_out[2];
+	unsigned char *v_out[2];
+	unsigned char *rgb[2];
+	unsigned char *block;
+} _convert_ctx_s;
+
+
+void _image_util_yuv_to_rgb32_row_c(const unsigned char *y, const unsigned char *u, const unsigned char *v, unsigned char *dst, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+	for( x = 0 ; x < width ; x++ ){
+		int yy = (y[x] - 16) * 64;
+		int uu = u[x >> 1] - 128;
+		int vv = v[x >> 1] - 128;
+		int r, g, b;
+
+		yy += (yy * 5374) >> 15;		/* 1.164 in 6bit fixed point */
+		r = (yy + 102 * vv + 32) >> 6;
+		g = (yy - 25 * uu - 52 * vv + 32) >> 6;
+		b = (yy + 129 * uu + 32) >> 6;
+
+		dst[order->r] = _CLAMP_U8(r);
+		dst[order->g] = _CLAMP_U8(g);
+		dst[order->b] = _CLAMP_U8(b);
+		dst[order->a] = 0xff;
+		dst += 4;
+	}
+}
+
+void _image_util_rgb32_to_y_row_c(const unsigned char *src, unsigned char *y, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+	for( x = 0 ; x < width ; x++ ){
+		y[x] = (66 * src[order->r] + 129 * src[order->g] + 25 * src[order->b] + 0x1080) >> 8;
+		src += 4;
+	}
+}
+
+void _image_util_rgb32_to_uv_row_c(const unsigned char *src, unsigned char *u, unsigned char *v, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+	for( x = 0 ; x < width ; x += 2 ){
+		int r, g, b;
+		if( x + 1 < width ){
+			r = (src[order->r] + src[4 + order->r] + 1) >> 1;
+			g = (src[order->g] + src[4 + order->g] + 1) >> 1;
+			b = (src[order->b] + src[4 + order->b] + 1) >> 1;
+		}else{
+			r = src[order->r];
+			g = src[order->g];
+			b = src[order->b];
+		}
+		*u++ = (0x8080 - 38 * r - 74 * g + 112 * b) >> 8;
+		*v++ = (0x8080 + 112 * r - 94 * g - 18 * b) >> 8;
+		src += 8;
+	}
+}
+
+
+bool _image_util_colorspace_is_yuv(image_util_colorspace_e colorspace)
+{
+	return _format_info_tbl[colorspace].is_yuv;
+}
+
+/*
+ * Callers of the packed buffer API size their buffers with mm_util_get_image_size(),
+ * which only agrees with the layout used here when subsampled formats have even dimensions.
+ */
+bool _image_util_is_native_size(int width, int height, image_util_colorspace_e colorspace)
+{
+	const _format_info_s *info;
+	int i;
+
+	if( width <= 0 || height <= 0 || colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		return false;
+
+	info = &_format_info_tbl[colorspace];
+	for( i = 0 ; i < info->num_planes ; i++ ){
+		if( (info->h_shift[i] && (width & 1)) || (info->v_shift[i] && (height & 1)) )
+			return false;
+	}
+	return true;
+}
+
+int _image_util_get_num_planes(image_util_colorspace_e colorspace)
+{
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		return 0;
+	return _format_info_tbl[colorspace].num_planes;
+}
+
+/* plane size in elements (pixels, chroma samples or macro pixels) and rows */
+void _image_util_get_plane_geometry(image_util_colorspace_e colorspace, int plane, int width, int height, int *elements, int *rows, int *bytes)
+{
+	const _format_info_s *info = &_format_info_tbl[colorspace];
+
+	if( elements )
+		*elements = (width + (1 << info->h_shift[plane]) - 1) >> info->h_shift[plane];
+	if( rows )
+		*rows = (height + (1 << info->v_shift[plane]) - 1) >> info->v_shift[plane];
+	if( bytes )
+		*bytes = info->bytes[plane];
+}
+
+int _image_util_get_plane_layout(image_util_colorspace_e colorspace, int width, int height, int alignment, image_util_plane_layout_s *layout)
+{
+	const _format_info_s *info;
+	unsigned int offset = 0;
+	int i;
+
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM || width <= 0 || height <= 0 || layout == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( alignment <= 0 || (alignment & (alignment - 1)) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	memset(layout, 0, sizeof(image_util_plane_layout_s));
+	info = &_format_info_tbl[colorspace];
+	layout->num_planes = info->num_planes;
+	for( i = 0 ; i < info->num_planes ; i++ ){
+		int elements, rows;
+
+		_image_util_get_plane_geometry(colorspace, i, width, height, &elements, &rows, NULL);
+		offset = (offset + alignment - 1) & ~(alignment - 1);
+		layout->offset[i] = offset;
+		layout->stride[i] = (elements * info->bytes[i] + alignment - 1) & ~(alignment - 1);
+		layout->height[i] = rows;
+		offset += layout->stride[i] * rows;
+	}
+	layout->size = offset;
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_get_packed_planes(image_util_colorspace_e colorspace, int width, int height, const unsigned char *buffer, image_util_planes_s *planes, unsigned int *size)
+{
+	image_util_plane_layout_s layout;
+	int i, ret;
+
+	ret = _image_util_get_plane_layout(colorspace, width, height, 1, &layout);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	if( planes ){
+		for( i = 0 ; i < IMAGE_UTIL_MAX_PLANES ; i++ ){
+			planes->data[i] = (i < layout.num_planes && buffer) ? (unsigned char *)buffer + layout.offset[i] : NULL;
+			planes->stride[i] = layout.stride[i];
+		}
+	}
+	if( size )
+		*size = layout.size;
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* every plane of the colorspace needs a buffer with rows long enough for the width */
+int _image_util_check_planes(image_util_colorspace_e colorspace, int width, int height, const image_util_planes_s *planes)
+{
+	const _format_info_s *info;
+	int i;
+
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM || width <= 0 || height <= 0 || planes == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	info = &_format_info_tbl[colorspace];
+	for( i = 0 ; i < info->num_planes ; i++ ){
+		int elements;
+
+		_image_util_get_plane_geometry(colorspace, i, width, height, &elements, NULL, NULL);
+		if( planes->data[i] == NULL || planes->stride[i] < elements * info->bytes[i] )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* planes of the area starting at x, y; fails when x or y splits a chroma sample */
+int _image_util_get_crop_planes(image_util_colorspace_e colorspace, const image_util_planes_s *src, int x, int y, image_util_planes_s *view)
+{
+	const _format_info_s *info;
+	int i;
+
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM || src == NULL || view == NULL || x < 0 || y < 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	info = &_format_info_tbl[colorspace];
+	memset(view, 0, sizeof(image_util_planes_s));
+	for( i = 0 ; i < info->num_planes ; i++ ){
+		if( (x & ((1 << info->h_shift[i]) - 1)) || (y & ((1 << info->v_shift[i]) - 1)) )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		view->data[i] = src->data[i] + (y >> info->v_shift[i]) * src->stride[i] + (x >> info->h_shift[i]) * info->bytes[i];
+		view->stride[i] = src->stride[i];
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* a byte of a chroma element, half a sample right and or down of element ex of row ey */
+static int __get_shifted_chroma(const unsigned char *plane, int stride, int elements, int rows, int bytes, int ex, int ey, bool right, bool down, int c)
+{
+	int ex1 = (right && ex + 1 < elements) ? ex + 1 : ex;
+	int ey1 = (down && ey + 1 < rows) ? ey + 1 : ey;
+	const unsigned char *r0 = plane + ey * stride;
+	const unsigned char *r1 = plane + ey1 * stride;
+
+	return (r0[ex * bytes + c] + r0[ex1 * bytes + c] + r1[ex * bytes + c] + r1[ex1 * bytes + c] + 2) >> 2;
+}
+
+/*
+ * Copies the area at x, y when it splits chroma samples. Luma is copied, and
+ * chroma is interpolated half a sample over in the split direction, so that
+ * it stays centered on the pixels it belongs to.
+ */
+int _image_util_crop_resample(const image_util_planes_s *dest, image_util_colorspace_e colorspace, const image_util_planes_s *src, int src_width, int src_height, int x, int y, int width, int height)
+{
+	const _format_info_s *info;
+	int i, row, e, c;
+
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM || dest == NULL || src == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > src_width || y + height > src_height )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	info = &_format_info_tbl[colorspace];
+
+	if( colorspace == IMAGE_UTIL_COLORSPACE_UYVY || colorspace == IMAGE_UTIL_COLORSPACE_YUYV ){
+		/* byte offsets of the first luma and of the chroma in a macro pixel */
+		int luma = (colorspace == IMAGE_UTIL_COLORSPACE_UYVY) ? 1 : 0;
+		int chroma = 1 - luma;
+		int src_elements = (src_width + 1) >> 1;
+
+		for( row = 0 ; row < height ; row++ ){
+			const unsigned char *s = src->data[0] + (y + row) * src->stride[0];
+			unsigned char *d = dest->data[0] + row * dest->stride[0];
+
+			for( e = 0 ; e < (width + 1) >> 1 ; e++ ){
+				int px = x + 2 * e;
+				int m = px >> 1;
+				int m1 = (m + 1 < src_elements) ? m + 1 : m;
+
+				d[4 * e + luma] = s[4 * m + luma + 2 * (px & 1)];
+				d[4 * e + luma + 2] = (px + 1 < src_width) ? s[4 * ((px + 1) >> 1) + luma + 2 * ((px + 1) & 1)] : d[4 * e + luma];
+				if( px & 1 ){
+					d[4 * e + chroma] = (s[4 * m + chroma] + s[4 * m1 + chroma] + 1) >> 1;
+					d[4 * e + chroma + 2] = (s[4 * m + chroma + 2] + s[4 * m1 + chroma + 2] + 1) >> 1;
+				}else{
+					d[4 * e + chroma] = s[4 * m + chroma];
+					d[4 * e + chroma + 2] = s[4 * m + chroma + 2];
+				}
+			}
+		}
+		return IMAGE_UTIL_ERROR_NONE;
+	}
+
+	for( i = 0 ; i < info->num_planes ; i++ ){
+		bool right = info->h_shift[i] && (x & 1);
+		bool down = info->v_shift[i] && (y & 1);
+		int elements, rows, src_elements, src_rows, bytes = info->bytes[i];
+
+		_image_util_get_plane_geometry(colorspace, i, width, height, &elements, &rows, NULL);
+		_image_util_get_plane_geometry(colorspace, i, src_width, src_height, &src_elements, &src_rows, NULL);
+
+		for( row = 0 ; row < rows ; row++ ){
+			int ey = (y >> info->v_shift[i]) + row;
+			int ex = x >> info->h_shift[i];
+			unsigned char *d = dest->data[i] + row * dest->stride[i];
+
+			if( !right && !down ){
+				memcpy(d, src->data[i] + ey * src->stride[i] + ex * bytes, elements * bytes);
+				continue;
+			}
+			for( e = 0 ; e < elements ; e++ ){
+				for( c = 0 ; c < bytes ; c++ )
+					d[e * bytes + c] = __get_shifted_chroma(src->data[i], src->stride[i], src_elements, src_rows, bytes, ex + e, ey, right, down, c);
+			}
+		}
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/*
+ * Unpack stage
+ */
+static void __unpack_yuv_row(_convert_ctx_s *ctx, const image_util_planes_s *src, image_util_colorspace_e colorspace, int row, int idx)
+{
+	const unsigned char *s;
+	int x;
+
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+			ctx->y[idx] = src->data[0] + row * src->stride[0];
+			ctx->v[idx] = src->data[1] + (row >> 1) * src->stride[1];
+			ctx->u[idx] = src->data[2] + (row >> 1) * src->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_I420:
+			ctx->y[idx] = src->data[0] + row * src->stride[0];
+			ctx->u[idx] = src->data[1] + (row >> 1) * src->stride[1];
+			ctx->v[idx] = src->data[2] + (row >> 1) * src->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+			ctx->y[idx] = src->data[0] + row * src->stride[0];
+			ctx->u[idx] = src->data[1] + row * src->stride[1];
+			ctx->v[idx] = src->data[2] + row * src->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_NV12:
+			ctx->y[idx] = src->data[0] + row * src->stride[0];
+			if( idx == 1 ){
+				ctx->u[1] = ctx->u[0];
+				ctx->v[1] = ctx->v[0];
+				break;
+			}
+			s = src->data[1] + (row >> 1) * src->stride[1];
+			ctx->u[0] = ctx->u_out[0];
+			ctx->v[0] = ctx->v_out[0];
+			for( x = 0 ; x < ctx->cwidth ; x++ ){
+				ctx->u[0][x] = s[2 * x];
+				ctx->v[0][x] = s[2 * x + 1];
+			}
+			break;
+		case IMAGE_UTIL_COLORSPACE_UYVY:
+		case IMAGE_UTIL_COLORSPACE_YUYV:
+		{
+			int yo = (colorspace == IMAGE_UTIL_COLORSPACE_YUYV) ? 0 : 1;
+			int co = 1 - yo;
+			s = src->data[0] + row * src->stride[0];
+			ctx->y[idx] = ctx->y_out[idx];
+			ctx->u[idx] = ctx->u_out[idx];
+			ctx->v[idx] = ctx->v_out[idx];
+			for( x = 0 ; x < ctx->cwidth ; x++ ){
+				ctx->y[idx][2 * x] = s[4 * x + yo];
+				ctx->y[idx][2 * x + 1] = s[4 * x + yo + 2];
+				ctx->u[idx][x] = s[4 * x + co];
+				ctx->v[idx][x] = s[4 * x + co + 2];
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+static const unsigned char *__unpack_rgb_row(_convert_ctx_s *ctx, const image_util_planes_s *src, image_util_colorspace_e colorspace, int row, int idx, const image_util_rgb32_order_s **order)
+{
+	const unsigned char *s = src->data[0] + row * src->stride[0];
+	unsigned char *d = ctx->rgb[idx];
+	int x;
+
+	if( _IS_RGB32(colorspace) ){
+		*order = &_rgb32_order_tbl[colorspace];
+		return s;
+	}
+
+	*order = &_rgba_order;
+	if( colorspace == IMAGE_UTIL_COLORSPACE_RGB888 ){
+		for( x = 0 ; x < ctx->width ; x++ ){
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			d[3] = 0xff;
+			s += 3;
+			d += 4;
+		}
+	}else{
+		for( x = 0 ; x < ctx->width ; x++ ){
+			int p = s[0] | (s[1] << 8);
+			int r = (p >> 11) & 0x1f;
+			int g = (p >> 5) & 0x3f;
+			int b = p & 0x1f;
+			d[0] = (r << 3) | (r >> 2);
+			d[1] = (g << 2) | (g >> 4);
+			d[2] = (b << 3) | (b >> 2);
+			d[3] = 0xff;
+			s += 2;
+			d += 4;
+		}
+	}
+	return ctx->rgb[idx];
+}
+
+
+/*
+ * Pack stage
+ */
+static inline void __copy_row(unsigned char *dst, const unsigned char *src, int size)
+{
+	if( dst != src )
+		memcpy(dst, src, size);
+}
+
+static inline void __average_row(unsigned char *dst, const unsigned char *a, const unsigned char *b, int size)
+{
+	int x;
+	if( a == b ){
+		__copy_row(dst, a, size);
+		return;
+	}
+	for( x = 0 ; x < size ; x++ )
+		dst[x] = (a[x] + b[x] + 1) >> 1;
+}
+
+static void __pack_yuv_rows(_convert_ctx_s *ctx, const image_util_planes_s *dst, image_util_colorspace_e colorspace, int row, int rows)
+{
+	int i, x;
+	unsigned char *d;
+
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+		case IMAGE_UTIL_COLORSPACE_I420:
+		{
+			int up = (colorspace == IMAGE_UTIL_COLORSPACE_I420) ? 1 : 2;
+			int vp = 3 - up;
+			for( i = 0 ; i < rows ; i++ )
+				__copy_row(dst->data[0] + (row + i) * dst->stride[0], ctx->y[i], ctx->width);
+			__average_row(dst->data[up] + (row >> 1) * dst->stride[up], ctx->u[0], ctx->u[1], ctx->cwidth);
+			__average_row(dst->data[vp] + (row >> 1) * dst->stride[vp], ctx->v[0], ctx->v[1], ctx->cwidth);
+			break;
+		}
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+			for( i = 0 ; i < rows ; i++ ){
+				__copy_row(dst->data[0] + (row + i) * dst->stride[0], ctx->y[i], ctx->width);
+				__copy_row(dst->data[1] + (row + i) * dst->stride[1], ctx->u[i], ctx->cwidth);
+				__copy_row(dst->data[2] + (row + i) * dst->stride[2], ctx->v[i], ctx->cwidth);
+			}
+			break;
+		case IMAGE_UTIL_COLORSPACE_NV12:
+			for( i = 0 ; i < rows ; i++ )
+				__copy_row(dst->data[0] + (row + i) * dst->stride[0], ctx->y[i], ctx->width);
+			d = dst->data[1] + (row >> 1) * dst->stride[1];
+			for( x = 0 ; x < ctx->cwidth ; x++ ){
+				d[2 * x] = (ctx->u[0][x] + ctx->u[1][x] + 1) >> 1;
+				d[2 * x + 1] = (ctx->v[0][x] + ctx->v[1][x] + 1) >> 1;
+			}
+			break;
+		case IMAGE_UTIL_COLORSPACE_UYVY:
+		case IMAGE_UTIL_COLORSPACE_YUYV:
+		{
+			int yo = (colorspace == IMAGE_UTIL_COLORSPACE_YUYV) ? 0 : 1;
+			int co = 1 - yo;
+			for( i = 0 ; i < rows ; i++ ){
+				const unsigned char *y = ctx->y[i];
+				d = dst->data[0] + (row + i) * dst->stride[0];
+				for( x = 0 ; x < ctx->cwidth ; x++ ){
+					d[4 * x + yo] = y[2 * x];
+					d[4 * x + yo + 2] = (2 * x + 1 < ctx->width) ? y[2 * x + 1] : y[2 * x];
+					d[4 * x + co] = ctx->u[i][x];
+					d[4 * x + co + 2] = ctx->v[i][x];
+				}
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+static void __pack_rgb_row(_convert_ctx_s *ctx, unsigned char *d, image_util_colorspace_e colorspace, const unsigned char *s, const image_util_rgb32_order_s *so, bool src_alpha)
+{
+	int x;
+
+	if( _IS_RGB32(colorspace) ){
+		const image_util_rgb32_order_s *dor = &_rgb32_order_tbl[colorspace];
+		bool keep_alpha = src_alpha && colorspace != IMAGE_UTIL_COLORSPACE_BGRX8888;
+		for( x = 0 ; x < ctx->width ; x++ ){
+			d[dor->r] = s[so->r];
+			d[dor->g] = s[so->g];
+			d[dor->b] = s[so->b];
+			d[dor->a] = keep_alpha ? s[so->a] : 0xff;
+			s += 4;
+			d += 4;
+		}
+	}else if( colorspace == IMAGE_UTIL_COLORSPACE_RGB888 ){
+		for( x = 0 ; x < ctx->width ; x++ ){
+			d[0] = s[so->r];
+			d[1] = s[so->g];
+			d[2] = s[so->b];
+			s += 4;
+			d += 3;
+		}
+	}else{
+		for( x = 0 ; x < ctx->width ; x++ ){
+			int p = ((s[so->r] >> 3) << 11) | ((s[so->g] >> 2) << 5) | (s[so->b] >> 3);
+			d[0] = p & 0xff;
+			d[1] = p >> 8;
+			s += 4;
+			d += 2;
+		}
+	}
+}
+
+static unsigned char *__planar_y_row(const image_util_planes_s *dst, image_util_colorspace_e colorspace, int row)
+{
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+		case IMAGE_UTIL_COLORSPACE_I420:
+		case IMAGE_UTIL_COLORSPACE_NV12:
+			return dst->data[0] + row * dst->stride[0];
+		default:
+			return NULL;
+	}
+}
+
+
+static int __create_ctx(_convert_ctx_s *ctx, int width)
+{
+	int rgb_size = ((width * 4) + 63) & ~63;
+	int y_size = ((width + 1) + 63) & ~63;
+	int c_size = (((width + 1) >> 1) + 63) & ~63;
+	unsigned char *p;
+	int i;
+
+	ctx->width = width;
+	ctx->cwidth = (width + 1) >> 1;
+	ctx->block = _image_util_pool_alloc(2 * rgb_size + 2 * y_size + 4 * c_size);
+	if( ctx->block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	p = ctx->block;
+	for( i = 0 ; i < 2 ; i++ ){
+		ctx->rgb[i] = p;
+		p += rgb_size;
+		ctx->y_out[i] = p;
+		p += y_size;
+		ctx->u_out[i] = p;
+		p += c_size;
+		ctx->v_out[i] = p;
+		p += c_size;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_convert_rows(const image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, image_util_colorspace_e src_colorspace, int width, int height, int row_start, int row_end)
+{
+	const image_util_simd_ops_s *ops = _image_util_get_simd_ops();
+	const _format_info_s *dinfo, *sinfo;
+	bool src_alpha;
+	_convert_ctx_s ctx;
+	int row, i, ret;
+
+	if( dest == NULL || src == NULL || width <= 0 || height <= 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( dest_colorspace < 0 || dest_colorspace >= IMAGE_UTIL_COLORSPACE_NUM || src_colorspace < 0 || src_colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( row_start < 0 || (row_start & 1) || row_end > height || row_start >= row_end )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	dinfo = &_format_info_tbl[dest_colorspace];
+	sinfo = &_format_info_tbl[src_colorspace];
+
+	if( dest_colorspace == src_colorspace ){
+		for( i = 0 ; i < sinfo->num_planes ; i++ ){
+			int first = row_start >> sinfo->v_shift[i];
+			int last = (row_end + (1 << sinfo->v_shift[i]) - 1) >> sinfo->v_shift[i];
+			int size = ((width + (1 << sinfo->h_shift[i]) - 1) >> sinfo->h_shift[i]) * sinfo->bytes[i];
+			for( row = first ; row < last ; row++ )
+				__copy_row(dest->data[i] + row * dest->stride[i], src->data[i] + row * src->stride[i], size);
+		}
+		return IMAGE_UTIL_ERROR_NONE;
+	}
+
+	ret = __create_ctx(&ctx, width);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	src_alpha = (src_colorspace != IMAGE_UTIL_COLORSPACE_BGRX8888);
+
+	for( row = row_start ; row < row_end ; row += 2 ){
+		int rows = (row + 1 < height) ? 2 : 1;
+
+		if( sinfo->is_yuv ){
+			for( i = 0 ; i < rows ; i++ )
+				__unpack_yuv_row(&ctx, src, src_colorspace, row + i, i);
+			if( rows == 1 ){
+				ctx.y[1] = ctx.y[0];
+				ctx.u[1] = ctx.u[0];
+				ctx.v[1] = ctx.v[0];
+			}
+
+			if( dinfo->is_yuv ){
+				__pack_yuv_rows(&ctx, dest, dest_colorspace, row, rows);
+			}else{
+				for( i = 0 ; i < rows ; i++ ){
+					unsigned char *d = dest->data[0] + (row + i) * dest->stride[0];
+					if( _IS_RGB32(dest_colorspace) ){
+						ops->yuv_to_rgb32_row(ctx.y[i], ctx.u[i], ctx.v[i], d, width, &_rgb32_order_tbl[dest_colorspace]);
+					}else{
+						ops->yuv_to_rgb32_row(ctx.y[i], ctx.u[i], ctx.v[i], ctx.rgb[i], width, &_rgba_order);
+						__pack_rgb_row(&ctx, d, dest_colorspace, ctx.rgb[i], &_rgba_order, false);
+					}
+				}
+			}
+		}else{
+			for( i = 0 ; i < rows ; i++ ){
+				const image_util_rgb32_order_s *order;
+				const unsigned char *s = __unpack_rgb_row(&ctx, src, src_colorspace, row + i, i, &order);
+
+				if( dinfo->is_yuv ){
+					unsigned char *y = __planar_y_row(dest, dest_colorspace, row + i);
+					ctx.y[i] = y ? y : ctx.y_out[i];
+					ctx.u[i] = ctx.u_out[i];
+					ctx.v[i] = ctx.v_out[i];
+					ops->rgb32_to_y_row(s, ctx.y[i], width, order);
+					ops->rgb32_to_uv_row(s, ctx.u[i], ctx.v[i], width, order);
+				}else{
+					__pack_rgb_row(&ctx, dest->data[0] + (row + i) * dest->stride[0], dest_colorspace, s, order, src_alpha);
+				}
+			}
+
+			if( dinfo->is_yuv ){
+				if( rows == 1 ){
+					ctx.y[1] = ctx.y[0];
+					ctx.u[1] = ctx.u[0];
+					ctx.v[1] = ctx.v[0];
+				}
+				__pack_yuv_rows(&ctx, dest, dest_colorspace, row, rows);
+			}
+		}
+	}
+
+	_image_util_pool_free(ctx.block);
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+
+typedef struct
+{
+	const image_util_planes_s *dest;
+	image_util_colorspace_e dest_colorspace;
+	const image_util_planes_s *src;
+	image_util_colorspace_e src_colorspace;
+	int width;
+	int height;
+	int band;
+} _convert_job_s;
+
+static int __convert_band(void *data, int index)
+{
+	_convert_job_s *job = data;
+	int row_start = index * job->band;
+	int row_end = row_start + job->band;
+
+	if( row_end > job->height )
+		row_end = job->height;
+
+	return _image_util_convert_rows(job->dest, job->dest_colorspace, job->src, job->src_colorspace, job->width, job->height, row_start, row_end);
+}
+
+/*
+ * Converts the whole image in bands of rows. Bands start on even rows, so
+ * the result does not depend on the number of threads.
+ */
+int _image_util_convert(const image_util_planes_s *dest, image_util_colorspace_e dest_colorspace, const image_util_planes_s *src, image_util_colorspace_e src_colorspace, int width, int height)
+{
+	_convert_job_s job;
+
+	if( width <= 0 || height <= 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	job.dest = dest;
+	job.dest_colorspace = dest_colorspace;
+	job.src = src;
+	job.src_colorspace = src_colorspace;
+	job.width = width;
+	job.height = height;
+	job.band = _image_util_get_band_size(height, 2, 32768 / width);
+
+	return _image_util_parallel_for((height + job.band - 1) / job.band, __convert_band, &job);
+}
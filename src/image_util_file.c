@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Read-only file mappings.
+ *
+ * The pages of a mapped file are the ones of the page cache, so nothing is
+ * copied into the process, and processes decoding the same file share them.
+ * The file is read once from the start, which is told to the kernel for a
+ * larger read ahead. A file that can not be mapped, like a pipe or an empty
+ * file, is left to the caller to read the usual way.
+ */
+
+int _image_util_map_file(const char *path, bool populate, image_util_mapped_file_s *map)
+{
+	struct stat st;
+	int flags = MAP_PRIVATE;
+	void *data;
+	int fd;
+
+	memset(map, 0, sizeof(image_util_mapped_file_s));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if( fd < 0 )
+		return IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+
+	if( fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || (unsigned long long)st.st_size > UINT_MAX ){
+		close(fd);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+
+#ifdef MAP_POPULATE
+	if( populate )
+		flags |= MAP_POPULATE;
+#endif
+	data = mmap(NULL, st.st_size, PROT_READ, flags, fd, 0);
+	close(fd);
+	if( data == MAP_FAILED ){
+		LOGI("[%s] can not map %s, it is read instead", __func__, path);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+	madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	map->data = data;
+	map->size = st.st_size;
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+void _image_util_unmap_file(image_util_mapped_file_s *map)
+{
+	if( map->data )
+		munmap((void *)map->data, map->size);
+	map->data = NULL;
+	map->size = 0;
+}
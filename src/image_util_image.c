@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/*
+ * Reference counted images.
+ *
+ * An image is one block: the handle, then the planes. Released blocks are
+ * kept in free lists by size class, four classes per power of two, so that
+ * frames of the same size are reused without going to the allocator. The lists are
+ * bounded in depth and in total bytes, anything beyond is freed.
+ *
+ * The scratch rows of the conversions and of the resize come from the same
+ * pool, behind the same header, so a loop over frames of one size does not
+ * allocate once it has run a few times.
+ */
+
+#define _IMAGE_ALIGN			IMAGE_UTIL_OUTPUT_ALIGN
+#define _POOL_MIN_SHIFT			12		/* 4 KiB, the smallest class */
+#define _POOL_MAX_SHIFT			30		/* larger blocks are not pooled */
+#define _POOL_CLASSES_PER_SHIFT	4
+#define _POOL_NUM_CLASSES		((_POOL_MAX_SHIFT - _POOL_MIN_SHIFT) * _POOL_CLASSES_PER_SHIFT + 1)
+#define _POOL_DEPTH				8		/* free blocks kept per class, a few per thread */
+#define _POOL_MAX_BYTES			(64u << 20)
+
+/* the planes start at the first aligned offset after the handle */
+#define _IMAGE_HEADER_SIZE		((sizeof(image_util_image_s) + _IMAGE_ALIGN - 1) & ~(size_t)(_IMAGE_ALIGN - 1))
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	image_util_image_s *free[_POOL_NUM_CLASSES];
+	int count[_POOL_NUM_CLASSES];
+	size_t bytes;
+} _image_pool_s;
+
+static _image_pool_s _pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+/* the class of a block of at least size bytes, -1 when it is not pooled */
+static int __get_class(size_t size, size_t *class_size)
+{
+	size_t base, step;
+	int shift, k;
+
+	if( size <= ((size_t)1 << _POOL_MIN_SHIFT) ){
+		*class_size = (size_t)1 << _POOL_MIN_SHIFT;
+		return 0;
+	}
+	if( size > ((size_t)1 << _POOL_MAX_SHIFT) ){
+		*class_size = size;
+		return -1;
+	}
+
+	for( shift = _POOL_MIN_SHIFT ; ((size_t)1 << (shift + 1)) < size ; shift++ )
+		;
+	base = (size_t)1 << shift;
+	step = base / _POOL_CLASSES_PER_SHIFT;
+	k = (size - base + step - 1) / step;
+	*class_size = base + k * step;
+	return (shift - _POOL_MIN_SHIFT) * _POOL_CLASSES_PER_SHIFT + k;
+}
+
+static image_util_image_s *__block_get(size_t size)
+{
+	image_util_image_s *image = NULL;
+	size_t class_size;
+	int pool_class = __get_class(size, &class_size);
+
+	if( pool_class >= 0 ){
+		pthread_mutex_lock(&_pool.lock);
+		image = _pool.free[pool_class];
+		if( image ){
+			_pool.free[pool_class] = image->next;
+			_pool.count[pool_class]--;
+			_pool.bytes -= class_size;
+		}
+		pthread_mutex_unlock(&_pool.lock);
+		if( image )
+			return image;
+	}
+
+	image = _image_util_output_alloc(class_size);
+	if( image == NULL )
+		return NULL;
+	image->pool_class = pool_class;
+	image->capacity = class_size;
+	return image;
+}
+
+static void __block_put(image_util_image_s *image)
+{
+	int pool_class = image->pool_class;
+
+	if( pool_class >= 0 ){
+		pthread_mutex_lock(&_pool.lock);
+		if( _pool.count[pool_class] < _POOL_DEPTH && _pool.bytes + image->capacity <= _POOL_MAX_BYTES ){
+			image->next = _pool.free[pool_class];
+			_pool.free[pool_class] = image;
+			_pool.count[pool_class]++;
+			_pool.bytes += image->capacity;
+			image = NULL;
+		}
+		pthread_mutex_unlock(&_pool.lock);
+	}
+	_image_util_free(image);
+}
+
+static void __attribute__((destructor)) __free_pool(void)
+{
+	_image_util_pool_flush();
+}
+
+
+int _image_util_image_create(int width, int height, image_util_colorspace_e colorspace, image_util_image_s **image)
+{
+	image_util_plane_layout_s layout;
+	image_util_image_s *block;
+	int i, ret;
+
+	ret = _image_util_get_plane_layout(colorspace, width, height, _IMAGE_ALIGN, &layout);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	block = __block_get(_IMAGE_HEADER_SIZE + layout.size);
+	if( block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	block->refs = 1;
+	block->width = width;
+	block->height = height;
+	block->colorspace = colorspace;
+	block->size = layout.size;
+	block->next = NULL;
+	memset(&block->planes, 0, sizeof(image_util_planes_s));
+	for( i = 0 ; i < layout.num_planes ; i++ ){
+		block->planes.data[i] = (unsigned char *)block + _IMAGE_HEADER_SIZE + layout.offset[i];
+		block->planes.stride[i] = layout.stride[i];
+	}
+
+	*image = block;
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+void _image_util_image_ref(image_util_image_s *image)
+{
+	__atomic_add_fetch(&image->refs, 1, __ATOMIC_RELAXED);
+}
+
+void _image_util_image_unref(image_util_image_s *image)
+{
+	if( __atomic_sub_fetch(&image->refs, 1, __ATOMIC_ACQ_REL) == 0 )
+		__block_put(image);
+}
+
+void *_image_util_pool_alloc(unsigned int size)
+{
+	image_util_image_s *block = __block_get(_IMAGE_HEADER_SIZE + size);
+
+	return block ? (unsigned char *)block + _IMAGE_HEADER_SIZE : NULL;
+}
+
+void _image_util_pool_free(void *data)
+{
+	if( data )
+		__block_put((image_util_image_s *)((unsigned char *)data - _IMAGE_HEADER_SIZE));
+}
+
+void _image_util_pool_flush(void)
+{
+	image_util_image_s *image;
+	int i;
+
+	pthread_mutex_lock(&_pool.lock);
+	for( i = 0 ; i < _POOL_NUM_CLASSES ; i++ ){
+		while( (image = _pool.free[i]) != NULL ){
+			_pool.free[i] = image->next;
+			_image_util_free(image);
+		}
+		_pool.count[i] = 0;
+	}
+	_pool.bytes = 0;
+	pthread_mutex_unlock(&_pool.lock);
+}
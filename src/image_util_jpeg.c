@@ -0,0 +1,1584 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <jerror.h>
+
+/*
+ * JPEG decoding and encoding with libjpeg.
+ *
+ * Rows are decoded as RGB in strips and converted into the requested
+ * colorspace by the conversion engine, so only the result is allocated at
+ * full size. A smaller image is decoded in the DCT domain at 1/2, 1/4 or 1/8
+ * of the size, which skips most of the IDCT and color conversion work. A
+ * resolution in between is reached by decoding the smallest scale that is
+ * not smaller than it and resizing that.
+ *
+ * A crop area is decoded from the iMCU rows and columns that cover it only,
+ * the rows above it are skipped without the IDCT and the rows below it are
+ * not read at all.
+ *
+ * A callback or a descriptor is read through a buffer of _JPEG_INPUT_BYTES,
+ * so the compressed image is never held as a whole either.
+ */
+
+#define _JPEG_STRIP_ROWS	16
+#define _JPEG_CROP_MARGIN	2
+#define _JPEG_INPUT_BYTES	4096
+#define _JPEG_CANCEL_ROWS	64		/* rows encoded between checks for cancellation */
+
+typedef struct
+{
+	struct jpeg_error_mgr pub;
+	jmp_buf jump;
+} _jpeg_error_mgr_s;
+
+typedef struct
+{
+	struct jpeg_decompress_struct cinfo;
+	_jpeg_error_mgr_s err;
+	FILE *fp;
+	image_util_mapped_file_s map;
+	struct jpeg_source_mgr src;		/* for a callback or a descriptor */
+	image_util_decode_read_cb read;
+	void *read_user_data;
+	int fd;
+	unsigned char input[_JPEG_INPUT_BYTES];
+	int x;					/* area to decode at the decoded scale */
+	int y;
+	int width;
+	int height;
+	int skip;				/* pixels decoded before the area in each row */
+	unsigned char *strip;	/* RGB rows before conversion */
+	unsigned char *scaled;	/* RGB image before resize */
+	unsigned char *image;	/* the result */
+} _jpeg_decoder_s;
+
+
+static void __error_exit(j_common_ptr cinfo)
+{
+	_jpeg_error_mgr_s *err = (_jpeg_error_mgr_s *)cinfo->err;
+
+	(*cinfo->err->output_message)(cinfo);
+	longjmp(err->jump, 1);
+}
+
+static void __output_message(j_common_ptr cinfo)
+{
+	char buffer[JMSG_LENGTH_MAX];
+
+	(*cinfo->err->format_message)(cinfo, buffer);
+	LOGE("[%s] %s", __func__, buffer);
+}
+
+/* the smallest scale whose size is not smaller than the requested resolution */
+static int __get_scale_denom(const image_util_decode_s *decode, int image_width, int image_height)
+{
+	int denom;
+
+	if( decode->width <= 0 || decode->height <= 0 )
+		return 1 << decode->downscale;
+
+	for( denom = 8 ; denom > 1 ; denom >>= 1 ){
+		if( (image_width + denom - 1) / denom >= decode->width && (image_height + denom - 1) / denom >= decode->height )
+			break;
+	}
+	return denom;
+}
+
+/* colorspaces libjpeg reads and writes directly, without a conversion of the rows */
+static bool __get_direct_color_space(image_util_colorspace_e colorspace, J_COLOR_SPACE *color_space)
+{
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_RGB888:
+			*color_space = JCS_RGB;
+			return true;
+#ifdef JCS_EXTENSIONS
+		case IMAGE_UTIL_COLORSPACE_ARGB8888:
+			*color_space = JCS_EXT_ARGB;
+			return true;
+		case IMAGE_UTIL_COLORSPACE_BGRA8888:
+			*color_space = JCS_EXT_BGRA;
+			return true;
+		case IMAGE_UTIL_COLORSPACE_RGBA8888:
+			*color_space = JCS_EXT_RGBA;
+			return true;
+		case IMAGE_UTIL_COLORSPACE_BGRX8888:
+			*color_space = JCS_EXT_BGRX;
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+/* subsampled colorspaces drop the last odd column or row */
+static bool __get_native_size(image_util_colorspace_e colorspace, int *width, int *height)
+{
+	if( !_image_util_is_native_size(*width, 2, colorspace) )
+		*width &= ~1;
+	if( !_image_util_is_native_size(2, *height, colorspace) )
+		*height &= ~1;
+	return _image_util_is_native_size(*width, *height, colorspace);
+}
+
+static int __read_rows(struct jpeg_decompress_struct *cinfo, unsigned char *data, int stride, int rows)
+{
+	JSAMPROW row_pointers[_JPEG_STRIP_ROWS];
+	int done = 0, i, n;
+
+	while( done < rows ){
+		if( _image_util_is_canceled() )
+			return IMAGE_UTIL_ERROR_CANCELED;
+		n = (rows - done < _JPEG_STRIP_ROWS) ? rows - done : _JPEG_STRIP_ROWS;
+		for( i = 0 ; i < n ; i++ )
+			row_pointers[i] = data + (done + i) * stride;
+		done += jpeg_read_scanlines(cinfo, row_pointers, n);
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* moves to the first row and column of the area, the decoded rows start dec->skip pixels before it */
+static int __seek_area(_jpeg_decoder_s *dec)
+{
+	struct jpeg_decompress_struct *cinfo = &dec->cinfo;
+#ifdef HAVE_JPEG_CROP_SCANLINE
+	JDIMENSION x, end;
+
+	/*
+	 * Only the iMCU columns covering the area are entropy decoded and
+	 * transformed. libjpeg upsamples chroma at the cropped edges as at the
+	 * image edges, so a margin of one chroma sample keeps the pixels the same
+	 * as those of the whole image.
+	 */
+	if( dec->x > 0 || dec->width < cinfo->output_width ){
+		x = (dec->x > _JPEG_CROP_MARGIN) ? dec->x - _JPEG_CROP_MARGIN : 0;
+		end = dec->x + dec->width + _JPEG_CROP_MARGIN;
+		if( end > cinfo->output_width )
+			end = cinfo->output_width;
+		end -= x;
+		jpeg_crop_scanline(cinfo, &x, &end);
+		dec->skip = dec->x - x;
+	}
+	if( dec->y > 0 )
+		jpeg_skip_scanlines(cinfo, dec->y);
+#else
+	unsigned char *row;
+
+	dec->skip = dec->x;
+	if( dec->y > 0 ){
+		row = _image_util_malloc(cinfo->output_width * cinfo->output_components);
+		if( row == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		while( cinfo->output_scanline < dec->y )
+			jpeg_read_scanlines(cinfo, &row, 1);
+		_image_util_free(row);
+	}
+#endif
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __decode_rows(_jpeg_decoder_s *dec, const image_util_planes_s *dest, image_util_colorspace_e colorspace, int width, int height)
+{
+	struct jpeg_decompress_struct *cinfo = &dec->cinfo;
+	image_util_colorspace_e strip_colorspace = (cinfo->out_color_space == JCS_RGB) ? IMAGE_UTIL_COLORSPACE_RGB888 : colorspace;
+	image_util_planes_s strip, view;
+	int stride = cinfo->output_width * cinfo->output_components;
+	int row, rows, ret;
+
+	if( strip_colorspace == colorspace && dec->skip == 0 && width == cinfo->output_width )
+		return __read_rows(cinfo, dest->data[0], dest->stride[0], height);
+
+	dec->strip = _image_util_malloc(stride * _JPEG_STRIP_ROWS);
+	if( dec->strip == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	memset(&strip, 0, sizeof(image_util_planes_s));
+	strip.data[0] = dec->strip + dec->skip * cinfo->output_components;
+	strip.stride[0] = stride;
+
+	/* strips are even, so chroma rows are never split */
+	for( row = 0 ; row < height ; row += rows ){
+		rows = (height - row < _JPEG_STRIP_ROWS) ? height - row : _JPEG_STRIP_ROWS;
+		ret = __read_rows(cinfo, dec->strip, stride, rows);
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = _image_util_get_crop_planes(colorspace, dest, 0, row, &view);
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = _image_util_convert_rows(&view, colorspace, &strip, strip_colorspace, width, rows, 0, rows);
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			return ret;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __decode_resized(_jpeg_decoder_s *dec, const image_util_planes_s *dest, image_util_colorspace_e colorspace, int width, int height)
+{
+	struct jpeg_decompress_struct *cinfo = &dec->cinfo;
+	image_util_transform_s transform;
+	image_util_planes_s scaled;
+	int stride = cinfo->output_width * 3;
+	int ret;
+
+	dec->scaled = _image_util_malloc(stride * dec->height);
+	if( dec->scaled == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	ret = __read_rows(cinfo, dec->scaled, stride, dec->height);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	memset(&scaled, 0, sizeof(image_util_planes_s));
+	scaled.data[0] = dec->scaled + dec->skip * 3;
+	scaled.stride[0] = stride;
+
+	memset(&transform, 0, sizeof(image_util_transform_s));
+	transform.resize = true;
+	transform.width = width;
+	transform.height = height;
+	transform.convert = true;
+	transform.colorspace = colorspace;
+	ret = _image_util_transform_run(&transform, dest, &scaled, dec->width, dec->height, IMAGE_UTIL_COLORSPACE_RGB888);
+	_image_util_transform_reset_plan(&transform);
+
+	return ret;
+}
+
+static int __decode(_jpeg_decoder_s *dec, const image_util_decode_s *decode, const image_util_decode_dest_s *target, unsigned char **image_buffer, int *width, int *height, unsigned int *size)
+{
+	struct jpeg_decompress_struct *cinfo = &dec->cinfo;
+	image_util_colorspace_e colorspace = decode->colorspace;
+	image_util_plane_layout_s layout;
+	image_util_planes_s dest;
+	int dest_width, dest_height;
+	int denom;
+	bool resize;
+	int ret;
+
+	if( cinfo->jpeg_color_space != JCS_GRAYSCALE && cinfo->jpeg_color_space != JCS_YCbCr && cinfo->jpeg_color_space != JCS_RGB ){
+		LOGE("[%s] jpeg color space %d is not supported", __func__, cinfo->jpeg_color_space);
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	}
+	if( decode->crop ){
+		/* the setter keeps the area positive, so the casts keep its values */
+		if( (JDIMENSION)decode->crop_x >= cinfo->image_width || (JDIMENSION)decode->crop_width > cinfo->image_width - decode->crop_x )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		if( (JDIMENSION)decode->crop_y >= cinfo->image_height || (JDIMENSION)decode->crop_height > cinfo->image_height - decode->crop_y )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	}
+
+	if( decode->crop )
+		denom = __get_scale_denom(decode, decode->crop_width, decode->crop_height);
+	else
+		denom = __get_scale_denom(decode, cinfo->image_width, cinfo->image_height);
+	cinfo->scale_num = 1;
+	cinfo->scale_denom = denom;
+	cinfo->out_color_space = JCS_RGB;
+	jpeg_calc_output_dimensions(cinfo);
+
+	/* the area at the decoded scale, widened to whole pixels */
+	if( decode->crop ){
+		dec->x = decode->crop_x / denom;
+		dec->y = decode->crop_y / denom;
+		dec->width = (decode->crop_x + decode->crop_width + denom - 1) / denom - dec->x;
+		dec->height = (decode->crop_y + decode->crop_height + denom - 1) / denom - dec->y;
+	}else{
+		dec->width = cinfo->output_width;
+		dec->height = cinfo->output_height;
+	}
+
+	if( decode->width > 0 && decode->height > 0 ){
+		dest_width = decode->width;
+		dest_height = decode->height;
+		if( !_image_util_is_native_size(dest_width, dest_height, colorspace) )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	}else{
+		dest_width = dec->width;
+		dest_height = dec->height;
+		if( !__get_native_size(colorspace, &dest_width, &dest_height) )
+			return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	}
+	resize = (decode->width > 0 && decode->height > 0) && (dest_width != dec->width || dest_height != dec->height);
+
+	if( !resize )
+		__get_direct_color_space(colorspace, &cinfo->out_color_space);
+
+	_image_util_get_plane_layout(colorspace, dest_width, dest_height, 1, &layout);
+	if( width )
+		*width = dest_width;
+	if( height )
+		*height = dest_height;
+	if( size )
+		*size = layout.size;
+
+	if( target == NULL && image_buffer == NULL )
+		return IMAGE_UTIL_ERROR_NONE;
+	if( target && target->planes ){
+		if( _image_util_check_planes(colorspace, dest_width, dest_height, target->planes) != IMAGE_UTIL_ERROR_NONE )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		dest = *target->planes;
+	}else if( target ){
+		if( target->buffer == NULL || target->capacity < layout.size ){
+			LOGE("[%s] the image needs %u bytes, the buffer has %u", __func__, layout.size, target->capacity);
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		}
+		_image_util_get_packed_planes(colorspace, dest_width, dest_height, target->buffer, &dest, NULL);
+	}else{
+		dec->image = _image_util_output_alloc(layout.size);
+		if( dec->image == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		_image_util_get_packed_planes(colorspace, dest_width, dest_height, dec->image, &dest, NULL);
+	}
+
+	jpeg_start_decompress(cinfo);
+	ret = __seek_area(dec);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	if( resize )
+		ret = __decode_resized(dec, &dest, colorspace, dest_width, dest_height);
+	else
+		ret = __decode_rows(dec, &dest, colorspace, dest_width, dest_height);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	if( cinfo->output_scanline < cinfo->output_height )
+		jpeg_abort_decompress(cinfo);
+	else
+		jpeg_finish_decompress(cinfo);
+
+	if( image_buffer && target == NULL ){
+		*image_buffer = dec->image;
+		dec->image = NULL;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __read_fd(unsigned char *buffer, unsigned int size, void *user_data)
+{
+	int fd = *(int *)user_data;
+	ssize_t n;
+
+	do{
+		n = read(fd, buffer, size);
+	}while( n < 0 && errno == EINTR );
+	return (int)n;
+}
+
+static void __read_init_source(j_decompress_ptr cinfo)
+{
+}
+
+static boolean __read_fill_input_buffer(j_decompress_ptr cinfo)
+{
+	_jpeg_decoder_s *dec = (_jpeg_decoder_s *)cinfo;
+	int n = dec->read(dec->input, sizeof(dec->input), dec->read_user_data);
+
+	if( n < 0 || n > (int)sizeof(dec->input) )
+		ERREXIT(cinfo, JERR_FILE_READ);
+	if( n == 0 ){
+		/* a truncated image ends with a fake EOI, as the stdio source does */
+		WARNMS(cinfo, JWRN_JPEG_EOF);
+		dec->input[0] = 0xFF;
+		dec->input[1] = JPEG_EOI;
+		n = 2;
+	}
+	dec->src.next_input_byte = dec->input;
+	dec->src.bytes_in_buffer = n;
+	return TRUE;
+}
+
+static void __read_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+	struct jpeg_source_mgr *src = cinfo->src;
+
+	if( num_bytes <= 0 )
+		return;
+	while( num_bytes > (long)src->bytes_in_buffer ){
+		num_bytes -= src->bytes_in_buffer;
+		__read_fill_input_buffer(cinfo);
+	}
+	src->next_input_byte += num_bytes;
+	src->bytes_in_buffer -= num_bytes;
+}
+
+static void __read_term_source(j_decompress_ptr cinfo)
+{
+}
+
+/* runs the libjpeg calls, which return here on an error */
+static int __decode_protected(_jpeg_decoder_s *dec, const image_util_decode_s *decode, const image_util_decode_dest_s *target, unsigned char **image_buffer, int *width, int *height, unsigned int *size)
+{
+	dec->cinfo.err = jpeg_std_error(&dec->err.pub);
+	dec->err.pub.error_exit = __error_exit;
+	dec->err.pub.output_message = __output_message;
+	if( setjmp(dec->err.jump) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	jpeg_create_decompress(&dec->cinfo);
+	if( dec->map.data )
+		jpeg_mem_src(&dec->cinfo, (unsigned char *)dec->map.data, dec->map.size);
+	else if( dec->fp )
+		jpeg_stdio_src(&dec->cinfo, dec->fp);
+	else if( dec->read )
+		dec->cinfo.src = &dec->src;
+	else
+		jpeg_mem_src(&dec->cinfo, (unsigned char *)decode->buffer, decode->size);
+	jpeg_read_header(&dec->cinfo, TRUE);
+
+	return __decode(dec, decode, target, image_buffer, width, height, size);
+}
+
+/*
+ * Decodes into the planes or the buffer of target, or into an allocated
+ * image returned in image_buffer. With neither only the header is read for
+ * the size of the result.
+ */
+int _image_util_jpeg_decode(const image_util_decode_s *decode, const image_util_decode_dest_s *target, unsigned char **image_buffer, int *width, int *height, unsigned int *size)
+{
+	_jpeg_decoder_s *dec;
+	int ret;
+
+	if( decode == NULL || (decode->path == NULL && decode->buffer == NULL && decode->read == NULL && decode->fd < 0) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	dec = _image_util_calloc(1, sizeof(_jpeg_decoder_s));
+	if( dec == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	if( decode->read || decode->fd >= 0 ){
+		dec->fd = decode->fd;
+		dec->read = decode->read ? decode->read : __read_fd;
+		dec->read_user_data = decode->read ? decode->read_user_data : &dec->fd;
+		dec->src.init_source = __read_init_source;
+		dec->src.fill_input_buffer = __read_fill_input_buffer;
+		dec->src.skip_input_data = __read_skip_input_data;
+		dec->src.resync_to_restart = jpeg_resync_to_restart;
+		dec->src.term_source = __read_term_source;
+	}else if( decode->path ){
+		/* a file that can not be mapped is read through stdio */
+		if( decode->file_access != IMAGE_UTIL_FILE_ACCESS_READ )
+			_image_util_map_file(decode->path, decode->file_access == IMAGE_UTIL_FILE_ACCESS_MAP_POPULATE, &dec->map);
+		if( dec->map.data == NULL )
+			dec->fp = fopen(decode->path, "rb");
+		if( dec->map.data == NULL && dec->fp == NULL ){
+			LOGE("[%s] can not open %s", __func__, decode->path);
+			_image_util_free(dec);
+			return IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+		}
+	}
+
+	ret = __decode_protected(dec, decode, target, image_buffer, width, height, size);
+
+	jpeg_destroy_decompress(&dec->cinfo);
+	if( dec->fp )
+		fclose(dec->fp);
+	_image_util_unmap_file(&dec->map);
+	_image_util_free(dec->strip);
+	_image_util_free(dec->scaled);
+	_image_util_free(dec->image);
+	_image_util_free(dec);
+
+	return ret;
+}
+
+/*
+ * Batch decoding. Each image is one item of a parallel job, so a thread
+ * takes the next image whenever it is done with one and images of any size
+ * keep all threads busy. The decoding of an image runs on its thread alone.
+ * The batch holds the pool until its last image is done, so other jobs of
+ * the process run on their callers meanwhile.
+ */
+
+typedef struct
+{
+	const image_util_decode_item_s *items;
+	image_util_decode_batch_cb callback;
+	void *user_data;
+} _jpeg_batch_s;
+
+
+static int __decode_batch_item(void *data, int index)
+{
+	_jpeg_batch_s *batch = data;
+	const image_util_decode_item_s *item = &batch->items[index];
+	image_util_decode_s decode;
+	unsigned char *image = NULL;
+	int width = 0, height = 0;
+	unsigned int size = 0;
+	int ret = IMAGE_UTIL_ERROR_NONE;
+
+	if( (item->path == NULL) == (item->buffer == NULL) || (item->buffer && item->size == 0) )
+		ret = IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	else if( item->colorspace < 0 || item->colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		ret = IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	else if( item->width < 0 || item->height < 0 || (item->width == 0) != (item->height == 0) )
+		ret = IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		memset(&decode, 0, sizeof(decode));
+		decode.path = (char *)item->path;
+		decode.buffer = item->buffer;
+		decode.size = item->size;
+		decode.fd = -1;
+		decode.colorspace = item->colorspace;
+		decode.downscale = IMAGE_UTIL_DOWNSCALE_1_1;
+		decode.width = item->width;
+		decode.height = item->height;
+		ret = _image_util_jpeg_decode(&decode, NULL, &image, &width, &height, &size);
+	}
+
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		image = NULL;
+		width = height = 0;
+		size = 0;
+	}
+	batch->callback(index, ret, image, width, height, size, batch->user_data);
+
+	/* the error of an image does not stop the others */
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_jpeg_decode_batch(const image_util_decode_item_s *items, int num_items, image_util_decode_batch_cb callback, void *user_data)
+{
+	_jpeg_batch_s batch;
+
+	if( items == NULL || num_items <= 0 || callback == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	batch.items = items;
+	batch.callback = callback;
+	batch.user_data = user_data;
+	return _image_util_parallel_for(num_items, __decode_batch_item, &batch);
+}
+
+/*
+ * Thumbnails. A camera picture carries a small JPEG image in its EXIF
+ * segment, which decodes in a fraction of the time of the main image. When
+ * it is missing or smaller than asked for, the main image is decoded at the
+ * smallest DCT scale that is still large enough, so most of it is never
+ * transformed at full size.
+ */
+
+/* compares the size the decoder hands out, after a subsampled colorspace dropped an odd column or row */
+static bool __is_large_enough(image_util_colorspace_e colorspace, int width, int height, int min_width, int min_height)
+{
+	if( !__get_native_size(colorspace, &width, &height) )
+		return false;
+	return width >= min_width && height >= min_height;
+}
+
+static int __decode_exif_thumbnail(const char *path, const unsigned char *buffer, unsigned int size, int min_width, int min_height, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *image_size)
+{
+	image_util_decode_s decode;
+	image_util_jpeg_info_s info;
+	unsigned char *segment = NULL;
+	unsigned int offset = 0, length = 0;
+	int ret;
+
+	ret = _image_util_jpeg_get_thumbnail(path, buffer, size, &segment, &offset, &length);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	if( segment == NULL )
+		return IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+
+	ret = _image_util_jpeg_get_info(NULL, segment + offset, length, &info);
+	if( ret == IMAGE_UTIL_ERROR_NONE && !__is_large_enough(colorspace, info.width, info.height, min_width, min_height) )
+		ret = IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+	if( ret == IMAGE_UTIL_ERROR_NONE ){
+		memset(&decode, 0, sizeof(decode));
+		decode.buffer = segment + offset;
+		decode.size = length;
+		decode.fd = -1;
+		decode.colorspace = colorspace;
+		decode.downscale = IMAGE_UTIL_DOWNSCALE_1_1;
+		ret = _image_util_jpeg_decode(&decode, NULL, image_buffer, width, height, image_size);
+	}
+	_image_util_free(segment);
+	return ret;
+}
+
+int _image_util_jpeg_decode_thumbnail(const char *path, const unsigned char *buffer, unsigned int size, int min_width, int min_height, image_util_colorspace_e colorspace, unsigned char **image_buffer, int *width, int *height, unsigned int *image_size)
+{
+	image_util_decode_s decode;
+	image_util_jpeg_info_s info;
+	int ret, scale;
+
+	if( (path == NULL && buffer == NULL) || image_buffer == NULL || min_width < 0 || min_height < 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( colorspace < 0 || colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	/* a broken or small thumbnail falls back to the main image */
+	ret = __decode_exif_thumbnail(path, buffer, size, min_width, min_height, colorspace, image_buffer, width, height, image_size);
+	if( ret == IMAGE_UTIL_ERROR_NONE || ret == IMAGE_UTIL_ERROR_OUT_OF_MEMORY )
+		return ret;
+
+	ret = _image_util_jpeg_get_info(path, buffer, size, &info);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	for( scale = IMAGE_UTIL_DOWNSCALE_1_8 ; scale > IMAGE_UTIL_DOWNSCALE_1_1 ; scale-- ){
+		int denom = 1 << scale;
+		if( __is_large_enough(colorspace, (info.width + denom - 1) / denom, (info.height + denom - 1) / denom, min_width, min_height) )
+			break;
+	}
+
+	memset(&decode, 0, sizeof(decode));
+	decode.path = (char *)path;
+	decode.buffer = buffer;
+	decode.size = size;
+	decode.fd = -1;
+	decode.colorspace = colorspace;
+	decode.downscale = scale;
+	return _image_util_jpeg_decode(&decode, NULL, image_buffer, width, height, image_size);
+}
+
+/*
+ * Streamed decoding. The source suspends libjpeg when it runs out of data,
+ * and the decoding goes on from the same place on the next push. Only the
+ * bytes libjpeg has not consumed yet are kept, and the rows are handed out
+ * in bands of _JPEG_STRIP_ROWS, so the memory does not grow with the image.
+ */
+
+typedef enum
+{
+	_STREAM_HEADER,
+	_STREAM_START,
+	_STREAM_ROWS,
+	_STREAM_FINISH,		/* all rows are out, the end of the image is not read yet */
+	_STREAM_DONE,
+	_STREAM_ERROR,
+} _jpeg_stream_state_e;
+
+struct _image_util_jpeg_stream_s
+{
+	struct jpeg_decompress_struct cinfo;
+	_jpeg_error_mgr_s err;
+	struct jpeg_source_mgr src;
+	_jpeg_stream_state_e state;
+	image_util_colorspace_e colorspace;
+	image_util_scale_e downscale;
+	image_util_decode_rows_cb callback;
+	void *user_data;
+
+	/* compressed bytes not consumed yet */
+	unsigned char *input;
+	size_t input_capacity;
+	size_t skip;			/* bytes to drop from the next push */
+
+	/* the band being decoded */
+	int width;
+	int height;
+	int row;
+	int band_rows;
+	image_util_colorspace_e strip_colorspace;
+	image_util_planes_s strip;
+	image_util_planes_s band;
+	unsigned char *strip_block;
+	unsigned char *band_block;
+};
+
+
+static void __stream_init_source(j_decompress_ptr cinfo)
+{
+}
+
+static boolean __stream_fill_input_buffer(j_decompress_ptr cinfo)
+{
+	/* suspend until more data is pushed */
+	return FALSE;
+}
+
+static void __stream_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+	image_util_jpeg_stream_s *stream = (image_util_jpeg_stream_s *)cinfo;
+
+	if( num_bytes <= 0 )
+		return;
+	if( (size_t)num_bytes > cinfo->src->bytes_in_buffer ){
+		stream->skip += num_bytes - cinfo->src->bytes_in_buffer;
+		cinfo->src->next_input_byte += cinfo->src->bytes_in_buffer;
+		cinfo->src->bytes_in_buffer = 0;
+	}else{
+		cinfo->src->next_input_byte += num_bytes;
+		cinfo->src->bytes_in_buffer -= num_bytes;
+	}
+}
+
+static void __stream_term_source(j_decompress_ptr cinfo)
+{
+}
+
+static int __stream_append(image_util_jpeg_stream_s *stream, const unsigned char *data, unsigned int size)
+{
+	size_t pending = stream->src.bytes_in_buffer;
+	size_t skip = (stream->skip < size) ? stream->skip : size;
+	unsigned char *input = stream->input;
+
+	stream->skip -= skip;
+	data += skip;
+	size -= skip;
+
+	/* the unconsumed bytes move to the start of the buffer */
+	if( pending + size > stream->input_capacity ){
+		size_t capacity = (pending + size > 2 * stream->input_capacity) ? pending + size : 2 * stream->input_capacity;
+		input = _image_util_malloc(capacity);
+		if( input == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		stream->input_capacity = capacity;
+	}
+	if( pending > 0 )
+		memmove(input, stream->src.next_input_byte, pending);
+	if( input != stream->input ){
+		_image_util_free(stream->input);
+		stream->input = input;
+	}
+	if( size > 0 )
+		memcpy(input + pending, data, size);
+
+	stream->src.next_input_byte = input;
+	stream->src.bytes_in_buffer = pending + size;
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __stream_setup(image_util_jpeg_stream_s *stream)
+{
+	struct jpeg_decompress_struct *cinfo = &stream->cinfo;
+	image_util_plane_layout_s layout;
+	int stride, i;
+
+	if( cinfo->jpeg_color_space != JCS_GRAYSCALE && cinfo->jpeg_color_space != JCS_YCbCr && cinfo->jpeg_color_space != JCS_RGB ){
+		LOGE("[%s] jpeg color space %d is not supported", __func__, cinfo->jpeg_color_space);
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	}
+
+	cinfo->scale_num = 1;
+	cinfo->scale_denom = 1 << stream->downscale;
+	cinfo->out_color_space = JCS_RGB;
+	__get_direct_color_space(stream->colorspace, &cinfo->out_color_space);
+	jpeg_calc_output_dimensions(cinfo);
+
+	stream->width = cinfo->output_width;
+	stream->height = cinfo->output_height;
+	if( !__get_native_size(stream->colorspace, &stream->width, &stream->height) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+
+	stride = cinfo->output_width * cinfo->output_components;
+	stream->strip_block = _image_util_malloc(stride * _JPEG_STRIP_ROWS);
+	if( stream->strip_block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	stream->strip_colorspace = (cinfo->out_color_space == JCS_RGB) ? IMAGE_UTIL_COLORSPACE_RGB888 : stream->colorspace;
+	stream->strip.data[0] = stream->strip_block;
+	stream->strip.stride[0] = stride;
+
+	if( stream->strip_colorspace == stream->colorspace ){
+		stream->band = stream->strip;
+		return IMAGE_UTIL_ERROR_NONE;
+	}
+
+	_image_util_get_plane_layout(stream->colorspace, stream->width, _JPEG_STRIP_ROWS, 1, &layout);
+	stream->band_block = _image_util_malloc(layout.size);
+	if( stream->band_block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	for( i = 0 ; i < layout.num_planes ; i++ ){
+		stream->band.data[i] = stream->band_block + layout.offset[i];
+		stream->band.stride[i] = layout.stride[i];
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __stream_deliver(image_util_jpeg_stream_s *stream, int rows)
+{
+	int ret;
+
+	/* the odd last row of a subsampled colorspace is dropped */
+	if( stream->row + rows > stream->height )
+		rows = stream->height - stream->row;
+	if( rows <= 0 )
+		return IMAGE_UTIL_ERROR_NONE;
+
+	if( stream->strip_colorspace != stream->colorspace ){
+		ret = _image_util_convert_rows(&stream->band, stream->colorspace, &stream->strip, stream->strip_colorspace, stream->width, rows, 0, rows);
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			return ret;
+	}
+	stream->callback(&stream->band, stream->row, rows, stream->width, stream->height, stream->user_data);
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* decodes as far as the data goes */
+static int __stream_decode(image_util_jpeg_stream_s *stream)
+{
+	struct jpeg_decompress_struct *cinfo = &stream->cinfo;
+	JSAMPROW row_pointers[_JPEG_STRIP_ROWS];
+	int band_size, n, i, ret;
+
+	if( stream->state == _STREAM_HEADER ){
+		if( jpeg_read_header(cinfo, TRUE) == JPEG_SUSPENDED )
+			return IMAGE_UTIL_ERROR_NONE;
+		ret = __stream_setup(stream);
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			return ret;
+		stream->state = _STREAM_START;
+	}
+
+	if( stream->state == _STREAM_START ){
+		if( !jpeg_start_decompress(cinfo) )
+			return IMAGE_UTIL_ERROR_NONE;
+		stream->state = _STREAM_ROWS;
+	}
+
+	while( stream->state == _STREAM_ROWS ){
+		band_size = cinfo->output_height - stream->row;
+		if( band_size > _JPEG_STRIP_ROWS )
+			band_size = _JPEG_STRIP_ROWS;
+
+		for( i = stream->band_rows ; i < band_size ; i++ )
+			row_pointers[i - stream->band_rows] = stream->strip.data[0] + i * stream->strip.stride[0];
+		n = jpeg_read_scanlines(cinfo, row_pointers, band_size - stream->band_rows);
+		if( n == 0 )
+			return IMAGE_UTIL_ERROR_NONE;
+
+		stream->band_rows += n;
+		if( stream->band_rows < band_size )
+			continue;
+
+		ret = __stream_deliver(stream, band_size);
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			return ret;
+		stream->row += band_size;
+		stream->band_rows = 0;
+		if( stream->row >= cinfo->output_height )
+			stream->state = _STREAM_FINISH;
+	}
+
+	if( stream->state == _STREAM_FINISH ){
+		if( !jpeg_finish_decompress(cinfo) )
+			return IMAGE_UTIL_ERROR_NONE;
+		stream->state = _STREAM_DONE;
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* runs the libjpeg calls, which return here on an error */
+static int __stream_decode_protected(image_util_jpeg_stream_s *stream)
+{
+	if( setjmp(stream->err.jump) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	return __stream_decode(stream);
+}
+
+static int __stream_create_protected(image_util_jpeg_stream_s *stream)
+{
+	if( setjmp(stream->err.jump) )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	jpeg_create_decompress(&stream->cinfo);
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_jpeg_stream_create(const image_util_decode_s *decode, image_util_decode_rows_cb callback, void *user_data, image_util_jpeg_stream_s **stream)
+{
+	image_util_jpeg_stream_s *s;
+	int ret;
+
+	if( decode == NULL || callback == NULL || stream == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	s = _image_util_calloc(1, sizeof(image_util_jpeg_stream_s));
+	if( s == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	s->cinfo.err = jpeg_std_error(&s->err.pub);
+	s->err.pub.error_exit = __error_exit;
+	s->err.pub.output_message = __output_message;
+	ret = __stream_create_protected(s);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_free(s);
+		return ret;
+	}
+
+	s->src.init_source = __stream_init_source;
+	s->src.fill_input_buffer = __stream_fill_input_buffer;
+	s->src.skip_input_data = __stream_skip_input_data;
+	s->src.resync_to_restart = jpeg_resync_to_restart;
+	s->src.term_source = __stream_term_source;
+	s->cinfo.src = &s->src;
+
+	s->state = _STREAM_HEADER;
+	s->colorspace = decode->colorspace;
+	s->downscale = decode->downscale;
+	s->callback = callback;
+	s->user_data = user_data;
+
+	*stream = s;
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_jpeg_stream_push(image_util_jpeg_stream_s *stream, const unsigned char *data, unsigned int size)
+{
+	int ret;
+
+	if( stream == NULL || data == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( stream->state == _STREAM_ERROR )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	/* bytes after the end of the image are ignored */
+	if( stream->state == _STREAM_DONE )
+		return IMAGE_UTIL_ERROR_NONE;
+
+	ret = __stream_append(stream, data, size);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = __stream_decode_protected(stream);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		stream->state = _STREAM_ERROR;
+
+	return ret;
+}
+
+int _image_util_jpeg_stream_finish(image_util_jpeg_stream_s *stream)
+{
+	if( stream == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	/* a missing end of image marker is tolerated once all rows are out */
+	if( stream->state != _STREAM_FINISH && stream->state != _STREAM_DONE ){
+		LOGE("[%s] the image is not complete", __func__);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+void _image_util_jpeg_stream_destroy(image_util_jpeg_stream_s *stream)
+{
+	if( stream == NULL )
+		return;
+
+	jpeg_destroy_decompress(&stream->cinfo);
+	_image_util_free(stream->input);
+	_image_util_free(stream->strip_block);
+	_image_util_free(stream->band_block);
+	_image_util_free(stream);
+}
+
+/*
+ * Streamed encoding. Pushed rows are compressed as they come, and the
+ * destination hands the compressed bytes to the sink after every push, so
+ * neither the image nor the jpeg data is kept whole. An encoder given a
+ * buffer of the caller compresses into it directly instead.
+ *
+ * YUV rows are handed to libjpeg as raw YCbCr data, one iMCU row at a time,
+ * which skips the color conversion and the chroma downsampling of libjpeg.
+ * Only the range is stretched from video to the full range of JFIF. RGB rows
+ * libjpeg reads directly are compressed as they are, other colorspaces are
+ * converted to RGB in strips first.
+ */
+
+#define _JPEG_OUTPUT_SIZE	4096
+
+typedef enum
+{
+	_ENCODER_ROWS,
+	_ENCODER_DONE,
+	_ENCODER_ERROR,
+} _jpeg_encoder_state_e;
+
+struct _image_util_jpeg_encoder_s
+{
+	struct jpeg_compress_struct cinfo;
+	_jpeg_error_mgr_s err;
+	struct jpeg_destination_mgr dest;
+	_jpeg_encoder_state_e state;
+	image_util_colorspace_e colorspace;
+	int width;
+	int height;
+	int row;					/* rows pushed so far */
+	image_util_encode_output_cb callback;
+	void *user_data;
+	bool sink_failed;
+	unsigned char *buffer;		/* of the caller, instead of the callback */
+	unsigned int capacity;
+
+	image_util_colorspace_e strip_colorspace;
+	image_util_planes_s strip;
+	unsigned char *strip_block;
+
+	/* raw data of one iMCU row */
+	bool raw;
+	int raw_rows;
+	int raw_filled;
+	int raw_width[3];
+	JSAMPROW raw_row[3][_JPEG_STRIP_ROWS];
+	unsigned char *raw_block;
+	unsigned char y_range[256];
+	unsigned char c_range[256];
+
+	unsigned char output[_JPEG_OUTPUT_SIZE];
+};
+
+
+static void __encoder_emit(image_util_jpeg_encoder_s *encoder, size_t size)
+{
+	if( size > 0 && !encoder->callback(encoder->output, size, encoder->user_data) ){
+		encoder->sink_failed = true;
+		ERREXIT(&encoder->cinfo, JERR_FILE_WRITE);
+	}
+	encoder->dest.next_output_byte = encoder->output;
+	encoder->dest.free_in_buffer = _JPEG_OUTPUT_SIZE;
+}
+
+static void __encoder_init_destination(j_compress_ptr cinfo)
+{
+	image_util_jpeg_encoder_s *encoder = (image_util_jpeg_encoder_s *)cinfo;
+
+	if( encoder->buffer ){
+		encoder->dest.next_output_byte = encoder->buffer;
+		encoder->dest.free_in_buffer = encoder->capacity;
+		return;
+	}
+	encoder->dest.next_output_byte = encoder->output;
+	encoder->dest.free_in_buffer = _JPEG_OUTPUT_SIZE;
+}
+
+static boolean __encoder_empty_output_buffer(j_compress_ptr cinfo)
+{
+	image_util_jpeg_encoder_s *encoder = (image_util_jpeg_encoder_s *)cinfo;
+
+	if( encoder->buffer ){
+		encoder->sink_failed = true;
+		ERREXIT(cinfo, JERR_BUFFER_SIZE);
+	}
+	/* libjpeg does not update free_in_buffer before calling this */
+	__encoder_emit(encoder, _JPEG_OUTPUT_SIZE);
+	return TRUE;
+}
+
+static void __encoder_flush(image_util_jpeg_encoder_s *encoder)
+{
+	if( encoder->buffer == NULL )
+		__encoder_emit(encoder, _JPEG_OUTPUT_SIZE - encoder->dest.free_in_buffer);
+}
+
+static void __encoder_term_destination(j_compress_ptr cinfo)
+{
+	__encoder_flush((image_util_jpeg_encoder_s *)cinfo);
+}
+
+/* vertical chroma sampling of the colorspaces encoded from raw YCbCr data */
+static bool __get_raw_sampling(image_util_colorspace_e colorspace, int *v_samp)
+{
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+		case IMAGE_UTIL_COLORSPACE_I420:
+		case IMAGE_UTIL_COLORSPACE_NV12:
+			*v_samp = 2;
+			return true;
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+		case IMAGE_UTIL_COLORSPACE_UYVY:
+		case IMAGE_UTIL_COLORSPACE_YUYV:
+			*v_samp = 1;
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void __set_raw_input(image_util_jpeg_encoder_s *encoder, int v_samp)
+{
+	struct jpeg_compress_struct *cinfo = &encoder->cinfo;
+	int i;
+
+	cinfo->raw_data_in = TRUE;
+	cinfo->comp_info[0].h_samp_factor = 2;
+	cinfo->comp_info[0].v_samp_factor = v_samp;
+	for( i = 1 ; i < 3 ; i++ ){
+		cinfo->comp_info[i].h_samp_factor = 1;
+		cinfo->comp_info[i].v_samp_factor = 1;
+	}
+
+	/* BT.601 video range to the full range of JFIF */
+	for( i = 0 ; i < 256 ; i++ ){
+		encoder->y_range[i] = (i <= 16) ? 0 : (i >= 235) ? 255 : ((i - 16) * 255 + 109) / 219;
+		encoder->c_range[i] = (i <= 16) ? 0 : (i >= 240) ? 255 : ((i - 16) * 255 + 112) / 224;
+	}
+	encoder->raw = true;
+	encoder->raw_rows = v_samp * DCTSIZE;
+}
+
+/* the sizes of the components are known once the compression is started */
+static int __alloc_raw_rows(image_util_jpeg_encoder_s *encoder)
+{
+	int c, i, rows, size = 0;
+	unsigned char *p;
+
+	for( c = 0 ; c < 3 ; c++ ){
+		encoder->raw_width[c] = encoder->cinfo.comp_info[c].width_in_blocks * DCTSIZE;
+		size += encoder->raw_width[c] * ((c == 0) ? encoder->raw_rows : DCTSIZE);
+	}
+	encoder->raw_block = _image_util_malloc(size);
+	if( encoder->raw_block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	p = encoder->raw_block;
+	for( c = 0 ; c < 3 ; c++ ){
+		rows = (c == 0) ? encoder->raw_rows : DCTSIZE;
+		for( i = 0 ; i < rows ; i++, p += encoder->raw_width[c] )
+			encoder->raw_row[c][i] = p;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __encoder_start(image_util_jpeg_encoder_s *encoder, int quality)
+{
+	struct jpeg_compress_struct *cinfo = &encoder->cinfo;
+	int stride, v_samp = 1, ret;
+
+	cinfo->image_width = encoder->width;
+	cinfo->image_height = encoder->height;
+	cinfo->input_components = 3;
+	cinfo->in_color_space = JCS_RGB;
+	if( __get_raw_sampling(encoder->colorspace, &v_samp) )
+		cinfo->in_color_space = JCS_YCbCr;
+	else if( __get_direct_color_space(encoder->colorspace, &cinfo->in_color_space) && cinfo->in_color_space != JCS_RGB )
+		cinfo->input_components = 4;
+	jpeg_set_defaults(cinfo);
+	jpeg_set_quality(cinfo, quality, TRUE);
+	if( cinfo->in_color_space == JCS_YCbCr )
+		__set_raw_input(encoder, v_samp);
+
+	encoder->strip_colorspace = (cinfo->in_color_space == JCS_RGB) ? IMAGE_UTIL_COLORSPACE_RGB888 : encoder->colorspace;
+	if( encoder->strip_colorspace != encoder->colorspace ){
+		stride = encoder->width * 3;
+		encoder->strip_block = _image_util_malloc(stride * _JPEG_STRIP_ROWS);
+		if( encoder->strip_block == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		encoder->strip.data[0] = encoder->strip_block;
+		encoder->strip.stride[0] = stride;
+	}
+
+	jpeg_start_compress(cinfo, TRUE);
+	if( encoder->raw ){
+		ret = __alloc_raw_rows(encoder);
+		if( ret != IMAGE_UTIL_ERROR_NONE )
+			return ret;
+	}
+	__encoder_flush(encoder);
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static void __write_rows(struct jpeg_compress_struct *cinfo, const unsigned char *data, int stride, int rows)
+{
+	JSAMPROW row_pointers[_JPEG_STRIP_ROWS];
+	int done = 0, i, n;
+
+	while( done < rows ){
+		n = (rows - done < _JPEG_STRIP_ROWS) ? rows - done : _JPEG_STRIP_ROWS;
+		for( i = 0 ; i < n ; i++ )
+			row_pointers[i] = (JSAMPROW)(data + (done + i) * stride);
+		done += jpeg_write_scanlines(cinfo, row_pointers, n);
+	}
+}
+
+/* copies count samples step bytes apart and repeats the last one up to the block width */
+static void __copy_raw_samples(unsigned char *d, const unsigned char *s, int step, int count, int width, const unsigned char *range)
+{
+	int x;
+
+	for( x = 0 ; x < count ; x++, s += step )
+		d[x] = range[*s];
+	for( ; x < width ; x++ )
+		d[x] = d[count - 1];
+}
+
+/* row k of the pushed rows into row i of the iMCU row */
+static void __fill_raw_row(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *rows, int k, int i)
+{
+	const unsigned char *y, *u = NULL, *v = NULL;
+	int y_step = 1, c_step = 1, ci = i;
+
+	y = rows->data[0] + k * rows->stride[0];
+	switch( encoder->colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+			v = rows->data[1] + (k >> 1) * rows->stride[1];
+			u = rows->data[2] + (k >> 1) * rows->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_I420:
+			u = rows->data[1] + (k >> 1) * rows->stride[1];
+			v = rows->data[2] + (k >> 1) * rows->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_NV12:
+			u = rows->data[1] + (k >> 1) * rows->stride[1];
+			v = u + 1;
+			c_step = 2;
+			break;
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+			u = rows->data[1] + k * rows->stride[1];
+			v = rows->data[2] + k * rows->stride[2];
+			break;
+		case IMAGE_UTIL_COLORSPACE_UYVY:
+		case IMAGE_UTIL_COLORSPACE_YUYV:
+		{
+			int co = (encoder->colorspace == IMAGE_UTIL_COLORSPACE_YUYV) ? 1 : 0;
+			u = y + co;
+			v = y + co + 2;
+			y += 1 - co;
+			y_step = 2;
+			c_step = 4;
+			break;
+		}
+		default:
+			break;
+	}
+
+	__copy_raw_samples(encoder->raw_row[0][i], y, y_step, encoder->width, encoder->raw_width[0], encoder->y_range);
+	if( encoder->raw_rows > DCTSIZE ){
+		/* 4:2:0, the chroma row comes with the even luma row */
+		if( i & 1 )
+			return;
+		ci = i >> 1;
+	}
+	__copy_raw_samples(encoder->raw_row[1][ci], u, c_step, encoder->width / 2, encoder->raw_width[1], encoder->c_range);
+	__copy_raw_samples(encoder->raw_row[2][ci], v, c_step, encoder->width / 2, encoder->raw_width[2], encoder->c_range);
+}
+
+static void __write_raw_rows(image_util_jpeg_encoder_s *encoder)
+{
+	JSAMPARRAY planes[3] = { encoder->raw_row[0], encoder->raw_row[1], encoder->raw_row[2] };
+	int filled = encoder->raw_filled;
+	int c_filled = (encoder->raw_rows > DCTSIZE) ? (filled + 1) / 2 : filled;
+	int i, c;
+
+	/* the last iMCU row is filled up with copies of the last image row */
+	for( i = filled ; i < encoder->raw_rows ; i++ )
+		memcpy(encoder->raw_row[0][i], encoder->raw_row[0][filled - 1], encoder->raw_width[0]);
+	for( c = 1 ; c < 3 ; c++ ){
+		for( i = c_filled ; i < DCTSIZE ; i++ )
+			memcpy(encoder->raw_row[c][i], encoder->raw_row[c][c_filled - 1], encoder->raw_width[c]);
+	}
+
+	jpeg_write_raw_data(&encoder->cinfo, planes, encoder->raw_rows);
+	encoder->raw_filled = 0;
+}
+
+static int __encoder_write(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *rows, int num_rows)
+{
+	struct jpeg_compress_struct *cinfo = &encoder->cinfo;
+	image_util_planes_s view;
+	int row, n, ret;
+
+	if( encoder->raw ){
+		for( row = 0 ; row < num_rows ; row++ ){
+			__fill_raw_row(encoder, rows, row, encoder->raw_filled++);
+			if( encoder->raw_filled == encoder->raw_rows || encoder->row + row + 1 == encoder->height )
+				__write_raw_rows(encoder);
+		}
+	}else if( encoder->strip_colorspace == encoder->colorspace ){
+		__write_rows(cinfo, rows->data[0], rows->stride[0], num_rows);
+	}else{
+		/* strips are even, so chroma rows are never split */
+		for( row = 0 ; row < num_rows ; row += n ){
+			n = (num_rows - row < _JPEG_STRIP_ROWS) ? num_rows - row : _JPEG_STRIP_ROWS;
+			ret = _image_util_get_crop_planes(encoder->colorspace, rows, 0, row, &view);
+			if( ret == IMAGE_UTIL_ERROR_NONE )
+				ret = _image_util_convert_rows(&encoder->strip, encoder->strip_colorspace, &view, encoder->colorspace, encoder->width, n, 0, n);
+			if( ret != IMAGE_UTIL_ERROR_NONE )
+				return ret;
+			__write_rows(cinfo, encoder->strip.data[0], encoder->strip.stride[0], n);
+		}
+	}
+
+	encoder->row += num_rows;
+	if( encoder->row == encoder->height ){
+		jpeg_finish_compress(cinfo);
+		encoder->state = _ENCODER_DONE;
+	}else{
+		__encoder_flush(encoder);
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* runs the libjpeg calls, which return here on an error */
+static int __encoder_start_protected(image_util_jpeg_encoder_s *encoder, int quality)
+{
+	if( setjmp(encoder->err.jump) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	jpeg_create_compress(&encoder->cinfo);
+	encoder->dest.init_destination = __encoder_init_destination;
+	encoder->dest.empty_output_buffer = __encoder_empty_output_buffer;
+	encoder->dest.term_destination = __encoder_term_destination;
+	encoder->cinfo.dest = &encoder->dest;
+
+	return __encoder_start(encoder, quality);
+}
+
+static int __encoder_write_protected(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *rows, int num_rows)
+{
+	if( setjmp(encoder->err.jump) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	return __encoder_write(encoder, rows, num_rows);
+}
+
+static int __encoder_create(const image_util_encode_s *encode, image_util_encode_output_cb callback, void *user_data, unsigned char *buffer, unsigned int capacity, image_util_jpeg_encoder_s **encoder)
+{
+	image_util_jpeg_encoder_s *e;
+	int ret;
+
+	if( !_image_util_is_native_size(encode->width, encode->height, encode->colorspace) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	e = _image_util_calloc(1, sizeof(image_util_jpeg_encoder_s));
+	if( e == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	e->colorspace = encode->colorspace;
+	e->width = encode->width;
+	e->height = encode->height;
+	e->callback = callback;
+	e->user_data = user_data;
+	e->buffer = buffer;
+	e->capacity = capacity;
+	e->cinfo.err = jpeg_std_error(&e->err.pub);
+	e->err.pub.error_exit = __error_exit;
+	e->err.pub.output_message = __output_message;
+
+	ret = __encoder_start_protected(e, encode->quality);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		if( e->sink_failed && e->buffer )
+			ret = IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		_image_util_jpeg_encoder_destroy(e);
+		return ret;
+	}
+
+	*encoder = e;
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_jpeg_encoder_create(const image_util_encode_s *encode, image_util_encode_output_cb callback, void *user_data, image_util_jpeg_encoder_s **encoder)
+{
+	if( encode == NULL || callback == NULL || encoder == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	return __encoder_create(encode, callback, user_data, NULL, 0, encoder);
+}
+
+int _image_util_jpeg_encoder_write(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *rows, int num_rows)
+{
+	int ret;
+
+	if( encoder == NULL || rows == NULL || num_rows <= 0 )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( encoder->state != _ENCODER_ROWS )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	if( encoder->row + num_rows > encoder->height )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( _image_util_check_planes(encoder->colorspace, encoder->width, num_rows, rows) != IMAGE_UTIL_ERROR_NONE )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	/* only the last push may end inside a chroma row */
+	if( encoder->row + num_rows < encoder->height && !_image_util_is_native_size(encoder->width, num_rows, encoder->colorspace) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	ret = __encoder_write_protected(encoder, rows, num_rows);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		if( encoder->sink_failed && encoder->buffer ){
+			LOGE("[%s] the buffer of %u bytes is too small", __func__, encoder->capacity);
+			ret = IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		}else if( encoder->sink_failed ){
+			LOGE("[%s] the output callback stopped the encoding", __func__);
+		}
+		encoder->state = _ENCODER_ERROR;
+	}
+	return ret;
+}
+
+int _image_util_jpeg_encoder_finish(image_util_jpeg_encoder_s *encoder)
+{
+	if( encoder == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( encoder->state != _ENCODER_DONE ){
+		LOGE("[%s] %d of %d rows were pushed", __func__, encoder->row, encoder->height);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+void _image_util_jpeg_encoder_destroy(image_util_jpeg_encoder_s *encoder)
+{
+	if( encoder == NULL )
+		return;
+
+	jpeg_destroy_compress(&encoder->cinfo);
+	_image_util_free(encoder->strip_block);
+	_image_util_free(encoder->raw_block);
+	_image_util_free(encoder);
+}
+
+/*
+ * Whole images, encoded through an encoder into a file or a growing buffer.
+ */
+
+typedef struct
+{
+	unsigned char *buffer;
+	unsigned int size;
+	unsigned int capacity;
+	bool no_memory;
+} _jpeg_memory_dest_s;
+
+static bool __write_file_cb(const unsigned char *data, unsigned int size, void *user_data)
+{
+	return fwrite(data, 1, size, (FILE *)user_data) == size;
+}
+
+static bool __write_memory_cb(const unsigned char *data, unsigned int size, void *user_data)
+{
+	_jpeg_memory_dest_s *dest = user_data;
+	unsigned char *buffer;
+	unsigned int capacity;
+
+	if( dest->size + size > dest->capacity ){
+		capacity = dest->capacity ? dest->capacity : 64 * 1024;
+		while( capacity < dest->size + size )
+			capacity *= 2;
+		/* no realloc in the allocator, the data so far is moved over */
+		buffer = _image_util_output_alloc(capacity);
+		if( buffer == NULL ){
+			dest->no_memory = true;
+			return false;
+		}
+		if( dest->size )
+			memcpy(buffer, dest->buffer, dest->size);
+		_image_util_free(dest->buffer);
+		dest->buffer = buffer;
+		dest->capacity = capacity;
+	}
+
+	memcpy(dest->buffer + dest->size, data, size);
+	dest->size += size;
+	return true;
+}
+
+/* writes a whole image in bands, so that a canceled request stops early */
+static int __encoder_write_image(image_util_jpeg_encoder_s *encoder, const image_util_planes_s *src)
+{
+	image_util_planes_s view;
+	int row, n, ret = IMAGE_UTIL_ERROR_NONE;
+
+	for( row = 0 ; ret == IMAGE_UTIL_ERROR_NONE && row < encoder->height ; row += n ){
+		if( _image_util_is_canceled() )
+			return IMAGE_UTIL_ERROR_CANCELED;
+		n = (encoder->height - row < _JPEG_CANCEL_ROWS) ? encoder->height - row : _JPEG_CANCEL_ROWS;
+		ret = _image_util_get_crop_planes(encoder->colorspace, src, 0, row, &view);
+		if( ret == IMAGE_UTIL_ERROR_NONE )
+			ret = _image_util_jpeg_encoder_write(encoder, &view, n);
+	}
+	return ret;
+}
+
+int _image_util_jpeg_encode(const image_util_encode_s *encode, const image_util_planes_s *src, image_util_encode_output_cb callback, void *user_data)
+{
+	image_util_jpeg_encoder_s *encoder = NULL;
+	int ret;
+
+	ret = _image_util_jpeg_encoder_create(encode, callback, user_data, &encoder);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = __encoder_write_image(encoder, src);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = _image_util_jpeg_encoder_finish(encoder);
+	_image_util_jpeg_encoder_destroy(encoder);
+	return ret;
+}
+
+int _image_util_jpeg_encode_to_buffer(const image_util_encode_s *encode, const image_util_planes_s *src, unsigned char *buffer, unsigned int capacity, unsigned int *size)
+{
+	image_util_jpeg_encoder_s *encoder = NULL;
+	int ret;
+
+	ret = __encoder_create(encode, NULL, NULL, buffer, capacity, &encoder);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = __encoder_write_image(encoder, src);
+	if( ret == IMAGE_UTIL_ERROR_NONE )
+		ret = _image_util_jpeg_encoder_finish(encoder);
+	if( ret == IMAGE_UTIL_ERROR_NONE && size )
+		*size = capacity - encoder->dest.free_in_buffer;
+	_image_util_jpeg_encoder_destroy(encoder);
+	return ret;
+}
+
+/*
+ * The bound of libjpeg-turbo: 4:4:4 at any quality takes less than 6 bytes a
+ * pixel, plus the headers. 0 when it does not fit an unsigned int.
+ */
+unsigned int _image_util_jpeg_get_max_size(int width, int height)
+{
+	unsigned long long size = (unsigned long long)((width + 15) & ~15) * ((height + 15) & ~15) * 6 + 2048;
+
+	return (size > UINT_MAX) ? 0 : size;
+}
+
+int _image_util_jpeg_encode_to_file(const image_util_encode_s *encode, const image_util_planes_s *src, const char *path)
+{
+	FILE *fp;
+	int ret;
+
+	fp = fopen(path, "wb");
+	if( fp == NULL ){
+		LOGE("[%s] can not open %s", __func__, path);
+		return IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+	}
+
+	ret = _image_util_jpeg_encode(encode, src, __write_file_cb, fp);
+	if( fclose(fp) != 0 && ret == IMAGE_UTIL_ERROR_NONE )
+		ret = IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	return ret;
+}
+
+int _image_util_jpeg_encode_to_memory(const image_util_encode_s *encode, const image_util_planes_s *src, unsigned char **jpeg_buffer, unsigned int *jpeg_size)
+{
+	_jpeg_memory_dest_s dest;
+	unsigned char *buffer;
+	int ret;
+
+	memset(&dest, 0, sizeof(dest));
+	ret = _image_util_jpeg_encode(encode, src, __write_memory_cb, &dest);
+	if( ret != IMAGE_UTIL_ERROR_NONE ){
+		_image_util_free(dest.buffer);
+		return dest.no_memory ? IMAGE_UTIL_ERROR_OUT_OF_MEMORY : ret;
+	}
+
+	/* the doubling leaves up to twice the data allocated, the caller keeps a block of its size */
+	if( dest.size < dest.capacity ){
+		buffer = _image_util_output_alloc(dest.size);
+		if( buffer ){
+			memcpy(buffer, dest.buffer, dest.size);
+			_image_util_free(dest.buffer);
+			dest.buffer = buffer;
+		}
+	}
+
+	*jpeg_buffer = dest.buffer;
+	*jpeg_size = dest.size;
+	return IMAGE_UTIL_ERROR_NONE;
+}
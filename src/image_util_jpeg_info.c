@@ -0,0 +1,393 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * JPEG header probing.
+ *
+ * The markers are walked up to the start of the scan. Only the frame header,
+ * the restart interval and the EXIF segment are read, every other segment is
+ * skipped by its length, so a file is read for a few hundred bytes.
+ *
+ * The thumbnail of a camera picture is a small JPEG image inside the EXIF
+ * segment, pointed to by IFD1, and is found the same way without reading
+ * any of the main image.
+ */
+
+#define _MARKER_SOI		0xD8
+#define _MARKER_EOI		0xD9
+#define _MARKER_SOS		0xDA
+#define _MARKER_DRI		0xDD
+#define _MARKER_APP1	0xE1
+
+#define _EXIF_TAG_ORIENTATION	0x0112
+#define _EXIF_TAG_JPEG_OFFSET	0x0201
+#define _EXIF_TAG_JPEG_LENGTH	0x0202
+#define _EXIF_TYPE_SHORT		3
+#define _EXIF_TYPE_LONG			4
+
+typedef struct
+{
+	FILE *fp;
+	const unsigned char *data;
+	unsigned int size;
+	unsigned int pos;
+} _jpeg_reader_s;
+
+
+static bool __read(_jpeg_reader_s *reader, unsigned char *buffer, unsigned int size)
+{
+	if( reader->fp )
+		return fread(buffer, 1, size, reader->fp) == size;
+
+	if( size > reader->size - reader->pos )
+		return false;
+	memcpy(buffer, reader->data + reader->pos, size);
+	reader->pos += size;
+	return true;
+}
+
+static bool __skip(_jpeg_reader_s *reader, unsigned int size)
+{
+	if( reader->fp )
+		return fseek(reader->fp, size, SEEK_CUR) == 0;
+
+	if( size > reader->size - reader->pos )
+		return false;
+	reader->pos += size;
+	return true;
+}
+
+static int __get_16(const unsigned char *p, bool big_endian)
+{
+	return big_endian ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+}
+
+static unsigned int __get_32(const unsigned char *p, bool big_endian)
+{
+	if( big_endian )
+		return ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	return ((unsigned int)p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+/* the byte order and the offset of IFD0 of the TIFF header in the payload of an APP1 segment */
+static bool __get_tiff_header(const unsigned char *exif, unsigned int size, bool *big_endian, unsigned int *ifd)
+{
+	const unsigned char *tiff = exif + 6;
+
+	if( size < 6 + 8 || memcmp(exif, "Exif\0\0", 6) != 0 )
+		return false;
+
+	if( memcmp(tiff, "MM\0*", 4) == 0 )
+		*big_endian = true;
+	else if( memcmp(tiff, "II*\0", 4) == 0 )
+		*big_endian = false;
+	else
+		return false;
+
+	*ifd = __get_32(tiff + 4, *big_endian);
+	return *ifd <= size - 6 - 2;
+}
+
+/* the orientation tag of IFD0 in the payload of an APP1 segment, 1 when there is none */
+static int __get_exif_orientation(const unsigned char *exif, unsigned int size)
+{
+	const unsigned char *tiff = exif + 6;
+	unsigned int tiff_size = size - 6, ifd, count, i;
+	bool big_endian;
+	int orientation;
+
+	if( !__get_tiff_header(exif, size, &big_endian, &ifd) )
+		return 1;
+
+	count = __get_16(tiff + ifd, big_endian);
+	for( i = 0 ; i < count && ifd + 2 + (i + 1) * 12 <= tiff_size ; i++ ){
+		const unsigned char *entry = tiff + ifd + 2 + i * 12;
+		if( __get_16(entry, big_endian) != _EXIF_TAG_ORIENTATION )
+			continue;
+		if( __get_16(entry + 2, big_endian) != _EXIF_TYPE_SHORT )
+			return 1;
+		orientation = __get_16(entry + 8, big_endian);
+		return (orientation >= 1 && orientation <= 8) ? orientation : 1;
+	}
+	return 1;
+}
+
+/* the JPEG thumbnail of IFD1 in the payload of an APP1 segment, as an offset into the payload */
+static bool __get_exif_thumbnail(const unsigned char *exif, unsigned int size, unsigned int *offset, unsigned int *length)
+{
+	const unsigned char *tiff = exif + 6;
+	unsigned int tiff_size = size - 6, ifd, count, i;
+	unsigned int start = 0, bytes = 0;
+	bool big_endian;
+
+	if( !__get_tiff_header(exif, size, &big_endian, &ifd) )
+		return false;
+
+	/* IFD1 follows the entries of IFD0 */
+	if( ifd + 2 + 4 > tiff_size )
+		return false;
+	count = __get_16(tiff + ifd, big_endian);
+	if( count > (tiff_size - ifd - 2 - 4) / 12 )
+		return false;
+	ifd = __get_32(tiff + ifd + 2 + count * 12, big_endian);
+	if( ifd == 0 || ifd > tiff_size - 2 )
+		return false;
+
+	count = __get_16(tiff + ifd, big_endian);
+	for( i = 0 ; i < count && ifd + 2 + (i + 1) * 12 <= tiff_size ; i++ ){
+		const unsigned char *entry = tiff + ifd + 2 + i * 12;
+		int tag = __get_16(entry, big_endian);
+		if( tag != _EXIF_TAG_JPEG_OFFSET && tag != _EXIF_TAG_JPEG_LENGTH )
+			continue;
+		if( __get_16(entry + 2, big_endian) != _EXIF_TYPE_LONG )
+			return false;
+		if( tag == _EXIF_TAG_JPEG_OFFSET )
+			start = __get_32(entry + 8, big_endian);
+		else
+			bytes = __get_32(entry + 8, big_endian);
+	}
+
+	if( bytes < 4 || start > tiff_size || bytes > tiff_size - start )
+		return false;
+	if( tiff[start] != 0xFF || tiff[start + 1] != _MARKER_SOI )
+		return false;
+	*offset = 6 + start;
+	*length = bytes;
+	return true;
+}
+
+static image_util_jpeg_subsampling_e __get_subsampling(const unsigned char *sof, int components)
+{
+	int h, v, i;
+
+	if( components == 1 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_GRAY;
+	if( components != 3 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_UNKNOWN;
+
+	/* the chroma components must be sampled once per MCU */
+	for( i = 1 ; i < 3 ; i++ ){
+		if( sof[6 + i * 3 + 1] != 0x11 )
+			return IMAGE_UTIL_JPEG_SUBSAMPLING_UNKNOWN;
+	}
+	h = sof[6 + 1] >> 4;
+	v = sof[6 + 1] & 0x0F;
+
+	if( h == 1 && v == 1 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_444;
+	if( h == 2 && v == 1 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_422;
+	if( h == 2 && v == 2 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_420;
+	if( h == 1 && v == 2 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_440;
+	if( h == 4 && v == 1 )
+		return IMAGE_UTIL_JPEG_SUBSAMPLING_411;
+	return IMAGE_UTIL_JPEG_SUBSAMPLING_UNKNOWN;
+}
+
+static bool __is_sof(int marker)
+{
+	/* 0xC4, 0xC8 and 0xCC are DHT, JPG and DAC */
+	return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+/* the next segment before the scan, false at the scan, at the end of the image or of the data */
+static bool __next_segment(_jpeg_reader_s *reader, int *marker, int *length)
+{
+	unsigned char buffer[2];
+
+	while( true ){
+		/* a marker may be preceded by any number of fill bytes */
+		if( !__read(reader, buffer, 1) )
+			return false;
+		if( buffer[0] != 0xFF )
+			continue;
+		do{
+			if( !__read(reader, buffer, 1) )
+				return false;
+		}while( buffer[0] == 0xFF );
+		*marker = buffer[0];
+
+		if( *marker == _MARKER_SOS || *marker == _MARKER_EOI )
+			return false;
+		if( *marker == 0x00 || *marker == 0x01 || (*marker >= 0xD0 && *marker <= 0xD7) )
+			continue;
+
+		if( !__read(reader, buffer, 2) )
+			return false;
+		*length = __get_16(buffer, true) - 2;
+		return *length >= 0;
+	}
+}
+
+static bool __read_soi(_jpeg_reader_s *reader)
+{
+	unsigned char buffer[2];
+
+	return __read(reader, buffer, 2) && buffer[0] == 0xFF && buffer[1] == _MARKER_SOI;
+}
+
+static int __read_info(_jpeg_reader_s *reader, image_util_jpeg_info_s *info)
+{
+	unsigned char buffer[6 + 3 * 255];
+	unsigned char *segment;
+	bool has_frame = false, has_exif = false;
+	int marker, length;
+
+	if( !__read_soi(reader) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	while( __next_segment(reader, &marker, &length) ){
+		if( __is_sof(marker) && !has_frame ){
+			if( length < 6 || (unsigned int)length > sizeof(buffer) || !__read(reader, buffer, length) )
+				break;
+			info->height = __get_16(buffer + 1, true);
+			info->width = __get_16(buffer + 3, true);
+			info->components = buffer[5];
+			if( length < 6 + info->components * 3 )
+				break;
+			info->subsampling = __get_subsampling(buffer, info->components);
+			info->progressive = (marker == 0xC2 || marker == 0xC6 || marker == 0xCA || marker == 0xCE);
+			has_frame = true;
+		}else if( marker == _MARKER_DRI && length >= 2 ){
+			if( !__read(reader, buffer, 2) || !__skip(reader, length - 2) )
+				break;
+			info->restart_interval = __get_16(buffer, true);
+		}else if( marker == _MARKER_APP1 && !has_exif && length >= 6 + 8 ){
+			segment = _image_util_malloc(length);
+			if( segment == NULL )
+				return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+			if( !__read(reader, segment, length) ){
+				_image_util_free(segment);
+				break;
+			}
+			if( memcmp(segment, "Exif\0\0", 6) == 0 ){
+				info->orientation = __get_exif_orientation(segment, length);
+				has_exif = true;
+			}
+			_image_util_free(segment);
+		}else if( !__skip(reader, length) ){
+			break;
+		}
+	}
+
+	if( !has_frame || info->width <= 0 || info->components <= 0 ){
+		LOGE("[%s] no frame header", __func__);
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* the first EXIF segment, NULL when there is none or it has no thumbnail */
+static int __read_thumbnail(_jpeg_reader_s *reader, unsigned char **segment, unsigned int *offset, unsigned int *length)
+{
+	unsigned char *exif;
+	int marker, size;
+
+	*segment = NULL;
+	if( !__read_soi(reader) )
+		return IMAGE_UTIL_ERROR_INVALID_OPERATION;
+
+	while( __next_segment(reader, &marker, &size) ){
+		if( marker != _MARKER_APP1 || size < 6 + 8 ){
+			if( !__skip(reader, size) )
+				break;
+			continue;
+		}
+		exif = _image_util_malloc(size);
+		if( exif == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		if( !__read(reader, exif, size) ){
+			_image_util_free(exif);
+			break;
+		}
+		if( memcmp(exif, "Exif\0\0", 6) != 0 ){
+			_image_util_free(exif);
+			continue;
+		}
+		if( __get_exif_thumbnail(exif, size, offset, length) )
+			*segment = exif;
+		else
+			_image_util_free(exif);
+		break;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __open_reader(const char *path, const unsigned char *buffer, unsigned int size, _jpeg_reader_s *reader)
+{
+	memset(reader, 0, sizeof(_jpeg_reader_s));
+	if( path ){
+		reader->fp = fopen(path, "rb");
+		if( reader->fp == NULL ){
+			LOGE("[%s] can not open %s", __func__, path);
+			return IMAGE_UTIL_ERROR_NO_SUCH_FILE;
+		}
+	}else{
+		reader->data = buffer;
+		reader->size = size;
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_jpeg_get_info(const char *path, const unsigned char *buffer, unsigned int size, image_util_jpeg_info_s *info)
+{
+	_jpeg_reader_s reader;
+	int ret;
+
+	if( info == NULL || (path == NULL && buffer == NULL) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	ret = __open_reader(path, buffer, size, &reader);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	memset(info, 0, sizeof(image_util_jpeg_info_s));
+	info->orientation = 1;
+	ret = __read_info(&reader, info);
+
+	if( reader.fp )
+		fclose(reader.fp);
+	return ret;
+}
+
+int _image_util_jpeg_get_thumbnail(const char *path, const unsigned char *buffer, unsigned int size, unsigned char **segment, unsigned int *offset, unsigned int *length)
+{
+	_jpeg_reader_s reader;
+	int ret;
+
+	if( segment == NULL || offset == NULL || length == NULL || (path == NULL && buffer == NULL) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	ret = __open_reader(path, buffer, size, &reader);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	ret = __read_thumbnail(&reader, segment, offset, length);
+
+	if( reader.fp )
+		fclose(reader.fp);
+	return ret;
+}
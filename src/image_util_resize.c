@@ -0,0 +1,627 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Separable resampling. Each plane is filtered horizontally into 8bit rows,
+ * which are kept in a small ring, and each destination row is then filtered
+ * vertically from the ring. The filters except nearest are widened by the
+ * scale factor when downscaling so that every source pixel contributes.
+ *
+ * The coefficients of an axis are quantized to 14bit fixed point and padded
+ * to the same number of taps for every output pixel. Taps never reach past
+ * the source edge, so the filters can read them without bounds checks. The
+ * sums are exact integers, so the vector kernels give the same bytes as the
+ * C ones below.
+ *
+ * The plans of the last few geometries are kept, callers that resize many
+ * frames of the same sizes then skip computing the coefficients. A resizer
+ * is never changed once made, so one can be used by any number of threads.
+ */
+
+#define _RESIZE_PRECISION	IMAGE_UTIL_RESIZE_PRECISION
+#define _RESIZE_PADDING		8		/* zero weights after the last output, for the vector kernels */
+#define _RESIZER_CACHE_SIZE	8
+#define _RESIZE_STATE_SIZE	((sizeof(image_util_resize_state_s) + 63) & ~(size_t)63)	/* the rows follow the state */
+
+typedef struct
+{
+	int src_size;
+	int dest_size;
+	int taps;
+	int *start;		/* first source index of every output */
+	short *weights;		/* dest_size * taps coefficients */
+} _resize_plan_s;
+
+struct _image_util_resizer_s
+{
+	image_util_colorspace_e colorspace;
+	image_util_resize_filter_e filter;
+	int src_width;
+	int src_height;
+	int dest_width;
+	int dest_height;
+	int num_planes;
+	int channels[IMAGE_UTIL_MAX_PLANES];
+	int dest_rows[IMAGE_UTIL_MAX_PLANES];
+	_resize_plan_s *h_plan[IMAGE_UTIL_MAX_PLANES];
+	_resize_plan_s *v_plan[IMAGE_UTIL_MAX_PLANES];
+	int refs;				/* users and the cache, under the cache lock */
+	unsigned int last_used;
+};
+
+struct _image_util_resize_state_s
+{
+	unsigned char **ring[IMAGE_UTIL_MAX_PLANES];
+	int next[IMAGE_UTIL_MAX_PLANES];
+	void *block;
+};
+
+typedef struct
+{
+	const image_util_planes_s *dest;
+	const image_util_planes_s *src;
+	image_util_resizer_s *resizer;
+	int band;
+} _resize_job_s;
+
+static struct
+{
+	pthread_mutex_t lock;
+	image_util_resizer_s *entries[_RESIZER_CACHE_SIZE];
+	unsigned int clock;
+} _resizer_cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+static double __bilinear_filter(double x)
+{
+	if( x < 0.0 )
+		x = -x;
+	if( x < 1.0 )
+		return 1.0 - x;
+	return 0.0;
+}
+
+/* Catmull-Rom, a = -0.5 */
+static double __bicubic_filter(double x)
+{
+	if( x < 0.0 )
+		x = -x;
+	if( x < 1.0 )
+		return (1.5 * x - 2.5) * x * x + 1.0;
+	if( x < 2.0 )
+		return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+	return 0.0;
+}
+
+static double __sinc(double x)
+{
+	if( x == 0.0 )
+		return 1.0;
+	x *= M_PI;
+	return sin(x) / x;
+}
+
+static double __lanczos_filter(double x)
+{
+	if( x > -3.0 && x < 3.0 )
+		return __sinc(x) * __sinc(x / 3.0);
+	return 0.0;
+}
+
+/* how far from the center of an output its taps reach, in source pixels */
+static double __get_radius(image_util_resize_filter_e filter, double scale)
+{
+	double filter_scale = (scale > 1.0) ? scale : 1.0;
+
+	switch( filter ){
+		case IMAGE_UTIL_RESIZE_FILTER_BICUBIC:
+			return 2.0 * filter_scale;
+		case IMAGE_UTIL_RESIZE_FILTER_LANCZOS:
+			return 3.0 * filter_scale;
+		case IMAGE_UTIL_RESIZE_FILTER_AREA:
+			/* the output covers scale source pixels, the edge ones partly */
+			return scale / 2.0 + 0.5;
+		default:
+			return filter_scale;
+	}
+}
+
+/* weight of the source pixel whose center is distance away from the center of an output */
+static double __get_weight(image_util_resize_filter_e filter, double scale, double distance)
+{
+	double filter_scale = (scale > 1.0) ? scale : 1.0;
+	double low, high;
+
+	switch( filter ){
+		case IMAGE_UTIL_RESIZE_FILTER_BICUBIC:
+			return __bicubic_filter(distance / filter_scale);
+		case IMAGE_UTIL_RESIZE_FILTER_LANCZOS:
+			return __lanczos_filter(distance / filter_scale);
+		case IMAGE_UTIL_RESIZE_FILTER_AREA:
+			/* the part of the pixel inside the output */
+			low = (distance - 0.5 > -scale / 2.0) ? distance - 0.5 : -scale / 2.0;
+			high = (distance + 0.5 < scale / 2.0) ? distance + 0.5 : scale / 2.0;
+			return (high > low) ? high - low : 0.0;
+		default:
+			return __bilinear_filter(distance / filter_scale);
+	}
+}
+
+static void __destroy_plan(_resize_plan_s *plan)
+{
+	if( plan == NULL )
+		return;
+	_image_util_free(plan->start);
+	_image_util_free(plan->weights);
+	_image_util_free(plan);
+}
+
+static _resize_plan_s *__create_plan(int src_size, int dest_size, image_util_resize_filter_e filter)
+{
+	double scale = (double)src_size / dest_size;
+	double radius = __get_radius(filter, scale);
+	double *w = NULL;
+	_resize_plan_s *plan;
+	int i, k;
+
+	plan = _image_util_calloc(1, sizeof(_resize_plan_s));
+	if( plan == NULL )
+		return NULL;
+
+	plan->src_size = src_size;
+	plan->dest_size = dest_size;
+	plan->taps = (filter == IMAGE_UTIL_RESIZE_FILTER_NEAREST) ? 1 : (int)ceil(radius) * 2 + 1;
+	if( plan->taps > src_size )
+		plan->taps = src_size;
+
+	plan->start = _image_util_malloc(dest_size * sizeof(int));
+	plan->weights = _image_util_calloc(dest_size * plan->taps + _RESIZE_PADDING, sizeof(short));
+	w = _image_util_malloc(plan->taps * sizeof(double));
+	if( plan->start == NULL || plan->weights == NULL || w == NULL ){
+		_image_util_free(w);
+		__destroy_plan(plan);
+		return NULL;
+	}
+
+	for( i = 0 ; i < dest_size ; i++ ){
+		double center = (i + 0.5) * scale;
+		double total = 0.0;
+		int first = (int)floor(center - radius + 0.5);
+		int last = (int)floor(center + radius + 0.5);
+		int start, sum = 0, peak = 0;
+		short *q = plan->weights + i * plan->taps;
+
+		if( filter == IMAGE_UTIL_RESIZE_FILTER_NEAREST ){
+			first = (int)floor(center);
+			last = first + 1;
+		}
+		if( first < 0 )
+			first = 0;
+		if( last > src_size )
+			last = src_size;
+		if( last - first > plan->taps )
+			last = first + plan->taps;
+
+		/* keep all taps inside the source, the extra ones get zero weight */
+		start = first;
+		if( start + plan->taps > src_size )
+			start = src_size - plan->taps;
+		plan->start[i] = start;
+
+		for( k = 0 ; k < plan->taps ; k++ ){
+			int x = start + k;
+			if( filter == IMAGE_UTIL_RESIZE_FILTER_NEAREST )
+				w[k] = (x == first) ? 1.0 : 0.0;
+			else
+				w[k] = (x >= first && x < last) ? __get_weight(filter, scale, x + 0.5 - center) : 0.0;
+			total += w[k];
+		}
+		if( total <= 0.0 ){
+			/* e.g. a center exactly between two pixels of a 1 pixel wide filter */
+			w[first - start] = 1.0;
+			total = 1.0;
+		}
+
+		for( k = 0 ; k < plan->taps ; k++ ){
+			q[k] = (short)floor(w[k] / total * (1 << _RESIZE_PRECISION) + 0.5);
+			sum += q[k];
+			if( q[k] > q[peak] )
+				peak = k;
+		}
+		/* flat areas must stay flat */
+		q[peak] += (1 << _RESIZE_PRECISION) - sum;
+	}
+
+	_image_util_free(w);
+	return plan;
+}
+
+
+static inline unsigned char __clamp_fixed(int sum)
+{
+	sum >>= _RESIZE_PRECISION;
+	return (sum < 0) ? 0 : ((sum > 255) ? 255 : sum);
+}
+
+void _image_util_resize_row_h_c(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size, int channels)
+{
+	int x, c, k;
+
+	for( x = 0 ; x < dest_size ; x++ ){
+		const short *w = weights + x * taps;
+		const unsigned char *s = src + start[x] * channels;
+		for( c = 0 ; c < channels ; c++ ){
+			int sum = 1 << (_RESIZE_PRECISION - 1);
+			for( k = 0 ; k < taps ; k++ )
+				sum += w[k] * s[k * channels + c];
+			*dest++ = __clamp_fixed(sum);
+		}
+	}
+}
+
+void _image_util_resize_row_v_c(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int size)
+{
+	int x, k;
+
+	for( x = 0 ; x < size ; x++ ){
+		int sum = 1 << (_RESIZE_PRECISION - 1);
+		for( k = 0 ; k < taps ; k++ )
+			sum += weights[k] * rows[k][x];
+		dest[x] = __clamp_fixed(sum);
+	}
+}
+
+static void __resize_row_h(const image_util_simd_ops_s *ops, unsigned char *dest, const unsigned char *src, const _resize_plan_s *plan, int channels)
+{
+	int x;
+
+	/* a single tap has the full weight, the pixel is copied as it is */
+	if( plan->taps == 1 ){
+		for( x = 0 ; x < plan->dest_size ; x++ )
+			memcpy(dest + x * channels, src + plan->start[x] * channels, channels);
+		return;
+	}
+	ops->resize_row_h(dest, src, plan->src_size, plan->start, plan->weights, plan->taps, plan->dest_size, channels);
+}
+
+static void __resize_row_v(const image_util_simd_ops_s *ops, unsigned char *dest, unsigned char * const *rows, const short *w, int taps, int size)
+{
+	if( taps == 1 ){
+		memcpy(dest, rows[0], size);
+		return;
+	}
+	ops->resize_row_v(dest, rows, w, taps, size);
+}
+
+/*
+ * Produces the destination rows [row_start, row_end) of one plane; dest points
+ * to row_start. The ring keeps the horizontally filtered rows [next - taps, next)
+ * between calls, so consecutive calls do not filter a source row twice.
+ */
+static void __resize_plane(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int channels, const _resize_plan_s *h_plan, const _resize_plan_s *v_plan, unsigned char **ring, int *next, int row_start, int row_end)
+{
+	const image_util_simd_ops_s *ops = _image_util_get_simd_ops();
+	int taps = v_plan->taps;
+	unsigned char **rows = ring + taps;
+	int row, k;
+
+	for( row = row_start ; row < row_end ; row++ ){
+		int first = v_plan->start[row];
+
+		if( first > *next || first < *next - taps )
+			*next = first;
+		for( ; *next < first + taps ; (*next)++ )
+			__resize_row_h(ops, ring[*next % taps], src + *next * src_stride, h_plan, channels);
+
+		for( k = 0 ; k < taps ; k++ )
+			rows[k] = ring[(first + k) % taps];
+		__resize_row_v(ops, dest + (row - row_start) * dest_stride, rows, v_plan->weights + row * taps, taps, h_plan->dest_size * channels);
+	}
+}
+
+
+bool _image_util_resize_supported(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height)
+{
+	if( !_image_util_is_native_size(src_width, src_height, colorspace) || !_image_util_is_native_size(dest_width, dest_height, colorspace) )
+		return false;
+
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+		case IMAGE_UTIL_COLORSPACE_I420:
+		case IMAGE_UTIL_COLORSPACE_NV12:
+		case IMAGE_UTIL_COLORSPACE_RGB888:
+		case IMAGE_UTIL_COLORSPACE_ARGB8888:
+		case IMAGE_UTIL_COLORSPACE_BGRA8888:
+		case IMAGE_UTIL_COLORSPACE_RGBA8888:
+		case IMAGE_UTIL_COLORSPACE_BGRX8888:
+			return true;
+		default:
+			/* RGB565 channels are not byte aligned, YUYV and UYVY pixels share chroma */
+			return false;
+	}
+}
+
+static void __resizer_destroy(image_util_resizer_s *resizer)
+{
+	int i;
+
+	if( resizer == NULL )
+		return;
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		__destroy_plan(resizer->h_plan[i]);
+		__destroy_plan(resizer->v_plan[i]);
+	}
+	_image_util_free(resizer);
+}
+
+static image_util_resizer_s *__resizer_create(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter)
+{
+	image_util_resizer_s *resizer;
+	int i;
+
+	if( !_image_util_resize_supported(colorspace, src_width, src_height, dest_width, dest_height) )
+		return NULL;
+
+	resizer = _image_util_calloc(1, sizeof(image_util_resizer_s));
+	if( resizer == NULL )
+		return NULL;
+
+	resizer->colorspace = colorspace;
+	resizer->filter = filter;
+	resizer->refs = 1;
+	resizer->src_width = src_width;
+	resizer->src_height = src_height;
+	resizer->dest_width = dest_width;
+	resizer->dest_height = dest_height;
+	resizer->num_planes = _image_util_get_num_planes(colorspace);
+
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		int src_elements, src_rows, dest_elements, bytes;
+
+		_image_util_get_plane_geometry(colorspace, i, src_width, src_height, &src_elements, &src_rows, &bytes);
+		_image_util_get_plane_geometry(colorspace, i, dest_width, dest_height, &dest_elements, &resizer->dest_rows[i], NULL);
+		resizer->channels[i] = bytes;
+		resizer->h_plan[i] = __create_plan(src_elements, dest_elements, filter);
+		resizer->v_plan[i] = __create_plan(src_rows, resizer->dest_rows[i], filter);
+		if( resizer->h_plan[i] == NULL || resizer->v_plan[i] == NULL ){
+			__resizer_destroy(resizer);
+			return NULL;
+		}
+	}
+
+	return resizer;
+}
+
+/* called with the cache lock held, takes a reference to a cached resizer for the sizes */
+static image_util_resizer_s *__resizer_lookup(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter)
+{
+	image_util_resizer_s *resizer;
+	int i;
+
+	for( i = 0 ; i < _RESIZER_CACHE_SIZE ; i++ ){
+		resizer = _resizer_cache.entries[i];
+		if( resizer && _image_util_resizer_matches(resizer, colorspace, src_width, src_height, dest_width, dest_height, filter) ){
+			resizer->refs++;
+			resizer->last_used = ++_resizer_cache.clock;
+			return resizer;
+		}
+	}
+	return NULL;
+}
+
+image_util_resizer_s *_image_util_resizer_get(image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter)
+{
+	image_util_resizer_s *resizer, *cached, *evicted = NULL;
+	int i, slot = 0;
+
+	pthread_mutex_lock(&_resizer_cache.lock);
+	resizer = __resizer_lookup(colorspace, src_width, src_height, dest_width, dest_height, filter);
+	pthread_mutex_unlock(&_resizer_cache.lock);
+	if( resizer )
+		return resizer;
+
+	/*
+	 * The plans are computed unlocked. Another thread missing the same sizes
+	 * may have cached its resizer meanwhile, then that one is used and ours is
+	 * dropped, so that every caller shares one resizer per geometry.
+	 */
+	resizer = __resizer_create(colorspace, src_width, src_height, dest_width, dest_height, filter);
+	if( resizer == NULL )
+		return NULL;
+
+	pthread_mutex_lock(&_resizer_cache.lock);
+	cached = __resizer_lookup(colorspace, src_width, src_height, dest_width, dest_height, filter);
+	if( cached ){
+		pthread_mutex_unlock(&_resizer_cache.lock);
+		__resizer_destroy(resizer);
+		return cached;
+	}
+	for( i = 0 ; i < _RESIZER_CACHE_SIZE ; i++ ){
+		if( _resizer_cache.entries[i] == NULL ){
+			slot = i;
+			break;
+		}
+		if( _resizer_cache.entries[i]->last_used < _resizer_cache.entries[slot]->last_used )
+			slot = i;
+	}
+	if( _resizer_cache.entries[slot] && --_resizer_cache.entries[slot]->refs == 0 )
+		evicted = _resizer_cache.entries[slot];
+	_resizer_cache.entries[slot] = resizer;
+	resizer->refs++;
+	resizer->last_used = ++_resizer_cache.clock;
+	pthread_mutex_unlock(&_resizer_cache.lock);
+
+	__resizer_destroy(evicted);
+	return resizer;
+}
+
+void _image_util_resizer_release(image_util_resizer_s *resizer)
+{
+	bool unused;
+
+	if( resizer == NULL )
+		return;
+	pthread_mutex_lock(&_resizer_cache.lock);
+	unused = (--resizer->refs == 0);
+	pthread_mutex_unlock(&_resizer_cache.lock);
+
+	if( unused )
+		__resizer_destroy(resizer);
+}
+
+void _image_util_resizer_flush(void)
+{
+	image_util_resizer_s *unused[_RESIZER_CACHE_SIZE];
+	int i, count = 0;
+
+	pthread_mutex_lock(&_resizer_cache.lock);
+	for( i = 0 ; i < _RESIZER_CACHE_SIZE ; i++ ){
+		if( _resizer_cache.entries[i] && --_resizer_cache.entries[i]->refs == 0 )
+			unused[count++] = _resizer_cache.entries[i];
+		_resizer_cache.entries[i] = NULL;
+	}
+	pthread_mutex_unlock(&_resizer_cache.lock);
+
+	for( i = 0 ; i < count ; i++ )
+		__resizer_destroy(unused[i]);
+}
+
+bool _image_util_resizer_matches(const image_util_resizer_s *resizer, image_util_colorspace_e colorspace, int src_width, int src_height, int dest_width, int dest_height, image_util_resize_filter_e filter)
+{
+	return resizer->colorspace == colorspace && resizer->filter == filter && resizer->src_width == src_width && resizer->src_height == src_height
+		&& resizer->dest_width == dest_width && resizer->dest_height == dest_height;
+}
+
+void _image_util_resize_state_destroy(image_util_resize_state_s *state)
+{
+	_image_util_pool_free(state);
+}
+
+image_util_resize_state_s *_image_util_resize_state_create(const image_util_resizer_s *resizer)
+{
+	image_util_resize_state_s *state;
+	unsigned char *p;
+	size_t size = 0;
+	int i, k;
+
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		int taps = resizer->v_plan[i]->taps;
+		size += 2 * taps * sizeof(unsigned char *) + taps * resizer->h_plan[i]->dest_size * resizer->channels[i];
+	}
+
+	/* the state and its rows are one block of the image pool, reused by the next run */
+	state = _image_util_pool_alloc(_RESIZE_STATE_SIZE + size);
+	if( state == NULL )
+		return NULL;
+	memset(state, 0, sizeof(image_util_resize_state_s));
+	state->block = (unsigned char *)state + _RESIZE_STATE_SIZE;
+
+	/* ring pointers and scratch for the vertical filter of all planes, then the ring rows */
+	p = state->block;
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		state->ring[i] = (unsigned char **)p;
+		p += 2 * resizer->v_plan[i]->taps * sizeof(unsigned char *);
+	}
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		int taps = resizer->v_plan[i]->taps;
+		int row_size = resizer->h_plan[i]->dest_size * resizer->channels[i];
+
+		for( k = 0 ; k < taps ; k++ ){
+			state->ring[i][k] = p;
+			p += row_size;
+		}
+		state->next[i] = 0;
+	}
+
+	return state;
+}
+
+int _image_util_resize_rows(const image_util_resizer_s *resizer, image_util_resize_state_s *state, const image_util_planes_s *dest, const image_util_planes_s *src, int row_start, int row_end)
+{
+	int i;
+
+	if( resizer == NULL || state == NULL || dest == NULL || src == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( row_start < 0 || (row_start & 1) || row_end > resizer->dest_height || row_start >= row_end )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	for( i = 0 ; i < resizer->num_planes ; i++ ){
+		/* rows start even, so subsampled planes are split at half the luma rows */
+		int shift = (resizer->dest_rows[i] < resizer->dest_height) ? 1 : 0;
+		int first = row_start >> shift;
+		int last = (row_end + shift) >> shift;
+
+		__resize_plane(dest->data[i], dest->stride[i], src->data[i], src->stride[i], resizer->channels[i], resizer->h_plan[i], resizer->v_plan[i], state->ring[i], &state->next[i], first, last);
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __resize_band(void *data, int index)
+{
+	_resize_job_s *job = data;
+	image_util_planes_s dest;
+	image_util_resize_state_s *state;
+	int row_start = index * job->band;
+	int row_end = row_start + job->band;
+	int ret;
+
+	if( row_end > job->resizer->dest_height )
+		row_end = job->resizer->dest_height;
+
+	state = _image_util_resize_state_create(job->resizer);
+	if( state == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	_image_util_get_crop_planes(job->resizer->colorspace, job->dest, 0, row_start, &dest);
+	ret = _image_util_resize_rows(job->resizer, state, &dest, job->src, row_start, row_end);
+
+	_image_util_resize_state_destroy(state);
+	return ret;
+}
+
+int _image_util_resize(const image_util_planes_s *dest, int dest_width, int dest_height, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e colorspace, image_util_resize_filter_e filter)
+{
+	_resize_job_s job;
+	int ret;
+
+	if( dest == NULL || src == NULL || !_image_util_resize_supported(colorspace, src_width, src_height, dest_width, dest_height) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	job.dest = dest;
+	job.src = src;
+	job.resizer = _image_util_resizer_get(colorspace, src_width, src_height, dest_width, dest_height, filter);
+	if( job.resizer == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	job.band = _image_util_get_band_size(dest_height, 2, 16);
+	ret = _image_util_parallel_for((dest_height + job.band - 1) / job.band, __resize_band, &job);
+
+	_image_util_resizer_release(job.resizer);
+	return ret;
+}
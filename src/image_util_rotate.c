@@ -0,0 +1,419 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Every plane is rotated as an array of elements: pixels, NV12 chroma pairs.
+ * A destination row is gathered from the source with a constant step.
+ *
+ * 90 and 270 degrees are transposes, of the source upside down or into the
+ * destination upside down. They run in square tiles, so that both the source
+ * rows and the destination rows of a tile stay in cache and in the TLB, and
+ * the vector kernels transpose the tiles in blocks of 8x8 elements held in
+ * registers.
+ *
+ * In place, 180 degrees and the flips swap rows from both ends through a
+ * copy of one row. A square plane is turned by 90 or 270 degrees in blocks
+ * of its top left quarter: a block and its three images under the turn are
+ * moved around the cycle through a copy of one of them.
+ */
+
+#define _ROTATE_TILE	64
+
+typedef struct
+{
+	const image_util_planes_s *dest;
+	const image_util_planes_s *src;
+	image_util_colorspace_e colorspace;
+	int width;
+	int height;
+	image_util_rotation_e rotation;
+	int band;
+	int dest_height;
+} _rotate_job_s;
+
+typedef struct
+{
+	const image_util_planes_s *planes;
+	image_util_colorspace_e colorspace;
+	int width;
+	int height;
+	image_util_rotation_e rotation;
+	int units;		/* of the first plane, split into bands */
+	int band;
+	int tmp_size;
+} _rotate_in_place_job_s;
+
+
+bool _image_util_rotate_supported(image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation)
+{
+	if( !_image_util_is_native_size(width, height, colorspace) )
+		return false;
+
+	switch( colorspace ){
+		case IMAGE_UTIL_COLORSPACE_YV12:
+		case IMAGE_UTIL_COLORSPACE_I420:
+		case IMAGE_UTIL_COLORSPACE_NV12:
+		case IMAGE_UTIL_COLORSPACE_RGB565:
+		case IMAGE_UTIL_COLORSPACE_RGB888:
+		case IMAGE_UTIL_COLORSPACE_ARGB8888:
+		case IMAGE_UTIL_COLORSPACE_BGRA8888:
+		case IMAGE_UTIL_COLORSPACE_RGBA8888:
+		case IMAGE_UTIL_COLORSPACE_BGRX8888:
+			return true;
+		case IMAGE_UTIL_COLORSPACE_YUV422:
+			/* 4:2:2 chroma would have to be resampled to turn by 90 degrees */
+			return rotation != IMAGE_UTIL_ROTATION_90 && rotation != IMAGE_UTIL_ROTATION_270;
+		default:
+			return false;
+	}
+}
+
+bool _image_util_rotate_in_place_supported(image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation)
+{
+	if( (rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270) && width != height )
+		return false;
+	return _image_util_rotate_supported(colorspace, width, height, rotation);
+}
+
+static void __gather_row(unsigned char *d, const unsigned char *s, int step, int count, int bytes)
+{
+	int x;
+
+	if( step == bytes ){
+		memcpy(d, s, count * bytes);
+		return;
+	}
+
+	switch( bytes ){
+		case 1:
+			for( x = 0 ; x < count ; x++, s += step )
+				d[x] = *s;
+			break;
+		case 2:
+			for( x = 0 ; x < count ; x++, s += step, d += 2 )
+				memcpy(d, s, 2);
+			break;
+		case 4:
+			for( x = 0 ; x < count ; x++, s += step, d += 4 )
+				memcpy(d, s, 4);
+			break;
+		default:
+			for( x = 0 ; x < count ; x++, s += step, d += bytes )
+				memcpy(d, s, bytes);
+			break;
+	}
+}
+
+void _image_util_transpose_c(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int width, int height, int bytes)
+{
+	int x;
+
+	for( x = 0 ; x < width ; x++ )
+		__gather_row(dest + x * dest_stride, src + x * bytes, src_stride, height, bytes);
+}
+
+/*
+ * Rotates the destination rows [row_start, row_end) of one plane whose source
+ * is width x height elements.
+ */
+static void __rotate_plane(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int width, int height, int bytes, image_util_rotation_e rotation, int row_start, int row_end)
+{
+	int dest_width = (rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270) ? height : width;
+	int row, col;
+
+	if( rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270 ){
+		const image_util_simd_ops_s *ops = _image_util_get_simd_ops();
+		int first = row_start, last = row_end;
+
+		if( rotation == IMAGE_UTIL_ROTATION_90 ){
+			src += (height - 1) * src_stride;
+			src_stride = -src_stride;
+		}else{
+			dest += (width - 1) * dest_stride;
+			dest_stride = -dest_stride;
+			first = width - row_end;
+			last = width - row_start;
+		}
+
+		/* destination row r of the transpose is source column r */
+		for( row = first ; row < last ; row += _ROTATE_TILE ){
+			int rows = (last - row < _ROTATE_TILE) ? last - row : _ROTATE_TILE;
+			for( col = 0 ; col < dest_width ; col += _ROTATE_TILE ){
+				int cols = (dest_width - col < _ROTATE_TILE) ? dest_width - col : _ROTATE_TILE;
+				ops->transpose(dest + row * dest_stride + col * bytes, dest_stride, src + col * src_stride + row * bytes, src_stride, rows, cols, bytes);
+			}
+		}
+		return;
+	}
+
+	for( row = row_start ; row < row_end ; row++ ){
+		unsigned char *d = dest + row * dest_stride;
+		switch( rotation ){
+			case IMAGE_UTIL_ROTATION_180:
+				__gather_row(d, src + (height - 1 - row) * src_stride + (width - 1) * bytes, -bytes, width, bytes);
+				break;
+			case IMAGE_UTIL_ROTATION_FLIP_HORZ:
+				__gather_row(d, src + row * src_stride + (width - 1) * bytes, -bytes, width, bytes);
+				break;
+			case IMAGE_UTIL_ROTATION_FLIP_VERT:
+				__gather_row(d, src + (height - 1 - row) * src_stride, bytes, width, bytes);
+				break;
+			default:
+				__gather_row(d, src + row * src_stride, bytes, width, bytes);
+				break;
+		}
+	}
+}
+
+static int __rotate_band(void *data, int index)
+{
+	_rotate_job_s *job = data;
+	int row_start = index * job->band;
+	int row_end = row_start + job->band;
+	int i;
+
+	if( row_end > job->dest_height )
+		row_end = job->dest_height;
+
+	for( i = 0 ; i < _image_util_get_num_planes(job->colorspace) ; i++ ){
+		int elements, rows, bytes, dest_rows, shift;
+
+		_image_util_get_plane_geometry(job->colorspace, i, job->width, job->height, &elements, &rows, &bytes);
+		/* bands are even, so subsampled planes are split at half the luma rows */
+		dest_rows = (job->rotation == IMAGE_UTIL_ROTATION_90 || job->rotation == IMAGE_UTIL_ROTATION_270) ? elements : rows;
+		shift = (dest_rows < job->dest_height) ? 1 : 0;
+
+		__rotate_plane(job->dest->data[i], job->dest->stride[i], job->src->data[i], job->src->stride[i], elements, rows, bytes, job->rotation, row_start >> shift, row_end >> shift);
+	}
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static bool __is_same_planes(const image_util_planes_s *dest, const image_util_planes_s *src, image_util_colorspace_e colorspace)
+{
+	int i;
+
+	for( i = 0 ; i < _image_util_get_num_planes(colorspace) ; i++ ){
+		if( dest->data[i] != src->data[i] || dest->stride[i] != src->stride[i] )
+			return false;
+	}
+	return true;
+}
+
+/* reverses the elements of a row through a copy in @a tmp */
+static void __reverse_row(unsigned char *row, unsigned char *tmp, int width, int bytes)
+{
+	memcpy(tmp, row, width * bytes);
+	__gather_row(row, tmp + (width - 1) * bytes, -bytes, width, bytes);
+}
+
+static void __swap_rows(unsigned char *a, unsigned char *b, unsigned char *tmp, int width, int bytes, bool reverse)
+{
+	memcpy(tmp, a, width * bytes);
+	if( reverse ){
+		__gather_row(a, b + (width - 1) * bytes, -bytes, width, bytes);
+		__gather_row(b, tmp + (width - 1) * bytes, -bytes, width, bytes);
+	}else{
+		memcpy(a, b, width * bytes);
+		memcpy(b, tmp, width * bytes);
+	}
+}
+
+/* turns a block of rows x cols elements by a quarter into cols x rows */
+static void __turn_block(const image_util_simd_ops_s *ops, unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int rows, int cols, int bytes, bool clockwise)
+{
+	if( clockwise )
+		ops->transpose(dest, dest_stride, src + (rows - 1) * src_stride, -src_stride, cols, rows, bytes);
+	else
+		ops->transpose(dest + (cols - 1) * dest_stride, -dest_stride, src, src_stride, cols, rows, bytes);
+}
+
+/*
+ * Turns the block of rows [r, r + a) and columns [c, c + b) of a square plane
+ * of size x size elements, and the three blocks it is turned onto.
+ */
+static void __turn_blocks(unsigned char *data, int stride, int size, int bytes, bool clockwise, int r, int c, int a, int b, unsigned char *tmp)
+{
+	const image_util_simd_ops_s *ops = _image_util_get_simd_ops();
+	unsigned char *block[4];
+	int rows[4], row, i;
+
+	/* block i + 1 is where block i goes clockwise, the blocks alternate between a x b and b x a */
+	block[0] = data + r * stride + c * bytes;
+	block[1] = data + c * stride + (size - r - a) * bytes;
+	block[2] = data + (size - r - a) * stride + (size - c - b) * bytes;
+	block[3] = data + (size - c - b) * stride + r * bytes;
+	rows[0] = rows[2] = a;
+	rows[1] = rows[3] = b;
+
+	if( clockwise ){
+		for( row = 0 ; row < b ; row++ )
+			memcpy(tmp + row * a * bytes, block[3] + row * stride, a * bytes);
+		for( i = 3 ; i > 0 ; i-- )
+			__turn_block(ops, block[i], stride, block[i - 1], stride, rows[i - 1], rows[i], bytes, true);
+		__turn_block(ops, block[0], stride, tmp, a * bytes, b, a, bytes, true);
+	}else{
+		for( row = 0 ; row < a ; row++ )
+			memcpy(tmp + row * b * bytes, block[0] + row * stride, b * bytes);
+		for( i = 0 ; i < 3 ; i++ )
+			__turn_block(ops, block[i], stride, block[i + 1], stride, rows[i + 1], rows[i], bytes, false);
+		__turn_block(ops, block[3], stride, tmp, b * bytes, a, b, bytes, false);
+	}
+}
+
+/* units of work of a plane: tile rows of the top left quarter, rows, or pairs of rows */
+static int __get_in_place_units(image_util_rotation_e rotation, int height)
+{
+	switch( rotation ){
+		case IMAGE_UTIL_ROTATION_90:
+		case IMAGE_UTIL_ROTATION_270:
+			return (height / 2 + _ROTATE_TILE - 1) / _ROTATE_TILE;
+		case IMAGE_UTIL_ROTATION_FLIP_HORZ:
+			return height;
+		default:
+			return (height + 1) / 2;
+	}
+}
+
+/* rotates the units [start, end) of one plane of width x height elements */
+static void __rotate_plane_in_place(unsigned char *data, int stride, int width, int height, int bytes, image_util_rotation_e rotation, int start, int end, unsigned char *tmp)
+{
+	/* the top left quarter of an odd size holds the extra middle column, not the middle element */
+	int quarter_height = height / 2, quarter_width = (width + 1) / 2;
+	int unit, col;
+
+	for( unit = start ; unit < end ; unit++ ){
+		unsigned char *row = data + unit * stride;
+		unsigned char *mirror = data + (height - 1 - unit) * stride;
+
+		switch( rotation ){
+			case IMAGE_UTIL_ROTATION_90:
+			case IMAGE_UTIL_ROTATION_270:
+			{
+				int r = unit * _ROTATE_TILE;
+				int a = (quarter_height - r < _ROTATE_TILE) ? quarter_height - r : _ROTATE_TILE;
+				for( col = 0 ; col < quarter_width ; col += _ROTATE_TILE ){
+					int b = (quarter_width - col < _ROTATE_TILE) ? quarter_width - col : _ROTATE_TILE;
+					__turn_blocks(data, stride, width, bytes, rotation == IMAGE_UTIL_ROTATION_90, r, col, a, b, tmp);
+				}
+				break;
+			}
+			case IMAGE_UTIL_ROTATION_180:
+				if( row == mirror )
+					__reverse_row(row, tmp, width, bytes);
+				else
+					__swap_rows(row, mirror, tmp, width, bytes, true);
+				break;
+			case IMAGE_UTIL_ROTATION_FLIP_HORZ:
+				__reverse_row(row, tmp, width, bytes);
+				break;
+			case IMAGE_UTIL_ROTATION_FLIP_VERT:
+				if( row != mirror )
+					__swap_rows(row, mirror, tmp, width, bytes, false);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+static int __rotate_in_place_band(void *data, int index)
+{
+	_rotate_in_place_job_s *job = data;
+	int unit_start = index * job->band;
+	int unit_end = unit_start + job->band;
+	unsigned char *tmp;
+	int i;
+
+	if( unit_end > job->units )
+		unit_end = job->units;
+
+	tmp = _image_util_malloc(job->tmp_size);
+	if( tmp == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	for( i = 0 ; i < _image_util_get_num_planes(job->colorspace) ; i++ ){
+		int elements, rows, bytes, units;
+
+		_image_util_get_plane_geometry(job->colorspace, i, job->width, job->height, &elements, &rows, &bytes);
+		/* subsampled planes have fewer units, a band takes the same share of them */
+		units = __get_in_place_units(job->rotation, rows);
+		__rotate_plane_in_place(job->planes->data[i], job->planes->stride[i], elements, rows, bytes, job->rotation, unit_start * units / job->units, unit_end * units / job->units, tmp);
+	}
+
+	_image_util_free(tmp);
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_rotate_in_place(const image_util_planes_s *planes, image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation)
+{
+	_rotate_in_place_job_s job;
+	int elements, rows, bytes;
+
+	if( planes == NULL || !_image_util_rotate_in_place_supported(colorspace, width, height, rotation) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( rotation == IMAGE_UTIL_ROTATION_NONE )
+		return IMAGE_UTIL_ERROR_NONE;
+
+	_image_util_get_plane_geometry(colorspace, 0, width, height, &elements, &rows, &bytes);
+	job.planes = planes;
+	job.colorspace = colorspace;
+	job.width = width;
+	job.height = height;
+	job.rotation = rotation;
+	job.units = __get_in_place_units(rotation, rows);
+	if( job.units == 0 )
+		return IMAGE_UTIL_ERROR_NONE;
+	/* a row of the widest plane or a block of 4 byte elements */
+	job.tmp_size = (elements * 4 > _ROTATE_TILE * _ROTATE_TILE * 4) ? elements * 4 : _ROTATE_TILE * _ROTATE_TILE * 4;
+	if( rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270 )
+		job.band = _image_util_get_band_size(job.units, 1, 1);
+	else
+		job.band = _image_util_get_band_size(job.units, 1, _ROTATE_TILE);
+
+	return _image_util_parallel_for((job.units + job.band - 1) / job.band, __rotate_in_place_band, &job);
+}
+
+int _image_util_rotate(const image_util_planes_s *dest, const image_util_planes_s *src, image_util_colorspace_e colorspace, int width, int height, image_util_rotation_e rotation)
+{
+	_rotate_job_s job;
+
+	if( dest == NULL || src == NULL || !_image_util_rotate_supported(colorspace, width, height, rotation) )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+	if( __is_same_planes(dest, src, colorspace) ){
+		if( !_image_util_rotate_in_place_supported(colorspace, width, height, rotation) )
+			return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+		return _image_util_rotate_in_place(dest, colorspace, width, height, rotation);
+	}
+
+	job.dest = dest;
+	job.src = src;
+	job.colorspace = colorspace;
+	job.width = width;
+	job.height = height;
+	job.rotation = rotation;
+	job.dest_height = (rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270) ? width : height;
+	job.band = _image_util_get_band_size(job.dest_height, _ROTATE_TILE, _ROTATE_TILE);
+
+	return _image_util_parallel_for((job.dest_height + job.band - 1) / job.band, __rotate_band, &job);
+}
@@ -0,0 +1,81 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The kernels are picked once per process from the CPU features.
+ * IMAGE_UTIL_SIMD=none|sse2|avx2 caps the selection, e.g. to compare
+ * the vector kernels against the C reference.
+ */
+
+static image_util_simd_ops_s _simd_ops = {
+	"c",
+	_image_util_yuv_to_rgb32_row_c,
+	_image_util_rgb32_to_y_row_c,
+	_image_util_rgb32_to_uv_row_c,
+	_image_util_resize_row_h_c,
+	_image_util_resize_row_v_c,
+	_image_util_transpose_c,
+};
+
+static pthread_once_t _simd_once = PTHREAD_ONCE_INIT;
+
+static bool __simd_allowed(const char *limit, const char *name)
+{
+	static const char *levels[] = { "none", "sse2", "avx2", NULL };
+	int i, limit_level = -1, name_level = -1;
+
+	if( limit == NULL )
+		return true;
+	if( strcmp(limit, name) == 0 )
+		return true;
+
+	for( i = 0 ; levels[i] ; i++ ){
+		if( strcmp(levels[i], limit) == 0 )
+			limit_level = i;
+		if( strcmp(levels[i], name) == 0 )
+			name_level = i;
+	}
+	return limit_level >= 0 && name_level >= 0 && name_level <= limit_level;
+}
+
+static void __init_simd_ops(void)
+{
+	const char *limit = getenv("IMAGE_UTIL_SIMD");
+
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports("sse2") && __simd_allowed(limit, "sse2") )
+		_image_util_simd_init_sse2(&_simd_ops);
+	if( __builtin_cpu_supports("avx2") && __simd_allowed(limit, "avx2") )
+		_image_util_simd_init_avx2(&_simd_ops);
+#endif
+
+	LOGI("[%s] using %s kernels", __func__, _simd_ops.name);
+}
+
+const image_util_simd_ops_s *_image_util_get_simd_ops(void)
+{
+	pthread_once(&_simd_once, __init_simd_ops);
+	return &_simd_ops;
+}
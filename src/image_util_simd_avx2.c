@@ -0,0 +1,234 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <image_util_private.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+/*
+ * Same arithmetic as the C and SSE2 kernels, 32 pixels per iteration.
+ * AVX2 packs and unpacks work per 128bit lane, hence the permutes.
+ */
+
+static inline void __store_rgb32x32(unsigned char *dst, __m256i r, __m256i g, __m256i b, __m256i a, const image_util_rgb32_order_s *order)
+{
+	__m256i c[4];
+	__m256i t0, t1, t2, t3, p0, p1, p2, p3;
+
+	c[order->r] = r;
+	c[order->g] = g;
+	c[order->b] = b;
+	c[order->a] = a;
+
+	t0 = _mm256_unpacklo_epi8(c[0], c[1]);
+	t1 = _mm256_unpackhi_epi8(c[0], c[1]);
+	t2 = _mm256_unpacklo_epi8(c[2], c[3]);
+	t3 = _mm256_unpackhi_epi8(c[2], c[3]);
+	p0 = _mm256_unpacklo_epi16(t0, t2);	/* pixels 0-3 | 16-19 */
+	p1 = _mm256_unpackhi_epi16(t0, t2);	/* pixels 4-7 | 20-23 */
+	p2 = _mm256_unpacklo_epi16(t1, t3);	/* pixels 8-11 | 24-27 */
+	p3 = _mm256_unpackhi_epi16(t1, t3);	/* pixels 12-15 | 28-31 */
+
+	_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(p0, p1, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+	_mm256_storeu_si256((__m256i *)(dst + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+static inline void __yuv_to_rgb_x16(__m256i y, __m256i u, __m256i v, __m256i *r, __m256i *g, __m256i *b)
+{
+	const __m256i round = _mm256_set1_epi16(32);
+
+	y = _mm256_slli_epi16(y, 6);
+	y = _mm256_add_epi16(y, _mm256_mulhi_epi16(_mm256_slli_epi16(y, 1), _mm256_set1_epi16(5374)));
+	*r = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(y, _mm256_mullo_epi16(v, _mm256_set1_epi16(102))), round), 6);
+	*g = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_subs_epi16(_mm256_subs_epi16(y, _mm256_mullo_epi16(u, _mm256_set1_epi16(25))), _mm256_mullo_epi16(v, _mm256_set1_epi16(52))), round), 6);
+	*b = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(y, _mm256_mullo_epi16(u, _mm256_set1_epi16(129))), round), 6);
+}
+
+static inline __m256i __pack_u8(__m256i lo, __m256i hi)
+{
+	return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+}
+
+static void __yuv_to_rgb32_row_avx2(const unsigned char *y, const unsigned char *u, const unsigned char *v, unsigned char *dst, int width, const image_util_rgb32_order_s *order)
+{
+	const __m256i y_off = _mm256_set1_epi16(16);
+	const __m256i c_off = _mm256_set1_epi16(128);
+	const __m256i alpha = _mm256_set1_epi8((char)0xff);
+	int x;
+
+	for( x = 0 ; x + 32 <= width ; x += 32 ){
+		__m128i y8l = _mm_loadu_si128((const __m128i *)(y + x));
+		__m128i y8h = _mm_loadu_si128((const __m128i *)(y + x + 16));
+		__m256i u16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(u + (x >> 1)))), c_off);
+		__m256i v16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(v + (x >> 1)))), c_off);
+		__m256i r0, g0, b0, r1, g1, b1;
+
+		/* chroma 0-3,8-11 | 4-7,12-15 so that the lane local unpacks duplicate in pixel order */
+		u16 = _mm256_permute4x64_epi64(u16, 0xd8);
+		v16 = _mm256_permute4x64_epi64(v16, 0xd8);
+
+		__yuv_to_rgb_x16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(y8l), y_off), _mm256_unpacklo_epi16(u16, u16), _mm256_unpacklo_epi16(v16, v16), &r0, &g0, &b0);
+		__yuv_to_rgb_x16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(y8h), y_off), _mm256_unpackhi_epi16(u16, u16), _mm256_unpackhi_epi16(v16, v16), &r1, &g1, &b1);
+
+		__store_rgb32x32(dst + 4 * x, __pack_u8(r0, r1), __pack_u8(g0, g1), __pack_u8(b0, b1), alpha, order);
+	}
+
+	if( x < width )
+		_image_util_yuv_to_rgb32_row_c(y + x, u + (x >> 1), v + (x >> 1), dst + 4 * x, width - x, order);
+}
+
+static inline __m256i __channel_x8(__m256i p, int offset)
+{
+	return _mm256_and_si256(_mm256_srl_epi32(p, _mm_cvtsi32_si128(offset * 8)), _mm256_set1_epi32(0xff));
+}
+
+/* Y of 16 pixels as 16bit lanes, in the lane order of _mm256_packs_epi32 */
+static inline __m256i __y_x16(const unsigned char *src, const image_util_rgb32_order_s *order)
+{
+	__m256i p0 = _mm256_loadu_si256((const __m256i *)src);
+	__m256i p1 = _mm256_loadu_si256((const __m256i *)(src + 32));
+	__m256i r = _mm256_packs_epi32(__channel_x8(p0, order->r), __channel_x8(p1, order->r));
+	__m256i g = _mm256_packs_epi32(__channel_x8(p0, order->g), __channel_x8(p1, order->g));
+	__m256i b = _mm256_packs_epi32(__channel_x8(p0, order->b), __channel_x8(p1, order->b));
+	__m256i sum;
+
+	sum = _mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(66)), _mm256_mullo_epi16(g, _mm256_set1_epi16(129)));
+	sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b, _mm256_set1_epi16(25)));
+	sum = _mm256_add_epi16(sum, _mm256_set1_epi16(0x1080));
+	return _mm256_srli_epi16(sum, 8);
+}
+
+static void __rgb32_to_y_row_avx2(const unsigned char *src, unsigned char *y, int width, const image_util_rgb32_order_s *order)
+{
+	const __m256i fix = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int x;
+
+	for( x = 0 ; x + 32 <= width ; x += 32 ){
+		__m256i y0 = __y_x16(src + 4 * x, order);
+		__m256i y1 = __y_x16(src + 4 * x + 64, order);
+		_mm256_storeu_si256((__m256i *)(y + x), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(y0, y1), fix));
+	}
+
+	if( x < width )
+		_image_util_rgb32_to_y_row_c(src + 4 * x, y + x, width - x, order);
+}
+
+/* pair averages of one channel for 16 pixels, as 32bit lanes: pairs 0,1,4,5 | 2,3,6,7 */
+static inline __m256i __pair_avg_x8(__m256i p0, __m256i p1, int offset)
+{
+	__m256i sum = _mm256_hadd_epi32(__channel_x8(p0, offset), __channel_x8(p1, offset));
+	return _mm256_srli_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(1)), 1);
+}
+
+static void __rgb32_to_uv_row_avx2(const unsigned char *src, unsigned char *u, unsigned char *v, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+
+	for( x = 0 ; x + 32 <= width ; x += 32 ){
+		const unsigned char *s = src + 4 * x;
+		__m256i p0 = _mm256_loadu_si256((const __m256i *)s);
+		__m256i p1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+		__m256i p2 = _mm256_loadu_si256((const __m256i *)(s + 64));
+		__m256i p3 = _mm256_loadu_si256((const __m256i *)(s + 96));
+		/* pairs 0,1,4,5,8,9,12,13 | 2,3,6,7,10,11,14,15 */
+		__m256i r = _mm256_packs_epi32(__pair_avg_x8(p0, p1, order->r), __pair_avg_x8(p2, p3, order->r));
+		__m256i g = _mm256_packs_epi32(__pair_avg_x8(p0, p1, order->g), __pair_avg_x8(p2, p3, order->g));
+		__m256i b = _mm256_packs_epi32(__pair_avg_x8(p0, p1, order->b), __pair_avg_x8(p2, p3, order->b));
+		__m256i uu, vv;
+
+		uu = _mm256_sub_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(112)), _mm256_mullo_epi16(r, _mm256_set1_epi16(38)));
+		uu = _mm256_sub_epi16(uu, _mm256_mullo_epi16(g, _mm256_set1_epi16(74)));
+		uu = _mm256_srli_epi16(_mm256_add_epi16(uu, _mm256_set1_epi16((short)0x8080)), 8);
+		vv = _mm256_sub_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(112)), _mm256_mullo_epi16(g, _mm256_set1_epi16(94)));
+		vv = _mm256_sub_epi16(vv, _mm256_mullo_epi16(b, _mm256_set1_epi16(18)));
+		vv = _mm256_srli_epi16(_mm256_add_epi16(vv, _mm256_set1_epi16((short)0x8080)), 8);
+
+		uu = _mm256_packus_epi16(uu, uu);
+		vv = _mm256_packus_epi16(vv, vv);
+		_mm_storeu_si128((__m128i *)(u + (x >> 1)), _mm_unpacklo_epi16(_mm256_castsi256_si128(uu), _mm256_extracti128_si256(uu, 1)));
+		_mm_storeu_si128((__m128i *)(v + (x >> 1)), _mm_unpacklo_epi16(_mm256_castsi256_si128(vv), _mm256_extracti128_si256(vv, 1)));
+	}
+
+	if( x < width )
+		_image_util_rgb32_to_uv_row_c(src + 4 * x, u + (x >> 1), v + (x >> 1), width - x, order);
+}
+
+/*
+ * The vertical resize pass, 32 pixels per step. The horizontal one gathers
+ * too few pixels per output to gain from the wider registers and is left to
+ * the SSE2 kernel.
+ */
+static inline void __resize_v32_avx2(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int x)
+{
+	__m256i s0, s1, s2, s3, r0, r1;
+	int k;
+
+	s0 = s1 = s2 = s3 = _mm256_set1_epi32(1 << (IMAGE_UTIL_RESIZE_PRECISION - 1));
+	for( k = 0 ; k < taps ; k += 2 ){
+		__m256i a = _mm256_loadu_si256((const __m256i *)(rows[k] + x));
+		__m256i b = (k + 1 < taps) ? _mm256_loadu_si256((const __m256i *)(rows[k + 1] + x)) : _mm256_setzero_si256();
+		__m256i c = _mm256_set1_epi32((int)((unsigned short)weights[k] | ((unsigned int)(unsigned short)((k + 1 < taps) ? weights[k + 1] : 0) << 16)));
+		__m256i a0 = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)), a1 = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1));
+		__m256i b0 = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b)), b1 = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1));
+
+		s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a0, b0), c));
+		s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a0, b0), c));
+		s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi16(a1, b1), c));
+		s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi16(a1, b1), c));
+	}
+	/* the unpacks and packs work per lane, so they restore the pixel order but for the 64bit quarters */
+	r0 = _mm256_packs_epi32(_mm256_srai_epi32(s0, IMAGE_UTIL_RESIZE_PRECISION), _mm256_srai_epi32(s1, IMAGE_UTIL_RESIZE_PRECISION));
+	r1 = _mm256_packs_epi32(_mm256_srai_epi32(s2, IMAGE_UTIL_RESIZE_PRECISION), _mm256_srai_epi32(s3, IMAGE_UTIL_RESIZE_PRECISION));
+	r0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(r0, r1), _MM_SHUFFLE(3, 1, 2, 0));
+	_mm256_storeu_si256((__m256i *)(dest + x), r0);
+}
+
+static void __resize_row_v_avx2(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int size)
+{
+	int x;
+
+	if( size < 32 ){
+		_image_util_resize_row_v_c(dest, rows, weights, taps, size);
+		return;
+	}
+	for( x = 0 ; x + 32 <= size ; x += 32 )
+		__resize_v32_avx2(dest, rows, weights, taps, x);
+	/* the last pixels again with the ones before, the rows do not overlap dest */
+	if( x < size )
+		__resize_v32_avx2(dest, rows, weights, taps, size - 32);
+}
+
+bool _image_util_simd_init_avx2(image_util_simd_ops_s *ops)
+{
+	ops->name = "avx2";
+	ops->yuv_to_rgb32_row = __yuv_to_rgb32_row_avx2;
+	ops->rgb32_to_y_row = __rgb32_to_y_row_avx2;
+	ops->rgb32_to_uv_row = __rgb32_to_uv_row_avx2;
+	ops->resize_row_v = __resize_row_v_avx2;
+	return true;
+}
+
+#else
+
+bool _image_util_simd_init_avx2(image_util_simd_ops_s *ops)
+{
+	return false;
+}
+
+#endif
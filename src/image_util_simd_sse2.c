@@ -0,0 +1,439 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <image_util_private.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include <string.h>
+
+/*
+ * The vector kernels use the same fixed point arithmetic as the C kernels in
+ * image_util_convert.c and image_util_resize.c and produce bit identical results.
+ */
+
+static inline void __store_rgb32x16(unsigned char *dst, __m128i r, __m128i g, __m128i b, __m128i a, const image_util_rgb32_order_s *order)
+{
+	__m128i c[4];
+	__m128i t0, t1, t2, t3;
+
+	c[order->r] = r;
+	c[order->g] = g;
+	c[order->b] = b;
+	c[order->a] = a;
+
+	t0 = _mm_unpacklo_epi8(c[0], c[1]);
+	t1 = _mm_unpackhi_epi8(c[0], c[1]);
+	t2 = _mm_unpacklo_epi8(c[2], c[3]);
+	t3 = _mm_unpackhi_epi8(c[2], c[3]);
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(t0, t2));
+	_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(t0, t2));
+	_mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(t1, t3));
+	_mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(t1, t3));
+}
+
+static inline void __yuv_to_rgb_x8(__m128i y, __m128i u, __m128i v, __m128i *r, __m128i *g, __m128i *b)
+{
+	const __m128i round = _mm_set1_epi16(32);
+
+	y = _mm_slli_epi16(y, 6);
+	y = _mm_add_epi16(y, _mm_mulhi_epi16(_mm_slli_epi16(y, 1), _mm_set1_epi16(5374)));
+	*r = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(v, _mm_set1_epi16(102))), round), 6);
+	*g = _mm_srai_epi16(_mm_adds_epi16(_mm_subs_epi16(_mm_subs_epi16(y, _mm_mullo_epi16(u, _mm_set1_epi16(25))), _mm_mullo_epi16(v, _mm_set1_epi16(52))), round), 6);
+	*b = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(u, _mm_set1_epi16(129))), round), 6);
+}
+
+static void __yuv_to_rgb32_row_sse2(const unsigned char *y, const unsigned char *u, const unsigned char *v, unsigned char *dst, int width, const image_util_rgb32_order_s *order)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i y_off = _mm_set1_epi16(16);
+	const __m128i c_off = _mm_set1_epi16(128);
+	const __m128i alpha = _mm_set1_epi8((char)0xff);
+	int x;
+
+	for( x = 0 ; x + 16 <= width ; x += 16 ){
+		__m128i y8 = _mm_loadu_si128((const __m128i *)(y + x));
+		__m128i u16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + (x >> 1))), zero), c_off);
+		__m128i v16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + (x >> 1))), zero), c_off);
+		__m128i r0, g0, b0, r1, g1, b1;
+
+		__yuv_to_rgb_x8(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), y_off), _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), &r0, &g0, &b0);
+		__yuv_to_rgb_x8(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), y_off), _mm_unpackhi_epi16(u16, u16), _mm_unpackhi_epi16(v16, v16), &r1, &g1, &b1);
+
+		__store_rgb32x16(dst + 4 * x, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1), alpha, order);
+	}
+
+	if( x < width )
+		_image_util_yuv_to_rgb32_row_c(y + x, u + (x >> 1), v + (x >> 1), dst + 4 * x, width - x, order);
+}
+
+/* extracts one channel of 8 pixels as 16bit lanes */
+static inline __m128i __channel_x8(__m128i p0, __m128i p1, int offset)
+{
+	const __m128i mask = _mm_set1_epi32(0xff);
+	__m128i shift = _mm_cvtsi32_si128(offset * 8);
+
+	return _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(p0, shift), mask), _mm_and_si128(_mm_srl_epi32(p1, shift), mask));
+}
+
+static inline __m128i __y_x8(const unsigned char *src, const image_util_rgb32_order_s *order)
+{
+	__m128i p0 = _mm_loadu_si128((const __m128i *)src);
+	__m128i p1 = _mm_loadu_si128((const __m128i *)(src + 16));
+	__m128i r = __channel_x8(p0, p1, order->r);
+	__m128i g = __channel_x8(p0, p1, order->g);
+	__m128i b = __channel_x8(p0, p1, order->b);
+	__m128i sum;
+
+	sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+	sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+	sum = _mm_add_epi16(sum, _mm_set1_epi16(0x1080));
+	return _mm_srli_epi16(sum, 8);
+}
+
+static void __rgb32_to_y_row_sse2(const unsigned char *src, unsigned char *y, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+
+	for( x = 0 ; x + 16 <= width ; x += 16 ){
+		__m128i y0 = __y_x8(src + 4 * x, order);
+		__m128i y1 = __y_x8(src + 4 * x + 32, order);
+		_mm_storeu_si128((__m128i *)(y + x), _mm_packus_epi16(y0, y1));
+	}
+
+	if( x < width )
+		_image_util_rgb32_to_y_row_c(src + 4 * x, y + x, width - x, order);
+}
+
+/* averages horizontal pixel pairs of one channel: 16 pixels in, 8 values out */
+static inline __m128i __pair_avg_x8(__m128i c0, __m128i c1)
+{
+	const __m128i lo = _mm_set1_epi32(0xffff);
+	const __m128i one = _mm_set1_epi32(1);
+	__m128i s0 = _mm_add_epi32(_mm_and_si128(c0, lo), _mm_srli_epi32(c0, 16));
+	__m128i s1 = _mm_add_epi32(_mm_and_si128(c1, lo), _mm_srli_epi32(c1, 16));
+
+	s0 = _mm_srli_epi32(_mm_add_epi32(s0, one), 1);
+	s1 = _mm_srli_epi32(_mm_add_epi32(s1, one), 1);
+	return _mm_packs_epi32(s0, s1);
+}
+
+static void __rgb32_to_uv_row_sse2(const unsigned char *src, unsigned char *u, unsigned char *v, int width, const image_util_rgb32_order_s *order)
+{
+	int x;
+
+	for( x = 0 ; x + 16 <= width ; x += 16 ){
+		const unsigned char *s = src + 4 * x;
+		__m128i p0 = _mm_loadu_si128((const __m128i *)s);
+		__m128i p1 = _mm_loadu_si128((const __m128i *)(s + 16));
+		__m128i p2 = _mm_loadu_si128((const __m128i *)(s + 32));
+		__m128i p3 = _mm_loadu_si128((const __m128i *)(s + 48));
+		__m128i r = __pair_avg_x8(__channel_x8(p0, p1, order->r), __channel_x8(p2, p3, order->r));
+		__m128i g = __pair_avg_x8(__channel_x8(p0, p1, order->g), __channel_x8(p2, p3, order->g));
+		__m128i b = __pair_avg_x8(__channel_x8(p0, p1, order->b), __channel_x8(p2, p3, order->b));
+		__m128i uu, vv;
+
+		uu = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)), _mm_mullo_epi16(r, _mm_set1_epi16(38)));
+		uu = _mm_sub_epi16(uu, _mm_mullo_epi16(g, _mm_set1_epi16(74)));
+		uu = _mm_srli_epi16(_mm_add_epi16(uu, _mm_set1_epi16((short)0x8080)), 8);
+		vv = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)), _mm_mullo_epi16(g, _mm_set1_epi16(94)));
+		vv = _mm_sub_epi16(vv, _mm_mullo_epi16(b, _mm_set1_epi16(18)));
+		vv = _mm_srli_epi16(_mm_add_epi16(vv, _mm_set1_epi16((short)0x8080)), 8);
+
+		_mm_storel_epi64((__m128i *)(u + (x >> 1)), _mm_packus_epi16(uu, uu));
+		_mm_storel_epi64((__m128i *)(v + (x >> 1)), _mm_packus_epi16(vv, vv));
+	}
+
+	if( x < width )
+		_image_util_rgb32_to_uv_row_c(src + 4 * x, u + (x >> 1), v + (x >> 1), width - x, order);
+}
+
+/* two weights in the 16bit halves of an int, for _mm_madd_epi16() */
+static inline int __weight_pair(short low, short high)
+{
+	return (int)((unsigned short)low | ((unsigned int)(unsigned short)high << 16));
+}
+
+/* the fixed point sums of up to 4 channels as bytes */
+static inline int __pack_fixed(__m128i sum)
+{
+	sum = _mm_srai_epi32(sum, IMAGE_UTIL_RESIZE_PRECISION);
+	sum = _mm_packs_epi32(sum, sum);
+	return _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+}
+
+/*
+ * One channel: 8 taps per multiply, the taps past the last one are masked.
+ * The loads reach up to 7 pixels past the last tap, so the outputs whose
+ * taps end near the source edge are left to the C kernel.
+ */
+static void __resize_row_h1_sse2(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int chunks = (taps + 7) & ~7;
+	__m128i mask = _mm_cmpgt_epi16(_mm_set1_epi16(taps - chunks + 8), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+	int x, k;
+
+	for( x = 0 ; x < dest_size && start[x] + chunks <= src_size ; x++ ){
+		const short *w = weights + x * taps;
+		const unsigned char *s = src + start[x];
+		__m128i sum = _mm_setzero_si128();
+		int total;
+
+		for( k = 0 ; k < chunks ; k += 8 ){
+			__m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(s + k)), zero);
+			__m128i c = _mm_loadu_si128((const __m128i *)(w + k));
+			if( k + 8 == chunks )
+				c = _mm_and_si128(c, mask);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(p, c));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		total = (_mm_cvtsi128_si32(sum) + (1 << (IMAGE_UTIL_RESIZE_PRECISION - 1))) >> IMAGE_UTIL_RESIZE_PRECISION;
+		dest[x] = (total < 0) ? 0 : ((total > 255) ? 255 : total);
+	}
+
+	if( x < dest_size )
+		_image_util_resize_row_h_c(dest + x, src, src_size, start + x, weights + x * taps, taps, dest_size - x, 1);
+}
+
+/*
+ * 2 to 4 channels: two neighbouring pixels are read at once and their
+ * channels interleaved, so one multiply applies a pair of taps to every
+ * channel. The loads are 8 bytes, past the last tap for less than 4
+ * channels, so again the outputs near the source edge are left to C.
+ */
+static inline __attribute__((always_inline)) void __resize_row_hn_sse2(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size, int channels)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int last = (taps - 1) & ~1;
+	int x, k, pixel;
+
+	for( x = 0 ; x < dest_size && (start[x] + last) * channels + 8 <= src_size * channels ; x++ ){
+		const short *w = weights + x * taps;
+		const unsigned char *s = src + start[x] * channels;
+		__m128i sum = _mm_set1_epi32(1 << (IMAGE_UTIL_RESIZE_PRECISION - 1));
+
+		for( k = 0 ; k < taps ; k += 2 ){
+			__m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(s + k * channels)), zero);
+			int pair = __weight_pair(w[k], (k + 1 < taps) ? w[k + 1] : 0);
+
+			/* c0 of pixel k, c0 of pixel k + 1, c1 of pixel k, ... */
+			if( channels == 2 )
+				p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 4));
+			else if( channels == 3 )
+				p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 6));
+			else
+				p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(p, _mm_set1_epi32(pair)));
+		}
+		pixel = __pack_fixed(sum);
+		memcpy(dest + x * channels, &pixel, channels);
+	}
+
+	if( x < dest_size )
+		_image_util_resize_row_h_c(dest + x * channels, src, src_size, start + x, weights + x * taps, taps, dest_size - x, channels);
+}
+
+static void __resize_row_h_sse2(unsigned char *dest, const unsigned char *src, int src_size, const int *start, const short *weights, int taps, int dest_size, int channels)
+{
+	switch( channels ){
+		case 1:
+			__resize_row_h1_sse2(dest, src, src_size, start, weights, taps, dest_size);
+			break;
+		case 2:
+			__resize_row_hn_sse2(dest, src, src_size, start, weights, taps, dest_size, 2);
+			break;
+		case 3:
+			__resize_row_hn_sse2(dest, src, src_size, start, weights, taps, dest_size, 3);
+			break;
+		case 4:
+			__resize_row_hn_sse2(dest, src, src_size, start, weights, taps, dest_size, 4);
+			break;
+		default:
+			_image_util_resize_row_h_c(dest, src, src_size, start, weights, taps, dest_size, channels);
+			break;
+	}
+}
+
+/* 16 pixels of rows [k, k + 1) per step, the rows interleaved so one multiply applies two taps */
+static inline void __resize_v16_sse2(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int x)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i s0, s1, s2, s3;
+	int k;
+
+	s0 = s1 = s2 = s3 = _mm_set1_epi32(1 << (IMAGE_UTIL_RESIZE_PRECISION - 1));
+	for( k = 0 ; k < taps ; k += 2 ){
+		__m128i a = _mm_loadu_si128((const __m128i *)(rows[k] + x));
+		__m128i b = (k + 1 < taps) ? _mm_loadu_si128((const __m128i *)(rows[k + 1] + x)) : zero;
+		__m128i c = _mm_set1_epi32(__weight_pair(weights[k], (k + 1 < taps) ? weights[k + 1] : 0));
+		__m128i al = _mm_unpacklo_epi8(a, zero), ah = _mm_unpackhi_epi8(a, zero);
+		__m128i bl = _mm_unpacklo_epi8(b, zero), bh = _mm_unpackhi_epi8(b, zero);
+
+		s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(al, bl), c));
+		s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(al, bl), c));
+		s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi16(ah, bh), c));
+		s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi16(ah, bh), c));
+	}
+	s0 = _mm_packs_epi32(_mm_srai_epi32(s0, IMAGE_UTIL_RESIZE_PRECISION), _mm_srai_epi32(s1, IMAGE_UTIL_RESIZE_PRECISION));
+	s2 = _mm_packs_epi32(_mm_srai_epi32(s2, IMAGE_UTIL_RESIZE_PRECISION), _mm_srai_epi32(s3, IMAGE_UTIL_RESIZE_PRECISION));
+	_mm_storeu_si128((__m128i *)(dest + x), _mm_packus_epi16(s0, s2));
+}
+
+static void __resize_row_v_sse2(unsigned char *dest, unsigned char * const *rows, const short *weights, int taps, int size)
+{
+	int x;
+
+	if( size < 16 ){
+		_image_util_resize_row_v_c(dest, rows, weights, taps, size);
+		return;
+	}
+	for( x = 0 ; x + 16 <= size ; x += 16 )
+		__resize_v16_sse2(dest, rows, weights, taps, x);
+	/* the last pixels again with the ones before, the rows do not overlap dest */
+	if( x < size )
+		__resize_v16_sse2(dest, rows, weights, taps, size - 16);
+}
+
+/* 8x8 bytes: the rows are interleaved by 8, 16 and 32 bits, every register then holds two columns */
+static void __transpose_8x8_1_sse2(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride)
+{
+	__m128i r[8], t[4], u[4], v[4];
+	int i;
+
+	for( i = 0 ; i < 8 ; i++ )
+		r[i] = _mm_loadl_epi64((const __m128i *)(src + i * src_stride));
+	for( i = 0 ; i < 4 ; i++ )
+		t[i] = _mm_unpacklo_epi8(r[2 * i], r[2 * i + 1]);
+	u[0] = _mm_unpacklo_epi16(t[0], t[1]);
+	u[1] = _mm_unpackhi_epi16(t[0], t[1]);
+	u[2] = _mm_unpacklo_epi16(t[2], t[3]);
+	u[3] = _mm_unpackhi_epi16(t[2], t[3]);
+	v[0] = _mm_unpacklo_epi32(u[0], u[2]);
+	v[1] = _mm_unpackhi_epi32(u[0], u[2]);
+	v[2] = _mm_unpacklo_epi32(u[1], u[3]);
+	v[3] = _mm_unpackhi_epi32(u[1], u[3]);
+	for( i = 0 ; i < 4 ; i++ ){
+		_mm_storel_epi64((__m128i *)(dest + 2 * i * dest_stride), v[i]);
+		_mm_storel_epi64((__m128i *)(dest + (2 * i + 1) * dest_stride), _mm_unpackhi_epi64(v[i], v[i]));
+	}
+}
+
+/* 8x8 16bit elements, NV12 chroma pairs and RGB565 */
+static void __transpose_8x8_2_sse2(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride)
+{
+	__m128i r[8], t[8], u[8];
+	int i;
+
+	for( i = 0 ; i < 8 ; i++ )
+		r[i] = _mm_loadu_si128((const __m128i *)(src + i * src_stride));
+	for( i = 0 ; i < 4 ; i++ ){
+		t[2 * i] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+		t[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+	}
+	for( i = 0 ; i < 2 ; i++ ){
+		u[4 * i] = _mm_unpacklo_epi32(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 1] = _mm_unpackhi_epi32(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 2] = _mm_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+		u[4 * i + 3] = _mm_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+	}
+	for( i = 0 ; i < 4 ; i++ ){
+		_mm_storeu_si128((__m128i *)(dest + 2 * i * dest_stride), _mm_unpacklo_epi64(u[i], u[i + 4]));
+		_mm_storeu_si128((__m128i *)(dest + (2 * i + 1) * dest_stride), _mm_unpackhi_epi64(u[i], u[i + 4]));
+	}
+}
+
+/* 4x4 32bit pixels */
+static void __transpose_4x4_4_sse2(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride)
+{
+	__m128i r0 = _mm_loadu_si128((const __m128i *)src);
+	__m128i r1 = _mm_loadu_si128((const __m128i *)(src + src_stride));
+	__m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * src_stride));
+	__m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * src_stride));
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+	_mm_storeu_si128((__m128i *)dest, _mm_unpacklo_epi64(t0, t1));
+	_mm_storeu_si128((__m128i *)(dest + dest_stride), _mm_unpackhi_epi64(t0, t1));
+	_mm_storeu_si128((__m128i *)(dest + 2 * dest_stride), _mm_unpacklo_epi64(t2, t3));
+	_mm_storeu_si128((__m128i *)(dest + 3 * dest_stride), _mm_unpackhi_epi64(t2, t3));
+}
+
+/* 8x8 32bit pixels as four 4x4, a block then writes whole 32 byte lines of dest */
+static void __transpose_8x8_4_sse2(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride)
+{
+	__transpose_4x4_4_sse2(dest, dest_stride, src, src_stride);
+	__transpose_4x4_4_sse2(dest + 16, dest_stride, src + 4 * src_stride, src_stride);
+	__transpose_4x4_4_sse2(dest + 4 * dest_stride, dest_stride, src + 16, src_stride);
+	__transpose_4x4_4_sse2(dest + 4 * dest_stride + 16, dest_stride, src + 4 * src_stride + 16, src_stride);
+}
+
+static void __transpose_sse2(unsigned char *dest, int dest_stride, const unsigned char *src, int src_stride, int width, int height, int bytes)
+{
+	void (*block)(unsigned char *, int, const unsigned char *, int);
+	int x, y, full_width, full_height;
+
+	switch( bytes ){
+		case 1:
+			block = __transpose_8x8_1_sse2;
+			break;
+		case 2:
+			block = __transpose_8x8_2_sse2;
+			break;
+		case 4:
+			block = __transpose_8x8_4_sse2;
+			break;
+		default:
+			/* RGB888 pixels do not fit the lanes */
+			_image_util_transpose_c(dest, dest_stride, src, src_stride, width, height, bytes);
+			return;
+	}
+
+	full_width = width & ~7;
+	full_height = height & ~7;
+	for( x = 0 ; x < full_width ; x += 8 ){
+		for( y = 0 ; y < full_height ; y += 8 )
+			block(dest + x * dest_stride + y * bytes, dest_stride, src + y * src_stride + x * bytes, src_stride);
+	}
+	if( full_height < height )
+		_image_util_transpose_c(dest + full_height * bytes, dest_stride, src + full_height * src_stride, src_stride, width, height - full_height, bytes);
+	if( full_width < width )
+		_image_util_transpose_c(dest + full_width * dest_stride, dest_stride, src + full_width * bytes, src_stride, width - full_width, full_height, bytes);
+}
+
+bool _image_util_simd_init_sse2(image_util_simd_ops_s *ops)
+{
+	ops->name = "sse2";
+	ops->yuv_to_rgb32_row = __yuv_to_rgb32_row_sse2;
+	ops->rgb32_to_y_row = __rgb32_to_y_row_sse2;
+	ops->rgb32_to_uv_row = __rgb32_to_uv_row_sse2;
+	ops->resize_row_h = __resize_row_h_sse2;
+	ops->resize_row_v = __resize_row_v_sse2;
+	ops->transpose = __transpose_sse2;
+	return true;
+}
+
+#else
+
+bool _image_util_simd_init_sse2(image_util_simd_ops_s *ops)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <pthread.h>
+
+#define _CANCEL_BANDS	16
+
+/*
+ * A small pool of worker threads shared by all operations of the process.
+ * A job is a number of independent work items (row bands or tiles); the
+ * calling thread takes items as well and returns when all of them are done.
+ * Workers are only started once more than one thread has been requested, and
+ * a job that finds the pool busy with another job runs on the caller alone.
+ * The items of a job run for a canceled request are skipped.
+ */
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	pthread_mutex_t busy;
+	pthread_t threads[IMAGE_UTIL_MAX_THREADS];
+	int num_workers;
+	int num_threads;
+	bool shutdown;
+
+	/* current job */
+	image_util_task_cb task;
+	void *data;
+	const int *canceled;
+	int count;
+	int next;
+	int pending;
+	int error;
+} _thread_pool_s;
+
+static _thread_pool_s _pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.work_cond = PTHREAD_COND_INITIALIZER,
+	.done_cond = PTHREAD_COND_INITIALIZER,
+	.busy = PTHREAD_MUTEX_INITIALIZER,
+	.num_threads = 1,
+};
+
+
+/* must be called with the pool lock held, returns with it held */
+static void __run_items(int worker_id)
+{
+	while( _pool.next < _pool.count && worker_id < _pool.num_threads ){
+		image_util_task_cb task = _pool.task;
+		void *data = _pool.data;
+		const int *canceled = _pool.canceled;
+		int index = _pool.next++;
+		int ret = IMAGE_UTIL_ERROR_CANCELED;
+
+		pthread_mutex_unlock(&_pool.lock);
+		if( canceled == NULL || !__atomic_load_n(canceled, __ATOMIC_RELAXED) )
+			ret = task(data, index);
+		pthread_mutex_lock(&_pool.lock);
+
+		if( ret != IMAGE_UTIL_ERROR_NONE && _pool.error == IMAGE_UTIL_ERROR_NONE )
+			_pool.error = ret;
+		if( --_pool.pending == 0 )
+			pthread_cond_signal(&_pool.done_cond);
+	}
+}
+
+static void *__worker_main(void *arg)
+{
+	int worker_id = (int)(long)arg;
+
+	pthread_mutex_lock(&_pool.lock);
+	while( !_pool.shutdown ){
+		__run_items(worker_id);
+		pthread_cond_wait(&_pool.work_cond, &_pool.lock);
+	}
+	pthread_mutex_unlock(&_pool.lock);
+
+	return NULL;
+}
+
+/* must be called with the pool lock held */
+static void __start_workers(int num_workers)
+{
+	while( _pool.num_workers < num_workers ){
+		/* worker ids start at 1, the calling thread is 0 */
+		if( pthread_create(&_pool.threads[_pool.num_workers], NULL, __worker_main, (void *)(long)(_pool.num_workers + 1)) != 0 ){
+			LOGE("[%s] failed to start worker %d", __func__, _pool.num_workers + 1);
+			break;
+		}
+		_pool.num_workers++;
+	}
+}
+
+static void __attribute__((destructor)) __stop_workers(void)
+{
+	int i, num_workers;
+
+	pthread_mutex_lock(&_pool.lock);
+	_pool.shutdown = true;
+	num_workers = _pool.num_workers;
+	pthread_cond_broadcast(&_pool.work_cond);
+	pthread_mutex_unlock(&_pool.lock);
+
+	for( i = 0 ; i < num_workers ; i++ )
+		pthread_join(_pool.threads[i], NULL);
+}
+
+
+int _image_util_set_num_threads(int num_threads)
+{
+	if( num_threads < 1 || num_threads > IMAGE_UTIL_MAX_THREADS )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&_pool.lock);
+	_pool.num_threads = num_threads;
+	pthread_mutex_unlock(&_pool.lock);
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+int _image_util_get_num_threads(void)
+{
+	int num_threads;
+
+	pthread_mutex_lock(&_pool.lock);
+	num_threads = _pool.num_threads;
+	pthread_mutex_unlock(&_pool.lock);
+
+	return num_threads;
+}
+
+int _image_util_parallel_for(int count, image_util_task_cb task, void *data)
+{
+	int i, ret;
+
+	if( count <= 0 || task == NULL )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	if( count == 1 || _image_util_get_num_threads() == 1 || pthread_mutex_trylock(&_pool.busy) != 0 ){
+		for( i = 0 ; i < count ; i++ ){
+			ret = _image_util_is_canceled() ? IMAGE_UTIL_ERROR_CANCELED : task(data, i);
+			if( ret != IMAGE_UTIL_ERROR_NONE )
+				return ret;
+		}
+		return IMAGE_UTIL_ERROR_NONE;
+	}
+
+	pthread_mutex_lock(&_pool.lock);
+	__start_workers(_pool.num_threads - 1);
+	_pool.task = task;
+	_pool.data = data;
+	_pool.canceled = _image_util_get_cancel_flag();
+	_pool.count = count;
+	_pool.next = 0;
+	_pool.pending = count;
+	_pool.error = IMAGE_UTIL_ERROR_NONE;
+	pthread_cond_broadcast(&_pool.work_cond);
+
+	__run_items(0);
+	while( _pool.pending > 0 )
+		pthread_cond_wait(&_pool.done_cond, &_pool.lock);
+
+	ret = _pool.error;
+	_pool.task = NULL;
+	_pool.data = NULL;
+	_pool.canceled = NULL;
+	_pool.count = 0;
+	_pool.next = 0;
+	pthread_mutex_unlock(&_pool.lock);
+
+	pthread_mutex_unlock(&_pool.busy);
+	return ret;
+}
+
+int _image_util_get_band_size(int rows, int align, int min_rows)
+{
+	int num_threads = _image_util_get_num_threads();
+	int bands, size;
+
+	if( min_rows < align )
+		min_rows = align;
+
+	/* a few bands per thread evens out the load when bands differ in cost */
+	bands = (num_threads > 1) ? num_threads * 4 : 1;
+
+	/* a request is checked for cancellation between bands */
+	if( _image_util_get_cancel_flag() && bands < _CANCEL_BANDS )
+		bands = _CANCEL_BANDS;
+	size = (rows + bands - 1) / bands;
+	if( size < min_rows )
+		size = min_rows;
+	size = (size + align - 1) / align * align;
+
+	return size;
+}
@@ -0,0 +1,250 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define LOG_TAG "TIZEN_N_IMAGE_UTIL"
+#include <dlog.h>
+
+#include <image_util_private.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * crop -> resize -> rotate -> convert in one pass.
+ *
+ * The resized image is produced in tiles of a few rows. Crop is only an
+ * offset into the source, a tile is rotated into its place in the rotated
+ * image, and converted from there straight into the destination. Tiles
+ * start on even rows and map to even destination offsets, so every step
+ * gives the same pixels as when it runs on the whole image.
+ */
+
+#define _TRANSFORM_TILE_BYTES	(64 * 1024)
+#define _TRANSFORM_ALIGN		16
+
+typedef struct
+{
+	image_util_transform_s *transform;
+	const image_util_planes_s *dest;
+	image_util_planes_s src;		/* the crop area */
+	image_util_colorspace_e src_colorspace;
+	image_util_colorspace_e dest_colorspace;
+	int width;				/* size after resize */
+	int height;
+	int tile;
+	int band;
+} _transform_job_s;
+
+
+static bool __is_swapped(image_util_rotation_e rotation)
+{
+	return rotation == IMAGE_UTIL_ROTATION_90 || rotation == IMAGE_UTIL_ROTATION_270;
+}
+
+int _image_util_transform_get_dest_size(const image_util_transform_s *transform, int src_width, int src_height, image_util_colorspace_e src_colorspace, int *crop_width, int *crop_height, int *width, int *height)
+{
+	int cw = src_width, ch = src_height;
+	int rw, rh;
+	image_util_colorspace_e dest_colorspace = transform->convert ? transform->colorspace : src_colorspace;
+
+	if( src_width <= 0 || src_height <= 0 || src_colorspace < 0 || src_colorspace >= IMAGE_UTIL_COLORSPACE_NUM )
+		return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+
+	if( transform->crop ){
+		if( transform->crop_width > src_width - transform->crop_x || transform->crop_height > src_height - transform->crop_y )
+			return IMAGE_UTIL_ERROR_INVALID_PARAMETER;
+		cw = transform->crop_width;
+		ch = transform->crop_height;
+	}
+	rw = transform->resize ? transform->width : cw;
+	rh = transform->resize ? transform->height : ch;
+
+	if( !_image_util_is_native_size(cw, ch, src_colorspace) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	if( (rw != cw || rh != ch) && !_image_util_resize_supported(src_colorspace, cw, ch, rw, rh) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	if( transform->rotation != IMAGE_UTIL_ROTATION_NONE && !_image_util_rotate_supported(src_colorspace, rw, rh, transform->rotation) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+	if( !_image_util_is_native_size(__is_swapped(transform->rotation) ? rh : rw, __is_swapped(transform->rotation) ? rw : rh, dest_colorspace) )
+		return IMAGE_UTIL_ERROR_NOT_SUPPORTED_FORMAT;
+
+	if( crop_width )
+		*crop_width = cw;
+	if( crop_height )
+		*crop_height = ch;
+	if( width )
+		*width = __is_swapped(transform->rotation) ? rh : rw;
+	if( height )
+		*height = __is_swapped(transform->rotation) ? rw : rh;
+
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+static int __alloc_tile(image_util_colorspace_e colorspace, int width, int height, image_util_planes_s *planes, unsigned char **block)
+{
+	image_util_plane_layout_s layout;
+	int i;
+
+	_image_util_get_plane_layout(colorspace, width, height, _TRANSFORM_ALIGN, &layout);
+	*block = _image_util_malloc(layout.size);
+	if( *block == NULL )
+		return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+
+	memset(planes, 0, sizeof(image_util_planes_s));
+	for( i = 0 ; i < layout.num_planes ; i++ ){
+		planes->data[i] = *block + layout.offset[i];
+		planes->stride[i] = layout.stride[i];
+	}
+	return IMAGE_UTIL_ERROR_NONE;
+}
+
+/* runs one tile of rows [row, row + rows) of the resized image */
+static int __transform_tile(_transform_job_s *job, image_util_resize_state_s *state, const image_util_planes_s *resized, const image_util_planes_s *rotated, int row, int rows)
+{
+	image_util_rotation_e rotation = job->transform->rotation;
+	image_util_planes_s tile, dest;
+	int x = 0, y = 0, width = job->width, height = rows;
+	int ret;
+
+	if( state ){
+		tile = *resized;
+		ret = _image_util_resize_rows(job->transform->resizer, state, &tile, &job->src, row, row + rows);
+	}else{
+		ret = _image_util_get_crop_planes(job->src_colorspace, &job->src, 0, row, &tile);
+	}
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	/* place of the tile in the rotated image */
+	switch( rotation ){
+		case IMAGE_UTIL_ROTATION_90:
+			x = job->height - row - rows;
+			width = rows;
+			height = job->width;
+			break;
+		case IMAGE_UTIL_ROTATION_270:
+			x = row;
+			width = rows;
+			height = job->width;
+			break;
+		case IMAGE_UTIL_ROTATION_180:
+		case IMAGE_UTIL_ROTATION_FLIP_VERT:
+			y = job->height - row - rows;
+			break;
+		default:
+			y = row;
+			break;
+	}
+
+	ret = _image_util_get_crop_planes(job->dest_colorspace, job->dest, x, y, &dest);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	if( rotation == IMAGE_UTIL_ROTATION_NONE )
+		return _image_util_convert_rows(&dest, job->dest_colorspace, &tile, job->src_colorspace, width, height, 0, height);
+	if( job->dest_colorspace == job->src_colorspace )
+		return _image_util_rotate(&dest, &tile, job->src_colorspace, job->width, rows, rotation);
+
+	ret = _image_util_rotate(rotated, &tile, job->src_colorspace, job->width, rows, rotation);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+	return _image_util_convert_rows(&dest, job->dest_colorspace, rotated, job->src_colorspace, width, height, 0, height);
+}
+
+static int __transform_band(void *data, int index)
+{
+	_transform_job_s *job = data;
+	image_util_resize_state_s *state = NULL;
+	image_util_planes_s resized, rotated;
+	unsigned char *resized_block = NULL, *rotated_block = NULL;
+	int row_start = index * job->band;
+	int row_end = row_start + job->band;
+	int row, ret = IMAGE_UTIL_ERROR_NONE;
+
+	if( row_end > job->height )
+		row_end = job->height;
+
+	if( job->transform->resizer ){
+		state = _image_util_resize_state_create(job->transform->resizer);
+		if( state == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+		ret = __alloc_tile(job->src_colorspace, job->width, job->tile, &resized, &resized_block);
+	}
+	if( ret == IMAGE_UTIL_ERROR_NONE && job->transform->rotation != IMAGE_UTIL_ROTATION_NONE && job->dest_colorspace != job->src_colorspace ){
+		if( __is_swapped(job->transform->rotation) )
+			ret = __alloc_tile(job->src_colorspace, job->tile, job->width, &rotated, &rotated_block);
+		else
+			ret = __alloc_tile(job->src_colorspace, job->width, job->tile, &rotated, &rotated_block);
+	}
+
+	for( row = row_start ; ret == IMAGE_UTIL_ERROR_NONE && row < row_end ; row += job->tile ){
+		int rows = (row_end - row < job->tile) ? row_end - row : job->tile;
+		ret = __transform_tile(job, state, &resized, &rotated, row, rows);
+	}
+
+	_image_util_free(resized_block);
+	_image_util_free(rotated_block);
+	_image_util_resize_state_destroy(state);
+	return ret;
+}
+
+int _image_util_transform_run(image_util_transform_s *transform, const image_util_planes_s *dest, const image_util_planes_s *src, int src_width, int src_height, image_util_colorspace_e src_colorspace)
+{
+	_transform_job_s job;
+	int crop_width, crop_height, ret;
+
+	ret = _image_util_transform_get_dest_size(transform, src_width, src_height, src_colorspace, &crop_width, &crop_height, NULL, NULL);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	memset(&job, 0, sizeof(job));
+	job.transform = transform;
+	job.dest = dest;
+	job.src_colorspace = src_colorspace;
+	job.dest_colorspace = transform->convert ? transform->colorspace : src_colorspace;
+	job.width = transform->resize ? transform->width : crop_width;
+	job.height = transform->resize ? transform->height : crop_height;
+
+	ret = _image_util_get_crop_planes(src_colorspace, src, transform->crop ? transform->crop_x : 0, transform->crop ? transform->crop_y : 0, &job.src);
+	if( ret != IMAGE_UTIL_ERROR_NONE )
+		return ret;
+
+	/* the plans are held for the next run of the same sizes */
+	if( transform->resizer && !_image_util_resizer_matches(transform->resizer, src_colorspace, crop_width, crop_height, job.width, job.height, IMAGE_UTIL_RESIZE_FILTER_BILINEAR) ){
+		_image_util_resizer_release(transform->resizer);
+		transform->resizer = NULL;
+	}
+	if( transform->resizer == NULL && (job.width != crop_width || job.height != crop_height) ){
+		transform->resizer = _image_util_resizer_get(src_colorspace, crop_width, crop_height, job.width, job.height, IMAGE_UTIL_RESIZE_FILTER_BILINEAR);
+		if( transform->resizer == NULL )
+			return IMAGE_UTIL_ERROR_OUT_OF_MEMORY;
+	}
+
+	/* tiles of about _TRANSFORM_TILE_BYTES of 32bit pixels */
+	job.tile = (_TRANSFORM_TILE_BYTES / (job.width * 4)) & ~1;
+	if( job.tile < 8 )
+		job.tile = 8;
+	else if( job.tile > 64 )
+		job.tile = 64;
+	job.band = _image_util_get_band_size(job.height, job.tile, job.tile);
+
+	return _image_util_parallel_for((job.height + job.band - 1) / job.band, __transform_band, &job);
+}
+
+void _image_util_transform_reset_plan(image_util_transform_s *transform)
+{
+	_image_util_resizer_release(transform->resizer);
+	transform->resizer = NULL;
+}